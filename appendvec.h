@@ -0,0 +1,406 @@
+/*
+
+--- appendvec.h ---
+
+Header-only library that adds the append vector, a growable container
+that many threads may append to at once without a lock.
+
+Members are laid out in blocks as in segvec.h, so they never move.
+A push reserves its slot with a single atomic fetch-add on the
+length, copies the member in, and then publishes it by setting a
+flag kept for every slot. A missing block is allocated by whichever
+thread first needs it and installed with a compare-and-swap; a thread
+losing that race frees its own block and uses the winner's. Readers
+see a member only once it has been published, so at() returns NULL
+for a slot reserved but not yet written, and may be called from any
+thread while others push.
+
+	appendvec* a = appendvec_new( sizeof(T) );
+	a->push(a, &x);                      (from any thread)
+	T* p = a->at(a, i);                  (NULL until published)
+	...
+	a->free(a);
+
+To build a member in place, reserve its slot with emplace and
+publish it once written:
+	unsigned int i;
+	T* p = a->emplace(a, &i);
+	... write *p ...
+	a->publish(a, i);
+
+push_array reserves and publishes 'n' consecutive slots with one
+fetch-add, which keeps several producers from contending on the
+length for every member.
+
+Only appending and reading are thread safe: clear and free must not
+run alongside anything else. The allocator must be thread safe, as
+the default one is; allocation tracking (ULIB_TRACK_ALLOC) is not.
+A slot whose block could not be allocated stays unpublished.
+
+Needs the __atomic builtins of GCC or Clang.
+
+In order to use the functions from this library, write:
+	#define APPENDVEC_IMPLEMENTATION
+and THEN include the library:
+	#include "appendvec.h"
+
+Standard: ANSI C89, with GCC atomic builtins
+
+
+VERSIONS
+
+v0.1
+	- Basics: appendvec_new, appendvec_new_alloc, free
+	- Members: at, push, push_array, emplace, publish
+	- Storage: length, capacity, elem_size, reserve, clear, mem
+
+*/
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		HEADER
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifndef APPENDVEC_H
+#define APPENDVEC_H 1
+
+#ifndef DEFS_IMPLEMENTATION
+#define DEFS_IMPLEMENTATION
+#include "defs.h"
+#endif
+
+#ifndef SEGVEC_IMPLEMENTATION
+#define SEGVEC_IMPLEMENTATION
+#include "segvec.h"
+#endif
+
+#ifndef __GNUC__
+	#error "appendvec.h needs the __atomic builtins of GCC or Clang"
+#endif
+
+
+/*
+ *	DATA STRUCTURES & MACROS
+ */
+
+typedef struct appendvec__struct appendvec;
+
+/* Appendvec methods, shared by every appendvec under ULIB_SHARED_VTABLE (defs.h) */
+#define APPENDVEC__METHODS \
+	unsigned int (*length)(appendvec*); \
+	unsigned int (*capacity)(appendvec*); \
+	unsigned int (*elem_size)(appendvec*); \
+	void* (*at)(appendvec*, unsigned int); \
+	unsigned int (*mem)(appendvec*); \
+	appendvec* (*push)(appendvec*, const void*); \
+	appendvec* (*push_array)(appendvec*, const void*, unsigned int); \
+	void* (*emplace)(appendvec*, unsigned int*); \
+	appendvec* (*publish)(appendvec*, unsigned int); \
+	appendvec* (*reserve)(appendvec*, unsigned int); \
+	appendvec* (*clear)(appendvec*); \
+	void (*free)(appendvec*);
+
+typedef struct appendvec__vtable_struct appendvec_vtable;
+struct appendvec__vtable_struct {
+	APPENDVEC__METHODS
+};
+
+struct appendvec__struct {
+	/*
+	Block b holds SEGVEC__BLOCK_LEN(b) members, followed by
+	one publish flag per member. Installed atomically.
+	*/
+	char* blocks[SEGVEC__BLOCKS];
+	unsigned int len;             /* slots reserved, atomic */
+	unsigned int dtype;           /* bytes per member */
+	const ulib_allocator* alloc;
+
+	/* Methods */
+#ifdef ULIB_SHARED_VTABLE
+	const appendvec_vtable* vt;
+#else
+	APPENDVEC__METHODS
+#endif
+};
+
+
+/*
+ *	FUNCTION DECLARATIONS
+ */
+
+appendvec* appendvec_new(unsigned int bytes);
+appendvec* appendvec_new_alloc(unsigned int bytes, const ulib_allocator* alloc);
+
+unsigned int appendvec__length(appendvec* a);
+unsigned int appendvec__capacity(appendvec* a);
+unsigned int appendvec__elem_size(appendvec* a);
+void* appendvec__at(appendvec* a, unsigned int i);
+unsigned int appendvec__mem(appendvec* a);
+appendvec* appendvec__push(appendvec* a, const void* src);
+appendvec* appendvec__push_array(appendvec* a, const void* src, unsigned int n);
+void* appendvec__emplace(appendvec* a, unsigned int* index);
+appendvec* appendvec__publish(appendvec* a, unsigned int i);
+appendvec* appendvec__reserve(appendvec* a, unsigned int cap);
+appendvec* appendvec__clear(appendvec* a);
+void appendvec__free(appendvec* a);
+
+#endif /* APPENDVEC_H */
+
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		IMPLEMENTATION
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifdef APPENDVEC_IMPLEMENTATION
+
+#ifdef ULIB_SHARED_VTABLE
+static const appendvec_vtable appendvec__methods = {
+	appendvec__length,
+	appendvec__capacity,
+	appendvec__elem_size,
+	appendvec__at,
+	appendvec__mem,
+	appendvec__push,
+	appendvec__push_array,
+	appendvec__emplace,
+	appendvec__publish,
+	appendvec__reserve,
+	appendvec__clear,
+	appendvec__free
+};
+#endif
+
+/* Slots that fit before indices run out */
+#define APPENDVEC__MAX_LEN SEGVEC__BLOCK_START(SEGVEC__MAX_BLOCKS)
+
+/* Block holding slot 'i', and the slot's place within it */
+#define APPENDVEC__BLOCK(i) (segvec__log2((i) + ULIB_SEGVEC_FIRST) - segvec__log2(ULIB_SEGVEC_FIRST))
+#define APPENDVEC__OFFSET(i, b) ((i) - SEGVEC__BLOCK_START(b))
+
+/* Bytes in block 'b', members and flags */
+#define APPENDVEC__BLOCK_BYTES(a, b) ((size_t)SEGVEC__BLOCK_LEN(b)*((a)->dtype + 1))
+
+/* Publish flag of slot 'k' of block 'b' */
+#define APPENDVEC__FLAG(a, blk, b, k) ((blk) + (size_t)SEGVEC__BLOCK_LEN(b)*(a)->dtype + (k))
+
+appendvec* appendvec_new(unsigned int bytes){
+	return appendvec_new_alloc(bytes, NULL);
+}
+
+/* As appendvec_new, taking its memory from 'alloc' (NULL for the default) */
+appendvec* appendvec_new_alloc(unsigned int bytes, const ulib_allocator* alloc){
+	appendvec* a;
+	unsigned int b;
+	if(bytes == 0) return NULL;
+	if(!alloc) alloc = &ulib_default_allocator;
+	a = ulib__alloc(alloc, sizeof(appendvec), ULIB_TAG_APPENDVEC);
+	if(!a) return NULL;
+
+	/* Variables */
+	for(b=0; b!=SEGVEC__BLOCKS; ++b) a->blocks[b] = NULL;
+	a->len = 0;
+	a->dtype = bytes;
+	a->alloc = alloc;
+#ifdef ULIB_SHARED_VTABLE
+	a->vt = &appendvec__methods;
+#else
+	/* Methods */
+	a->length = appendvec__length;
+	a->capacity = appendvec__capacity;
+	a->elem_size = appendvec__elem_size;
+	a->at = appendvec__at;
+	a->mem = appendvec__mem;
+	a->push = appendvec__push;
+	a->push_array = appendvec__push_array;
+	a->emplace = appendvec__emplace;
+	a->publish = appendvec__publish;
+	a->reserve = appendvec__reserve;
+	a->clear = appendvec__clear;
+	a->free = appendvec__free;
+#endif
+	return a;
+}
+
+/* Clears the flags of block 'b', at 'blk' */
+static void appendvec__unpublish(appendvec* a, char* blk, unsigned int b){
+	char* flag = APPENDVEC__FLAG(a, blk, b, 0);
+	unsigned int k;
+	for(k=0; k!=SEGVEC__BLOCK_LEN(b); ++k) flag[k] = 0;
+}
+
+/*
+Returns block 'b', allocating it if no thread has yet.
+Returns NULL if out of memory or indices.
+*/
+static char* appendvec__block(appendvec* a, unsigned int b){
+	char* blk = __atomic_load_n(&a->blocks[b], __ATOMIC_ACQUIRE);
+	char* expected = NULL;
+	if(blk) return blk;
+	if(b >= SEGVEC__MAX_BLOCKS || SEGVEC__BLOCK_LEN(b) > (unsigned int)-1 / (a->dtype + 1)) return NULL;
+	blk = ulib__alloc(a->alloc, APPENDVEC__BLOCK_BYTES(a, b), ULIB_TAG_APPENDVEC);
+	if(!blk) return NULL;
+	appendvec__unpublish(a, blk, b);
+	if(__atomic_compare_exchange_n(&a->blocks[b], &expected, blk, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)){
+		return blk;
+	}
+	/* Another thread installed it first */
+	ulib__dealloc(a->alloc, blk, APPENDVEC__BLOCK_BYTES(a, b), ULIB_TAG_APPENDVEC);
+	return expected;
+}
+
+/*
+Reserves 'n' consecutive slots and stores the first in 'first'.
+Fails without touching the length if they would run past
+APPENDVEC__MAX_LEN, so the length never wraps back to used slots.
+*/
+static int appendvec__claim(appendvec* a, unsigned int n, unsigned int* first){
+	unsigned int i = __atomic_load_n(&a->len, __ATOMIC_RELAXED);
+	do{
+		if(i > APPENDVEC__MAX_LEN || n > APPENDVEC__MAX_LEN - i) return 0;
+	} while(!__atomic_compare_exchange_n(&a->len, &i, i + n, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+	*first = i;
+	return 1;
+}
+
+/* Slots reserved so far, published or not */
+unsigned int appendvec__length(appendvec* a){
+	return __atomic_load_n(&a->len, __ATOMIC_ACQUIRE);
+}
+
+/* Slots in the allocated blocks */
+unsigned int appendvec__capacity(appendvec* a){
+	unsigned int b, cap = 0;
+	for(b=0; b!=SEGVEC__MAX_BLOCKS; ++b){
+		if(__atomic_load_n(&a->blocks[b], __ATOMIC_ACQUIRE)) cap += SEGVEC__BLOCK_LEN(b);
+	}
+	return cap;
+}
+
+unsigned int appendvec__elem_size(appendvec* a){
+	return a->dtype;
+}
+
+/* Returns member 'i', or NULL if out of range or not yet published */
+void* appendvec__at(appendvec* a, unsigned int i){
+	unsigned int b, k;
+	char* blk;
+	if(i >= APPENDVEC__MAX_LEN) return NULL;
+	b = APPENDVEC__BLOCK(i);
+	k = APPENDVEC__OFFSET(i, b);
+	blk = __atomic_load_n(&a->blocks[b], __ATOMIC_ACQUIRE);
+	if(!blk || !__atomic_load_n(APPENDVEC__FLAG(a, blk, b, k), __ATOMIC_ACQUIRE)) return NULL;
+	return blk + (size_t)k*a->dtype;
+}
+
+/* Bytes taken by the appendvec and its blocks */
+unsigned int appendvec__mem(appendvec* a){
+	if(!a) return 0;
+	return sizeof(appendvec) + appendvec__capacity(a)*(a->dtype + 1);
+}
+
+appendvec* appendvec__push(appendvec* a, const void* src){
+	unsigned int i, b, k;
+	char* blk;
+	if(!appendvec__claim(a, 1, &i)) return NULL;
+	b = APPENDVEC__BLOCK(i);
+	k = APPENDVEC__OFFSET(i, b);
+	blk = appendvec__block(a, b);
+	if(!blk) return NULL;
+	ULIB_MEMCPY(blk + (size_t)k*a->dtype, src, a->dtype);
+	__atomic_store_n(APPENDVEC__FLAG(a, blk, b, k), 1, __ATOMIC_RELEASE);
+	return a;
+}
+
+/*
+Appends 'n' members read from 'src', reserving their slots at once,
+so they end up consecutive even with other threads pushing.
+Returns NULL if any of them could not be stored.
+*/
+appendvec* appendvec__push_array(appendvec* a, const void* src, unsigned int n){
+	unsigned int i, b, k, m;
+	char* blk;
+	const char* s = src;
+	if(n == 0) return a;
+	if(!appendvec__claim(a, n, &i)) return NULL;
+
+	/* Copy block by block, then publish */
+	while(n){
+		b = APPENDVEC__BLOCK(i);
+		k = APPENDVEC__OFFSET(i, b);
+		m = SEGVEC__BLOCK_LEN(b) - k;
+		if(m > n) m = n;
+		blk = appendvec__block(a, b);
+		if(!blk) return NULL;
+		ULIB_MEMCPY(blk + (size_t)k*a->dtype, s, (size_t)m*a->dtype);
+		for(; m; --m, --n, ++i, ++k, s += a->dtype){
+			__atomic_store_n(APPENDVEC__FLAG(a, blk, b, k), 1, __ATOMIC_RELEASE);
+		}
+	}
+	return a;
+}
+
+/*
+Reserves a slot, storing its index in 'index', and returns it
+uninitialised. Readers only see it once published.
+Returns NULL on failure.
+*/
+void* appendvec__emplace(appendvec* a, unsigned int* index){
+	unsigned int i, b;
+	char* blk;
+	if(!appendvec__claim(a, 1, &i)) return NULL;
+	b = APPENDVEC__BLOCK(i);
+	blk = appendvec__block(a, b);
+	if(!blk) return NULL;
+	*index = i;
+	return blk + (size_t)APPENDVEC__OFFSET(i, b)*a->dtype;
+}
+
+/* Makes slot 'i', reserved with emplace and since written, visible to readers */
+appendvec* appendvec__publish(appendvec* a, unsigned int i){
+	unsigned int b, k;
+	char* blk;
+	if(i >= appendvec__length(a)) return NULL;
+	b = APPENDVEC__BLOCK(i);
+	k = APPENDVEC__OFFSET(i, b);
+	blk = __atomic_load_n(&a->blocks[b], __ATOMIC_ACQUIRE);
+	if(!blk) return NULL;
+	__atomic_store_n(APPENDVEC__FLAG(a, blk, b, k), 1, __ATOMIC_RELEASE);
+	return a;
+}
+
+/* Allocates the blocks for 'cap' slots, so that pushes need not */
+appendvec* appendvec__reserve(appendvec* a, unsigned int cap){
+	unsigned int b;
+	if(cap > APPENDVEC__MAX_LEN) return NULL;
+	for(b=0; SEGVEC__BLOCK_START(b) < cap; ++b){
+		if(!appendvec__block(a, b)) return NULL;
+	}
+	return a;
+}
+
+/* Empties the appendvec, keeping its blocks. Not thread safe. */
+appendvec* appendvec__clear(appendvec* a){
+	unsigned int b;
+	for(b=0; b!=SEGVEC__MAX_BLOCKS; ++b){
+		if(a->blocks[b]) appendvec__unpublish(a, a->blocks[b], b);
+	}
+	a->len = 0;
+	return a;
+}
+
+/* Not thread safe */
+void appendvec__free(appendvec* a){
+	unsigned int b;
+	if(!a) return;
+	for(b=0; b!=SEGVEC__MAX_BLOCKS; ++b){
+		if(a->blocks[b]) ulib__dealloc(a->alloc, a->blocks[b], APPENDVEC__BLOCK_BYTES(a, b), ULIB_TAG_APPENDVEC);
+	}
+	ulib__dealloc(a->alloc, a, sizeof(appendvec), ULIB_TAG_APPENDVEC);
+}
+
+#endif /* APPENDVEC_IMPLEMENTATION */
@@ -0,0 +1,273 @@
+/*
+
+--- arena.h ---
+
+Header-only library that adds the arena (region) allocator.
+Memory is handed out by bumping a pointer through large blocks,
+and is given back all at once, so a batch of containers built
+on the same arena can be released in one go.
+
+In order to use the functions from this library, write:
+	#define ARENA_IMPLEMENTATION
+and THEN include the library:
+	#include "arena.h"
+
+To create containers on an arena, pass its allocator:
+	arena* ar = arena_new(0);
+	vector* v = vector_new_alloc(sizeof(int), &ar->allocator);
+	list* l = list_new_alloc(&ar->allocator);
+	string* s = string_new_alloc(&ar->allocator, "Hello");
+	...
+	ar->clear(ar);   // every container above is gone
+	ar->free(ar);
+
+Freeing a container built on an arena is allowed but optional.
+Only the most recent allocation is actually given back; all
+other memory returns when the arena is reset or cleared.
+
+Standard: ANSI C89
+
+
+VERSIONS
+
+v0.1
+	- Basics: arena_new, arena_new_alloc, free
+	- Allocating: alloc, allocator (for containers)
+	- Releasing: mark, reset, clear
+	- Info: bytes
+
+*/
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		HEADER
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifndef ARENA_H
+#define ARENA_H 1
+
+#ifndef DEFS_IMPLEMENTATION
+#define DEFS_IMPLEMENTATION
+#include "defs.h"
+#endif
+
+/* Alignment of every allocation. Must be a power of two. */
+#ifndef ULIB_ARENA_ALIGN
+	#define ULIB_ARENA_ALIGN 16
+#endif
+
+/* Size of the blocks requested when arena_new is given 0 */
+#ifndef ULIB_ARENA_BLOCK
+	#define ULIB_ARENA_BLOCK (64u*1024u)
+#endif
+
+
+/*
+ *	DATA STRUCTURES & MACROS
+ */
+
+typedef struct arena__block_struct arena_block;
+struct arena__block_struct {
+	arena_block* prev;  /* previous (older) block */
+	unsigned int size;  /* usable bytes after the header */
+	unsigned int used;
+};
+
+/* A position in the arena, to roll back to later */
+typedef struct arena__mark_struct arena_mark;
+struct arena__mark_struct {
+	arena_block* block;
+	unsigned int used;
+};
+
+typedef struct arena__struct arena;
+struct arena__struct {
+	arena_block* block;           /* block being filled */
+	void* last;                   /* most recent allocation */
+	unsigned int block_size;      /* default size of new blocks */
+	const ulib_allocator* parent; /* where blocks come from */
+	ulib_allocator allocator;     /* hands out memory from this arena */
+
+	/* Methods */
+	void*        (*alloc) (arena*, unsigned int bytes);
+	arena_mark   (*mark)  (arena*);
+	void         (*reset) (arena*, arena_mark);
+	void         (*clear) (arena*);
+	unsigned int (*bytes) (arena*);
+	void         (*free)  (arena*);
+};
+
+
+/*
+ *	FUNCTION DECLARATIONS
+ */
+
+arena* arena_new(unsigned int block_size);
+arena* arena_new_alloc(unsigned int block_size, const ulib_allocator* parent);
+
+void* arena__alloc(arena* ar, unsigned int bytes);
+arena_mark arena__mark(arena* ar);
+void arena__reset(arena* ar, arena_mark mark);
+void arena__clear(arena* ar);
+unsigned int arena__bytes(arena* ar);
+void arena__free(arena* ar);
+
+#endif /* ARENA_H */
+
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		IMPLEMENTATION
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifdef ARENA_IMPLEMENTATION
+
+#define ARENA__ROUND(n) (((n) + (ULIB_ARENA_ALIGN-1)) & ~(unsigned int)(ULIB_ARENA_ALIGN-1))
+
+/* Header size, rounded so that block data stays aligned */
+#define ARENA__HEADER ARENA__ROUND(sizeof(arena_block))
+
+#define ARENA__DATA(b) ((char*)(b) + ARENA__HEADER)
+
+/* ulib_allocator callbacks */
+
+static void* arena__allocator_alloc(void* ctx, unsigned int bytes){
+	return arena__alloc(ctx, bytes);
+}
+
+static void* arena__allocator_realloc(void* ctx, void* ptr, unsigned int old_bytes, unsigned int new_bytes){
+	arena* ar = ctx;
+	arena_block* b = ar->block;
+	void* p;
+
+	/* The latest allocation can grow or shrink in place */
+	if(ptr == ar->last){
+		unsigned int start = (unsigned int)((char*)ptr - ARENA__DATA(b));
+		if(start + ARENA__ROUND(new_bytes) <= b->size){
+			b->used = start + ARENA__ROUND(new_bytes);
+			return ptr;
+		}
+	}
+	if(new_bytes <= old_bytes) return ptr;
+
+	p = arena__alloc(ar, new_bytes);
+	if(!p) return NULL;
+	ULIB_MEMCPY(p, ptr, old_bytes);
+	return p;
+}
+
+static void arena__allocator_free(void* ctx, void* ptr, unsigned int bytes){
+	arena* ar = ctx;
+	(void)bytes;
+	/* Only the latest allocation can be given back */
+	if(ptr == ar->last){
+		ar->block->used = (unsigned int)((char*)ptr - ARENA__DATA(ar->block));
+		ar->last = NULL;
+	}
+}
+
+arena* arena_new(unsigned int block_size){
+	return arena_new_alloc(block_size, NULL);
+}
+
+/* As arena_new, taking its blocks from 'parent' (NULL for the default) */
+arena* arena_new_alloc(unsigned int block_size, const ulib_allocator* parent){
+	arena* ar;
+	if(!parent) parent = &ulib_default_allocator;
+	ar = ulib__alloc(parent, sizeof(arena), ULIB_TAG_ARENA);
+	if(!ar) return NULL;
+
+	ar->block = NULL;
+	ar->last = NULL;
+	ar->block_size = block_size ? block_size : ULIB_ARENA_BLOCK;
+	ar->parent = parent;
+
+	ar->allocator.alloc = arena__allocator_alloc;
+	ar->allocator.realloc = arena__allocator_realloc;
+	ar->allocator.free = arena__allocator_free;
+	ar->allocator.ctx = ar;
+
+	/* Methods */
+	ar->alloc = arena__alloc;
+	ar->mark = arena__mark;
+	ar->reset = arena__reset;
+	ar->clear = arena__clear;
+	ar->bytes = arena__bytes;
+	ar->free = arena__free;
+
+	return ar;
+}
+
+/* Returns 'bytes' bytes of aligned memory, chaining a new block when full */
+void* arena__alloc(arena* ar, unsigned int bytes){
+	arena_block* b = ar->block;
+	unsigned int size;
+	void* p;
+
+	bytes = ARENA__ROUND(bytes);
+	if(!b || b->size - b->used < bytes){
+		/* Oversized requests get a block of their own */
+		size = bytes > ar->block_size ? bytes : ar->block_size;
+		b = ulib__alloc(ar->parent, ARENA__HEADER + size, ULIB_TAG_ARENA);
+		if(!b) return NULL;
+		b->prev = ar->block;
+		b->size = size;
+		b->used = 0;
+		ar->block = b;
+	}
+	p = ARENA__DATA(b) + b->used;
+	b->used += bytes;
+	ar->last = p;
+	return p;
+}
+
+/* Records the current position */
+arena_mark arena__mark(arena* ar){
+	arena_mark m;
+	m.block = ar->block;
+	m.used = ar->block ? ar->block->used : 0;
+	return m;
+}
+
+/* Releases everything allocated since 'mark' was taken */
+void arena__reset(arena* ar, arena_mark mark){
+	arena_block* b;
+	while(ar->block && ar->block != mark.block){
+		b = ar->block;
+		ar->block = b->prev;
+		ulib__dealloc(ar->parent, b, ARENA__HEADER + b->size, ULIB_TAG_ARENA);
+	}
+	if(ar->block) ar->block->used = mark.used;
+	ar->last = NULL;
+}
+
+/* Releases everything, keeping the oldest block for reuse */
+void arena__clear(arena* ar){
+	arena_mark m;
+	m.block = ar->block;
+	while(m.block && m.block->prev) m.block = m.block->prev;
+	m.used = 0;
+	arena__reset(ar, m);
+}
+
+/* Bytes handed out so far, including alignment padding */
+unsigned int arena__bytes(arena* ar){
+	unsigned int n = 0;
+	arena_block* b;
+	for(b = ar->block; b; b = b->prev) n += b->used;
+	return n;
+}
+
+void arena__free(arena* ar){
+	arena_mark m;
+	m.block = NULL;
+	m.used = 0;
+	arena__reset(ar, m);
+	ulib__dealloc(ar->parent, ar, sizeof(arena), ULIB_TAG_ARENA);
+}
+
+#endif /* ARENA_IMPLEMENTATION */
@@ -148,7 +148,7 @@ _ARGS *arglib_add_option(const char c_label,
 
 	/* Increase list size*/
 	ARG_NUM++;
-	ARGLIB_ARG_STRUCT = ULIB_REALLOC(ARGLIB_ARG_STRUCT, sizeof(_ARGS) * ARG_NUM );
+	ARGLIB_ARG_STRUCT = ulib__realloc(NULL, ARGLIB_ARG_STRUCT, sizeof(_ARGS) * (ARG_NUM-1), sizeof(_ARGS) * ARG_NUM, ULIB_TAG_ARGLIB);
 
 	/* Construct new argument element*/
 	_ARGS new_arg = {.c_label = c_label, .dtype = type, .flag_req = req};
@@ -163,11 +163,11 @@ _ARGS *arglib_add_option(const char c_label,
 
 	/* Store description*/
 	if(descr){
-		new_arg.descr = ULIB_MALLOC(ULIB_STRLEN(descr)+1);
+		new_arg.descr = ulib__alloc(NULL, ULIB_STRLEN(descr)+1, ULIB_TAG_ARGLIB);
 		ULIB_STRCPY(new_arg.descr, descr);
 	}
 	else{
-		new_arg.descr = ULIB_MALLOC(2);
+		new_arg.descr = ulib__alloc(NULL, 1, ULIB_TAG_ARGLIB);
 		ULIB_STRCPY(new_arg.descr, "\0");
 	}
 
@@ -189,16 +189,27 @@ _ARGS *arglib_init() {
 	return ARGLIB_ARG_STRUCT;
 }
 
+/*
+Returns the size of the parameter stored for an argument
+*/
+static unsigned int arglib_pval_size(_ARGS *arg) {
+	if(arg->dtype == ARG_FLOAT) return sizeof(double);
+	if(arg->dtype == ARG_STR) return ULIB_STRLEN(arg->pval)+1;
+	return sizeof(int);
+}
+
 /*
 Frees option argument list
 */
 void arglib_free() {
 	size_t i;
+	_ARGS *arg;
 	for(i=0; i<ARG_NUM; i++){
-		free(ARGLIB_ARG_STRUCT[i].descr);
-		free(ARGLIB_ARG_STRUCT[i].pval);
+		arg = &ARGLIB_ARG_STRUCT[i];
+		ulib__dealloc(NULL, arg->descr, ULIB_STRLEN(arg->descr)+1, ULIB_TAG_ARGLIB);
+		if(arg->pval) ulib__dealloc(NULL, arg->pval, arglib_pval_size(arg), ULIB_TAG_ARGLIB);
 	}
-	free(ARGLIB_ARG_STRUCT);
+	ulib__dealloc(NULL, ARGLIB_ARG_STRUCT, sizeof(_ARGS) * ARG_NUM, ULIB_TAG_ARGLIB);
 	ARGLIB_ARG_STRUCT = NULL;
 	ARG_NUM = 0;
 }
@@ -348,7 +359,7 @@ static _ARGS *arglib_cast_arg(_ARGS *arg, const char *argv) {
 		if(arglib_strtoint(&idata, argv) == NULL){
 			return NULL;
 		}
-		arg->pval = ULIB_MALLOC(sizeof(int));
+		arg->pval = ulib__alloc(NULL, sizeof(int), ULIB_TAG_ARGLIB);
 		*((int*)arg->pval) = idata;
 		return arg;
 	}
@@ -358,13 +369,13 @@ static _ARGS *arglib_cast_arg(_ARGS *arg, const char *argv) {
 		if(arglib_strtoflt(&fdata, argv) == NULL){
 			return NULL;
 		}
-		arg->pval = ULIB_MALLOC(sizeof(double));
+		arg->pval = ulib__alloc(NULL, sizeof(double), ULIB_TAG_ARGLIB);
 		*((double*)arg->pval) = fdata;
 		return arg;
 	}
 	/* String type*/
 	if(arg->dtype == ARG_STR){
-		arg->pval = ULIB_MALLOC(ULIB_STRLEN(argv)+1);
+		arg->pval = ulib__alloc(NULL, ULIB_STRLEN(argv)+1, ULIB_TAG_ARGLIB);
 		ULIB_STRCPY(arg->pval, argv);
 		return arg;
 	}
@@ -423,7 +434,7 @@ _ARGS *arglib_parse(const int argc, const char *argv[]) {
 				}
 				/*Set defined flag value as '0'*/
 				else{
-					ARGLIB_ARG_STRUCT[j].pval = ULIB_MALLOC(sizeof(int));
+					ARGLIB_ARG_STRUCT[j].pval = ulib__alloc(NULL, sizeof(int), ULIB_TAG_ARGLIB);
 					*((int*)ARGLIB_ARG_STRUCT[j].pval) = 0;
 				}
 				break;
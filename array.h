@@ -20,6 +20,17 @@ Compiler: GCC version 9.2.0 (tdm64-1)
 
 VERSIONS
 
+v0.4
+	- Added element-wise arithmetic: add(), sub(), mul(), div(), their
+	_scalar forms and axpy(), in place, and array_add() etc. returning
+	a new array.
+	- Added describe(), which fills an array_stats with count, min, max,
+	their indices, sum, mean, variance and NaN/Inf counts in one pass.
+	- Added sort(), a radix sort for ints and doubles (sort.h).
+	- Added sort_parallel(), the same on several threads.
+	- Added lower_bound(), upper_bound() and equal_range()
+	for sorted arrays.
+
 v0.3 - 01/08/2021
 	- Migrated typing to types.h.
 		ARRAY_INT => TYPE_INT
@@ -56,9 +67,8 @@ Planned
 	- Drop support for ints. Make it exclusive for doubles.
 
 	- Generic: reverse
-	- Stats: median, stdev, etc
-	- Operations: add, sub, mult, div, mod
-	- Sorting: selection, bubble, etc.
+	- Stats: median, etc
+	- Operations: mod
 
 
 */
@@ -77,46 +87,141 @@ Planned
 #include "types.h"
 #endif
 
+#ifndef SORT_IMPLEMENTATION
+#define SORT_IMPLEMENTATION
+#include "sort.h"
+#endif
+
 
 /*
  *	DATA STRUCTURES & MACROS
  */
 
 typedef struct array__struct array;
+typedef struct array__stats_struct array_stats;
+
+/* Array methods, shared by every array under ULIB_SHARED_VTABLE (defs.h) */
+#define ARRAY__METHODS \
+	unsigned int (*length)(array*); \
+	void (*free)(array*); \
+	void (*print)(array*); \
+	void (*fill)(array*, ...); \
+	void (*range)(array*, ...); \
+	void (*linspace)(array*, ...); \
+	void (*from_c_array)(array*, const void* c_arr); \
+	void (*reverse)(array*); \
+	void (*sort)(array*); \
+	void (*sort_parallel)(array*, unsigned int); \
+	unsigned int (*lower_bound)(array*, ...); \
+	unsigned int (*upper_bound)(array*, ...); \
+	unsigned int (*equal_range)(array*, unsigned int* end, ...); \
+	void (*seti)(array*, unsigned int ind, int value); \
+	void (*setf)(array*, unsigned int ind, double value); \
+	int (*geti)(array*, unsigned int ind); \
+	double (*getf)(array*, unsigned int ind); \
+	char* (*at)(array*, unsigned int ind); \
+	/* stats */ \
+	int (*maxi)(array*); \
+	double (*maxf)(array*); \
+	int (*mini)(array*); \
+	double (*minf)(array*); \
+	unsigned int (*imax)(array*); \
+	unsigned int (*imin)(array*); \
+	int (*sumi)(array*); \
+	double (*sumf)(array*); \
+	double (*mean)(array*); \
+	void (*describe)(array*, array_stats*); \
+	/* arithmetic */ \
+	array* (*add)(array*, array* other); \
+	array* (*sub)(array*, array* other); \
+	array* (*mul)(array*, array* other); \
+	array* (*div)(array*, array* other); \
+	array* (*add_scalar)(array*, ...); \
+	array* (*sub_scalar)(array*, ...); \
+	array* (*mul_scalar)(array*, ...); \
+	array* (*div_scalar)(array*, ...); \
+	array* (*axpy)(array*, array* x, ...);
+
+typedef struct array__vtable_struct array_vtable;
+struct array__vtable_struct {
+	ARRAY__METHODS
+};
+
 struct array__struct {
 	char* data;
 	unsigned int size;
 	unsigned int type;
 	unsigned int bytes; /* size in bytes of each member */
+	const ulib_allocator* alloc;
 
+#ifdef ULIB_SHARED_VTABLE
+	const array_vtable* vt;
+#else
 	/* Function pointers */
-	unsigned int (*length)(array*);
-	void (*free)(array*);
-	void (*print)(array*);
-
-	void (*fill)(array*, ...);
-	void (*range)(array*, ...);
-	void (*linspace)(array*, ...);
-	void (*from_c_array)(array*, const void* c_arr);
-	void (*reverse)(array*);
-
-	void (*seti)(array*, unsigned int ind, int value);
-	void (*setf)(array*, unsigned int ind, double value);
-
-	int (*geti)(array*, unsigned int ind);
-	double (*getf)(array*, unsigned int ind);
-	char* (*at)(array*, unsigned int ind);
-
-	/* stats */
-	int (*maxi)(array*);
-	double (*maxf)(array*);
-	int (*mini)(array*);
-	double (*minf)(array*);
-	unsigned int (*imax)(array*);
-	unsigned int (*imin)(array*);
-	int (*sumi)(array*);
-	double (*sumf)(array*);
-	double (*mean)(array*);	
+	ARRAY__METHODS
+#endif
+};
+
+
+/*
+ *	Summary of an array, filled by describe().
+ *	NaN members are left out of everything but 'nans'.
+ *	Infinities are counted in 'infs' and enter the sums,
+ *	so they carry into sum, mean and variance.
+ */
+struct array__stats_struct {
+	unsigned int count; /* members that are not NaN */
+	unsigned int nans;
+	unsigned int infs;
+	unsigned int imin;  /* index of the first minimum */
+	unsigned int imax;  /* index of the first maximum */
+	double min;
+	double max;
+	double sum;
+	double mean;
+	double var;         /* population variance */
+	double stddev;
+};
+
+
+/* Element-wise operations, the 'op' of the arithmetic kernels */
+#define ARRAY_ADD 0
+#define ARRAY_SUB 1
+#define ARRAY_MUL 2
+#define ARRAY_DIV 3
+
+
+/*
+ *	Reduction kernels over raw data.
+ *	There is one constant table per defs.h CPU tier,
+ *	and array__kernels() returns the current tier's.
+ */
+typedef struct array__kernels_struct array_kernels;
+struct array__kernels_struct {
+	int          (*sum_int) (const int*, unsigned int);
+	double       (*sum_db)  (const double*, unsigned int);
+	int          (*max_int) (const int*, unsigned int);
+	double       (*max_db)  (const double*, unsigned int);
+	int          (*min_int) (const int*, unsigned int);
+	double       (*min_db)  (const double*, unsigned int);
+	unsigned int (*imax_int)(const int*, unsigned int);
+	unsigned int (*imax_db) (const double*, unsigned int);
+	unsigned int (*imin_int)(const int*, unsigned int);
+	unsigned int (*imin_db) (const double*, unsigned int);
+	void         (*describe_int)(const int*, unsigned int, array_stats*);
+	void         (*describe_db) (const double*, unsigned int, array_stats*);
+
+	/*
+	 *	Arithmetic kernels, writing z = x op y, z = x op s and z = a*x + y.
+	 *	'z' may be 'x' or 'y', but must not overlap them otherwise.
+	 *	Ints wrap around. Int divisors must not be zero.
+	 */
+	void (*op_int)  (int* z, const int* x, const int* y, unsigned int n, unsigned int op);
+	void (*op_db)   (double* z, const double* x, const double* y, unsigned int n, unsigned int op);
+	void (*ops_int) (int* z, const int* x, int s, unsigned int n, unsigned int op);
+	void (*ops_db)  (double* z, const double* x, double s, unsigned int n, unsigned int op);
+	void (*axpy_int)(int* z, int a, const int* x, const int* y, unsigned int n);
+	void (*axpy_db) (double* z, double a, const double* x, const double* y, unsigned int n);
 };
 
 
@@ -124,9 +229,24 @@ struct array__struct {
  *	FUNCTION DECLARATIONS
  */
 
+const array_kernels* array__kernels();
+
 unsigned int array__type_bytes(unsigned int type);
 
 array* array_new(unsigned int size, unsigned int type);
+array* array_new_alloc(unsigned int size, unsigned int type, const ulib_allocator* alloc);
+
+/* Element-wise arithmetic into a new array, from the allocator of 'x' */
+array* array_add(array* x, array* y);
+array* array_sub(array* x, array* y);
+array* array_mul(array* x, array* y);
+array* array_div(array* x, array* y);
+array* array_add_scalar(array* x, ...);
+array* array_sub_scalar(array* x, ...);
+array* array_mul_scalar(array* x, ...);
+array* array_div_scalar(array* x, ...);
+array* array_axpy(array* y, array* x, ...);
+
 unsigned int array__length(array* arr);
 void array__free(array* arr);
 void array__debug(array* arr);
@@ -174,27 +294,1215 @@ double array__mean_int(array* arr);
 double array__mean_db(array* arr);
 double array__mean(array* arr);
 
-int array__has_nan(array* arr);
-int array__has_matherr(array* arr);
+void array__describe_int(array* arr, array_stats* st);
+void array__describe_db(array* arr, array_stats* st);
+void array__describe(array* arr, array_stats* st);
+
+int array__has_nan(array* arr);
+int array__has_matherr(array* arr);
+
+/* Arithmetic, in place */
+array* array__add(array* arr, array* other);
+array* array__sub(array* arr, array* other);
+array* array__mul(array* arr, array* other);
+array* array__div(array* arr, array* other);
+array* array__add_scalar(array* arr, ...);
+array* array__sub_scalar(array* arr, ...);
+array* array__mul_scalar(array* arr, ...);
+array* array__div_scalar(array* arr, ...);
+array* array__axpy(array* arr, array* x, ...);
+
+/* No need to know type, just copy chunks of bytes around */
+void array__reverse(array* arr);
+
+void array__sort(array* arr);
+void array__sort_parallel(array* arr, unsigned int threads);
+unsigned int array__lower_bound(array* arr, ...);
+unsigned int array__upper_bound(array* arr, ...);
+unsigned int array__equal_range(array* arr, unsigned int* end, ...);
+
+
+#endif /* array.h */
+
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		IMPLEMENTATION
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifdef ARRAY_IMPLEMENTATION
+
+/* 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+	Reduction kernels
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+/* Scalar tier. Empty inputs yield zero. */
+
+static int array__sum_int_scalar(const int* x, unsigned int n){
+	unsigned int i, sum = 0; /* unsigned, so overflow wraps */
+	for(i=0; i!=n; ++i) sum += (unsigned int)x[i];
+	return (int)sum;
+}
+
+static double array__sum_db_scalar(const double* x, unsigned int n){
+	double sum = 0;
+	unsigned int i;
+	for(i=0; i!=n; ++i) sum += x[i];
+	return sum;
+}
+
+static int array__max_int_scalar(const int* x, unsigned int n){
+	unsigned int i;
+	int max = n ? x[0] : 0;
+	for(i=1; i<n; ++i) if(max < x[i]) max = x[i];
+	return max;
+}
+
+static double array__max_db_scalar(const double* x, unsigned int n){
+	unsigned int i;
+	double max = n ? x[0] : 0;
+	for(i=1; i<n; ++i) if(max < x[i]) max = x[i];
+	return max;
+}
+
+static int array__min_int_scalar(const int* x, unsigned int n){
+	unsigned int i;
+	int min = n ? x[0] : 0;
+	for(i=1; i<n; ++i) if(min > x[i]) min = x[i];
+	return min;
+}
+
+static double array__min_db_scalar(const double* x, unsigned int n){
+	unsigned int i;
+	double min = n ? x[0] : 0;
+	for(i=1; i<n; ++i) if(min > x[i]) min = x[i];
+	return min;
+}
+
+/* Index of the first maximum/minimum */
+
+static unsigned int array__imax_int_scalar(const int* x, unsigned int n){
+	unsigned int i, j = 0;
+	for(i=1; i<n; ++i) if(x[j] < x[i]) j = i;
+	return j;
+}
+
+static unsigned int array__imax_db_scalar(const double* x, unsigned int n){
+	unsigned int i, j = 0;
+	for(i=1; i<n; ++i) if(x[j] < x[i]) j = i;
+	return j;
+}
+
+static unsigned int array__imin_int_scalar(const int* x, unsigned int n){
+	unsigned int i, j = 0;
+	for(i=1; i<n; ++i) if(x[j] > x[i]) j = i;
+	return j;
+}
+
+static unsigned int array__imin_db_scalar(const double* x, unsigned int n){
+	unsigned int i, j = 0;
+	for(i=1; i<n; ++i) if(x[j] > x[i]) j = i;
+	return j;
+}
+
+/*
+Describe kernels. The sums are taken over each member minus a shift k,
+the first member that is not NaN (or 0 if that one is infinite), so the
+variance from Q - S*S/count keeps its digits when the mean is far from
+zero. An infinite member makes Q infinite, so infinities are only
+counted when it is.
+*/
+
+#ifdef ULIB_X86
+ULIB__TARGET("sse2")
+static double array__sqrt_sse2(double v){
+	return _mm_cvtsd_f64(_mm_sqrt_sd(_mm_set_sd(v), _mm_set_sd(v)));
+}
+#endif
+
+/*
+Square root without libm: the SSE2 instruction where the CPU has one,
+else Newton's method, which may be one unit off in the last place.
+*/
+static double array__sqrt(double v){
+	double r, s = 1;
+	int k;
+	if(!(v > 0) || ULIB_ISINF(v)) return v; /* 0, NaN and Inf */
+#ifdef ULIB_X86
+	if(ulib_cpu_detect() >= ULIB_CPU_SSE2) return array__sqrt_sse2(v);
+#endif
+	/* Scale by powers of 4 into [1,4) */
+	while(v > 65536.0)       { v *= 1.0/65536.0; s *= 256.0; }
+	while(v < 1.0/65536.0)   { v *= 65536.0;     s *= 1.0/256.0; }
+	while(v >= 4.0)          { v *= 0.25;        s *= 2.0; }
+	while(v < 1.0)           { v *= 4.0;         s *= 0.5; }
+	r = (1.0 + v)/2.0;
+	for(k=0; k!=6; ++k) r = (r + v/r)/2.0;
+	return r*s;
+}
+
+static void array__stats_begin(array_stats* st, unsigned int nans, unsigned int i, double first){
+	st->count = 0;
+	st->nans = nans;
+	st->infs = 0;
+	st->imin = st->imax = i;
+	st->min = st->max = first;
+	st->sum = st->mean = st->var = st->stddev = 0;
+}
+
+/* Fills the moments from the shifted sums S and Q */
+static void array__stats_end(array_stats* st, unsigned int n, double k, double s, double q){
+	double c;
+	st->count = n - st->nans;
+	c = (double)st->count;
+	st->sum = s + c*k;
+	st->mean = k + s/c;
+	st->var = (q - s*s/c)/c;
+	if(st->var < 0) st->var = 0; /* rounding */
+	st->stddev = array__sqrt(st->var);
+}
+
+/* Folds x[i..n) into the extremes of 'st' and the shifted sums *s and *q */
+static void array__describe_int_fold(const int* x, unsigned int i, unsigned int n,
+		double k, array_stats* st, double* s, double* q){
+	double d, sum = *s, sq = *q;
+	for(; i<n; ++i){
+		if(x[i] < st->min){ st->min = x[i]; st->imin = i; }
+		if(x[i] > st->max){ st->max = x[i]; st->imax = i; }
+		d = (double)x[i] - k;
+		sum += d;
+		sq += d*d;
+	}
+	*s = sum;
+	*q = sq;
+}
+
+/* As above, counting NaNs and leaving them out */
+static void array__describe_db_fold(const double* x, unsigned int i, unsigned int n,
+		double k, array_stats* st, double* s, double* q){
+	double d, sum = *s, sq = *q;
+	for(; i<n; ++i){
+		if(ULIB_ISNAN(x[i])){ st->nans++; continue; }
+		if(x[i] < st->min){ st->min = x[i]; st->imin = i; }
+		if(x[i] > st->max){ st->max = x[i]; st->imax = i; }
+		d = x[i] - k;
+		sum += d;
+		sq += d*d;
+	}
+	*s = sum;
+	*q = sq;
+}
+
+static void array__describe_db_end(const double* x, unsigned int n,
+		double k, double s, double q, array_stats* st){
+	unsigned int i;
+	if(ULIB_ISINF(q)){
+		for(i=0; i!=n; ++i) if(ULIB_ISINF(x[i])) st->infs++;
+	}
+	array__stats_end(st, n, k, s, q);
+}
+
+static void array__describe_int_scalar(const int* x, unsigned int n, array_stats* st){
+	double s = 0, q = 0;
+	array__stats_begin(st, 0, 0, n ? x[0] : 0);
+	if(!n) return;
+	array__describe_int_fold(x, 0, n, x[0], st, &s, &q);
+	array__stats_end(st, n, x[0], s, q);
+}
+
+static void array__describe_db_scalar(const double* x, unsigned int n, array_stats* st){
+	unsigned int f;
+	double k, s = 0, q = 0;
+	for(f=0; f<n && ULIB_ISNAN(x[f]); ++f);
+	if(f == n){
+		array__stats_begin(st, n, 0, 0);
+		return;
+	}
+	array__stats_begin(st, f, f, x[f]);
+	k = ULIB_ISINF(x[f]) ? 0 : x[f];
+	array__describe_db_fold(x, f, n, k, st, &s, &q);
+	array__describe_db_end(x, n, k, s, q, st);
+}
+
+#ifdef ULIB_X86
+
+/*
+SSE2 tier. Sums and extremes run four accumulators over 16 bytes each,
+so consecutive additions do not wait on one another. Extremes start
+every lane at x[0] and keep a lane's value unless a member is strictly
+greater (or smaller), as the scalar loops do, so NaNs are skipped
+unless x[0] is one. Sums of doubles add in another order than the
+scalar loop, so the last bits may differ.
+*/
+
+/* Lanewise a > b ? a : b, and a < b ? a : b */
+ULIB__TARGET("sse2")
+static __m128i array__max_epi32_sse2(__m128i a, __m128i b){
+	__m128i m = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+
+ULIB__TARGET("sse2")
+static __m128i array__min_epi32_sse2(__m128i a, __m128i b){
+	__m128i m = _mm_cmpgt_epi32(b, a);
+	return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+
+/*
+Index of the first member equal to 'v', or 'n' if none is. The index
+searches find the extreme first: the scalar loops keep the first
+member that no later one strictly beats, which is the first equal to
+the extreme, since a NaN never equals anything and -0 equals 0.
+*/
+ULIB__TARGET("sse2")
+static unsigned int array__find_int_sse2(const int* x, unsigned int n, int v){
+	const __m128i pat = _mm_set1_epi32(v);
+	unsigned int i, mask;
+	for(i=0; n - i >= 8; i += 8){
+		mask = (unsigned int)_mm_movemask_epi8(_mm_packs_epi32(
+			_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(x + i)), pat),
+			_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(x + i + 4)), pat)));
+		if(mask) return i + ulib__ctz(mask)/2;
+	}
+	for(; i<n && x[i] != v; ++i);
+	return i;
+}
+
+ULIB__TARGET("sse2")
+static unsigned int array__find_db_sse2(const double* x, unsigned int n, double v){
+	const __m128d pat = _mm_set1_pd(v);
+	unsigned int i, mask;
+	for(i=0; n - i >= 4; i += 4){
+		mask = (unsigned int)_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(x + i), pat))
+			| (unsigned int)_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(x + i + 2), pat)) << 2;
+		if(mask) return i + ulib__ctz(mask);
+	}
+	for(; i<n && x[i] != v; ++i);
+	return i;
+}
+
+ULIB__TARGET("sse2")
+static int array__sum_int_sse2(const int* x, unsigned int n){
+	__m128i a = _mm_setzero_si128(), b = a, c = a, d = a;
+	unsigned int i, lane[4];
+	for(i=0; n - i >= 16; i += 16){
+		a = _mm_add_epi32(a, _mm_loadu_si128((const __m128i*)(x + i)));
+		b = _mm_add_epi32(b, _mm_loadu_si128((const __m128i*)(x + i + 4)));
+		c = _mm_add_epi32(c, _mm_loadu_si128((const __m128i*)(x + i + 8)));
+		d = _mm_add_epi32(d, _mm_loadu_si128((const __m128i*)(x + i + 12)));
+	}
+	_mm_storeu_si128((__m128i*)lane, _mm_add_epi32(_mm_add_epi32(a, b), _mm_add_epi32(c, d)));
+	return (int)(lane[0] + lane[1] + lane[2] + lane[3] + (unsigned int)array__sum_int_scalar(x + i, n - i));
+}
+
+ULIB__TARGET("sse2")
+static double array__sum_db_sse2(const double* x, unsigned int n){
+	__m128d a = _mm_setzero_pd(), b = a, c = a, d = a;
+	unsigned int i;
+	double lane[2];
+	for(i=0; n - i >= 8; i += 8){
+		a = _mm_add_pd(a, _mm_loadu_pd(x + i));
+		b = _mm_add_pd(b, _mm_loadu_pd(x + i + 2));
+		c = _mm_add_pd(c, _mm_loadu_pd(x + i + 4));
+		d = _mm_add_pd(d, _mm_loadu_pd(x + i + 6));
+	}
+	_mm_storeu_pd(lane, _mm_add_pd(_mm_add_pd(a, b), _mm_add_pd(c, d)));
+	return lane[0] + lane[1] + array__sum_db_scalar(x + i, n - i);
+}
+
+ULIB__TARGET("sse2")
+static int array__max_int_sse2(const int* x, unsigned int n){
+	__m128i a, b, c, d;
+	unsigned int i, k;
+	int lane[4], max;
+	if(n < 16) return array__max_int_scalar(x, n);
+	a = b = c = d = _mm_set1_epi32(x[0]);
+	for(i=0; n - i >= 16; i += 16){
+		a = array__max_epi32_sse2(_mm_loadu_si128((const __m128i*)(x + i)), a);
+		b = array__max_epi32_sse2(_mm_loadu_si128((const __m128i*)(x + i + 4)), b);
+		c = array__max_epi32_sse2(_mm_loadu_si128((const __m128i*)(x + i + 8)), c);
+		d = array__max_epi32_sse2(_mm_loadu_si128((const __m128i*)(x + i + 12)), d);
+	}
+	_mm_storeu_si128((__m128i*)lane, array__max_epi32_sse2(array__max_epi32_sse2(a, b), array__max_epi32_sse2(c, d)));
+	max = lane[0];
+	for(k=1; k!=4; ++k) if(max < lane[k]) max = lane[k];
+	for(; i<n; ++i) if(max < x[i]) max = x[i];
+	return max;
+}
+
+ULIB__TARGET("sse2")
+static double array__max_db_sse2(const double* x, unsigned int n){
+	__m128d a, b, c, d;
+	unsigned int i;
+	double lane[2], max;
+	if(n < 8) return array__max_db_scalar(x, n);
+	a = b = c = d = _mm_set1_pd(x[0]);
+	for(i=0; n - i >= 8; i += 8){
+		/* max_pd returns its second operand when either is NaN */
+		a = _mm_max_pd(_mm_loadu_pd(x + i), a);
+		b = _mm_max_pd(_mm_loadu_pd(x + i + 2), b);
+		c = _mm_max_pd(_mm_loadu_pd(x + i + 4), c);
+		d = _mm_max_pd(_mm_loadu_pd(x + i + 6), d);
+	}
+	_mm_storeu_pd(lane, _mm_max_pd(_mm_max_pd(b, a), _mm_max_pd(d, c)));
+	max = lane[0];
+	if(max < lane[1]) max = lane[1];
+	for(; i<n; ++i) if(max < x[i]) max = x[i];
+	/* max_pd may keep either zero of a tie, where the scalar loop keeps the first */
+	return max == 0 ? x[array__find_db_sse2(x, n, 0.0)] : max;
+}
+
+ULIB__TARGET("sse2")
+static int array__min_int_sse2(const int* x, unsigned int n){
+	__m128i a, b, c, d;
+	unsigned int i, k;
+	int lane[4], min;
+	if(n < 16) return array__min_int_scalar(x, n);
+	a = b = c = d = _mm_set1_epi32(x[0]);
+	for(i=0; n - i >= 16; i += 16){
+		a = array__min_epi32_sse2(_mm_loadu_si128((const __m128i*)(x + i)), a);
+		b = array__min_epi32_sse2(_mm_loadu_si128((const __m128i*)(x + i + 4)), b);
+		c = array__min_epi32_sse2(_mm_loadu_si128((const __m128i*)(x + i + 8)), c);
+		d = array__min_epi32_sse2(_mm_loadu_si128((const __m128i*)(x + i + 12)), d);
+	}
+	_mm_storeu_si128((__m128i*)lane, array__min_epi32_sse2(array__min_epi32_sse2(a, b), array__min_epi32_sse2(c, d)));
+	min = lane[0];
+	for(k=1; k!=4; ++k) if(min > lane[k]) min = lane[k];
+	for(; i<n; ++i) if(min > x[i]) min = x[i];
+	return min;
+}
+
+ULIB__TARGET("sse2")
+static double array__min_db_sse2(const double* x, unsigned int n){
+	__m128d a, b, c, d;
+	unsigned int i;
+	double lane[2], min;
+	if(n < 8) return array__min_db_scalar(x, n);
+	a = b = c = d = _mm_set1_pd(x[0]);
+	for(i=0; n - i >= 8; i += 8){
+		a = _mm_min_pd(_mm_loadu_pd(x + i), a);
+		b = _mm_min_pd(_mm_loadu_pd(x + i + 2), b);
+		c = _mm_min_pd(_mm_loadu_pd(x + i + 4), c);
+		d = _mm_min_pd(_mm_loadu_pd(x + i + 6), d);
+	}
+	_mm_storeu_pd(lane, _mm_min_pd(_mm_min_pd(b, a), _mm_min_pd(d, c)));
+	min = lane[0];
+	if(min > lane[1]) min = lane[1];
+	for(; i<n; ++i) if(min > x[i]) min = x[i];
+	/* min_pd may keep either zero of a tie, where the scalar loop keeps the first */
+	return min == 0 ? x[array__find_db_sse2(x, n, 0.0)] : min;
+}
+
+ULIB__TARGET("sse2")
+static unsigned int array__imax_int_sse2(const int* x, unsigned int n){
+	return array__find_int_sse2(x, n, array__max_int_sse2(x, n));
+}
+
+ULIB__TARGET("sse2")
+static unsigned int array__imax_db_sse2(const double* x, unsigned int n){
+	double max = array__max_db_sse2(x, n);
+	return ULIB_ISNAN(max) ? 0 : array__find_db_sse2(x, n, max);
+}
+
+ULIB__TARGET("sse2")
+static unsigned int array__imin_int_sse2(const int* x, unsigned int n){
+	return array__find_int_sse2(x, n, array__min_int_sse2(x, n));
+}
+
+ULIB__TARGET("sse2")
+static unsigned int array__imin_db_sse2(const double* x, unsigned int n){
+	double min = array__min_db_sse2(x, n);
+	return ULIB_ISNAN(min) ? 0 : array__find_db_sse2(x, n, min);
+}
+
+/* AVX2 tier, as the SSE2 one over 32 bytes per register */
+
+ULIB__TARGET("avx2")
+static unsigned int array__find_int_avx2(const int* x, unsigned int n, int v){
+	const __m256i pat = _mm256_set1_epi32(v);
+	unsigned int i, mask;
+	for(i=0; n - i >= 16; i += 16){
+		mask = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(
+			_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(x + i)), pat)))
+			| (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(
+			_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(x + i + 8)), pat))) << 8;
+		if(mask) return i + ulib__ctz(mask);
+	}
+	for(; i<n && x[i] != v; ++i);
+	return i;
+}
+
+ULIB__TARGET("avx2")
+static unsigned int array__find_db_avx2(const double* x, unsigned int n, double v){
+	const __m256d pat = _mm256_set1_pd(v);
+	unsigned int i, mask;
+	for(i=0; n - i >= 8; i += 8){
+		mask = (unsigned int)_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(x + i), pat, _CMP_EQ_OQ))
+			| (unsigned int)_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(x + i + 4), pat, _CMP_EQ_OQ)) << 4;
+		if(mask) return i + ulib__ctz(mask);
+	}
+	for(; i<n && x[i] != v; ++i);
+	return i;
+}
+
+ULIB__TARGET("avx2")
+static int array__sum_int_avx2(const int* x, unsigned int n){
+	__m256i a = _mm256_setzero_si256(), b = a, c = a, d = a;
+	unsigned int i, lane[8], k, sum = 0;
+	for(i=0; n - i >= 32; i += 32){
+		a = _mm256_add_epi32(a, _mm256_loadu_si256((const __m256i*)(x + i)));
+		b = _mm256_add_epi32(b, _mm256_loadu_si256((const __m256i*)(x + i + 8)));
+		c = _mm256_add_epi32(c, _mm256_loadu_si256((const __m256i*)(x + i + 16)));
+		d = _mm256_add_epi32(d, _mm256_loadu_si256((const __m256i*)(x + i + 24)));
+	}
+	_mm256_storeu_si256((__m256i*)lane, _mm256_add_epi32(_mm256_add_epi32(a, b), _mm256_add_epi32(c, d)));
+	for(k=0; k!=8; ++k) sum += lane[k];
+	return (int)(sum + (unsigned int)array__sum_int_scalar(x + i, n - i));
+}
+
+ULIB__TARGET("avx2")
+static double array__sum_db_avx2(const double* x, unsigned int n){
+	__m256d a = _mm256_setzero_pd(), b = a, c = a, d = a;
+	unsigned int i;
+	double lane[4];
+	for(i=0; n - i >= 16; i += 16){
+		a = _mm256_add_pd(a, _mm256_loadu_pd(x + i));
+		b = _mm256_add_pd(b, _mm256_loadu_pd(x + i + 4));
+		c = _mm256_add_pd(c, _mm256_loadu_pd(x + i + 8));
+		d = _mm256_add_pd(d, _mm256_loadu_pd(x + i + 12));
+	}
+	_mm256_storeu_pd(lane, _mm256_add_pd(_mm256_add_pd(a, b), _mm256_add_pd(c, d)));
+	return (lane[0] + lane[1]) + (lane[2] + lane[3]) + array__sum_db_scalar(x + i, n - i);
+}
+
+ULIB__TARGET("avx2")
+static int array__max_int_avx2(const int* x, unsigned int n){
+	__m256i a, b, c, d;
+	unsigned int i, k;
+	int lane[8], max;
+	if(n < 32) return array__max_int_scalar(x, n);
+	a = b = c = d = _mm256_set1_epi32(x[0]);
+	for(i=0; n - i >= 32; i += 32){
+		a = _mm256_max_epi32(a, _mm256_loadu_si256((const __m256i*)(x + i)));
+		b = _mm256_max_epi32(b, _mm256_loadu_si256((const __m256i*)(x + i + 8)));
+		c = _mm256_max_epi32(c, _mm256_loadu_si256((const __m256i*)(x + i + 16)));
+		d = _mm256_max_epi32(d, _mm256_loadu_si256((const __m256i*)(x + i + 24)));
+	}
+	_mm256_storeu_si256((__m256i*)lane, _mm256_max_epi32(_mm256_max_epi32(a, b), _mm256_max_epi32(c, d)));
+	max = lane[0];
+	for(k=1; k!=8; ++k) if(max < lane[k]) max = lane[k];
+	for(; i<n; ++i) if(max < x[i]) max = x[i];
+	return max;
+}
+
+ULIB__TARGET("avx2")
+static double array__max_db_avx2(const double* x, unsigned int n){
+	__m256d a, b, c, d;
+	unsigned int i, k;
+	double lane[4], max;
+	if(n < 16) return array__max_db_scalar(x, n);
+	a = b = c = d = _mm256_set1_pd(x[0]);
+	for(i=0; n - i >= 16; i += 16){
+		a = _mm256_max_pd(_mm256_loadu_pd(x + i), a);
+		b = _mm256_max_pd(_mm256_loadu_pd(x + i + 4), b);
+		c = _mm256_max_pd(_mm256_loadu_pd(x + i + 8), c);
+		d = _mm256_max_pd(_mm256_loadu_pd(x + i + 12), d);
+	}
+	_mm256_storeu_pd(lane, _mm256_max_pd(_mm256_max_pd(b, a), _mm256_max_pd(d, c)));
+	max = lane[0];
+	for(k=1; k!=4; ++k) if(max < lane[k]) max = lane[k];
+	for(; i<n; ++i) if(max < x[i]) max = x[i];
+	/* max_pd may keep either zero of a tie, where the scalar loop keeps the first */
+	return max == 0 ? x[array__find_db_avx2(x, n, 0.0)] : max;
+}
+
+ULIB__TARGET("avx2")
+static int array__min_int_avx2(const int* x, unsigned int n){
+	__m256i a, b, c, d;
+	unsigned int i, k;
+	int lane[8], min;
+	if(n < 32) return array__min_int_scalar(x, n);
+	a = b = c = d = _mm256_set1_epi32(x[0]);
+	for(i=0; n - i >= 32; i += 32){
+		a = _mm256_min_epi32(a, _mm256_loadu_si256((const __m256i*)(x + i)));
+		b = _mm256_min_epi32(b, _mm256_loadu_si256((const __m256i*)(x + i + 8)));
+		c = _mm256_min_epi32(c, _mm256_loadu_si256((const __m256i*)(x + i + 16)));
+		d = _mm256_min_epi32(d, _mm256_loadu_si256((const __m256i*)(x + i + 24)));
+	}
+	_mm256_storeu_si256((__m256i*)lane, _mm256_min_epi32(_mm256_min_epi32(a, b), _mm256_min_epi32(c, d)));
+	min = lane[0];
+	for(k=1; k!=8; ++k) if(min > lane[k]) min = lane[k];
+	for(; i<n; ++i) if(min > x[i]) min = x[i];
+	return min;
+}
+
+ULIB__TARGET("avx2")
+static double array__min_db_avx2(const double* x, unsigned int n){
+	__m256d a, b, c, d;
+	unsigned int i, k;
+	double lane[4], min;
+	if(n < 16) return array__min_db_scalar(x, n);
+	a = b = c = d = _mm256_set1_pd(x[0]);
+	for(i=0; n - i >= 16; i += 16){
+		a = _mm256_min_pd(_mm256_loadu_pd(x + i), a);
+		b = _mm256_min_pd(_mm256_loadu_pd(x + i + 4), b);
+		c = _mm256_min_pd(_mm256_loadu_pd(x + i + 8), c);
+		d = _mm256_min_pd(_mm256_loadu_pd(x + i + 12), d);
+	}
+	_mm256_storeu_pd(lane, _mm256_min_pd(_mm256_min_pd(b, a), _mm256_min_pd(d, c)));
+	min = lane[0];
+	for(k=1; k!=4; ++k) if(min > lane[k]) min = lane[k];
+	for(; i<n; ++i) if(min > x[i]) min = x[i];
+	/* min_pd may keep either zero of a tie, where the scalar loop keeps the first */
+	return min == 0 ? x[array__find_db_avx2(x, n, 0.0)] : min;
+}
+
+ULIB__TARGET("avx2")
+static unsigned int array__imax_int_avx2(const int* x, unsigned int n){
+	return array__find_int_avx2(x, n, array__max_int_avx2(x, n));
+}
+
+ULIB__TARGET("avx2")
+static unsigned int array__imax_db_avx2(const double* x, unsigned int n){
+	double max = array__max_db_avx2(x, n);
+	return ULIB_ISNAN(max) ? 0 : array__find_db_avx2(x, n, max);
+}
+
+ULIB__TARGET("avx2")
+static unsigned int array__imin_int_avx2(const int* x, unsigned int n){
+	return array__find_int_avx2(x, n, array__min_int_avx2(x, n));
+}
+
+ULIB__TARGET("avx2")
+static unsigned int array__imin_db_avx2(const double* x, unsigned int n){
+	double min = array__min_db_avx2(x, n);
+	return ULIB_ISNAN(min) ? 0 : array__find_db_avx2(x, n, min);
+}
+
+/*
+Describe kernels. The array is taken in chunks that fit the L1 cache,
+the lanes keeping only the extremes' values; when a chunk beats the
+extreme so far, its first member equal to the new one is found while
+the chunk is still cached. Earlier chunks hold nothing below (or
+above) it, so that is the first extreme, as in the scalar loop. NaN
+lanes are masked out of the sums and counted.
+*/
+#define ARRAY__CHUNK 4096 /* members per chunk, a multiple of 8 */
+
+ULIB__TARGET("avx2")
+static void array__describe_int_avx2(const int* x, unsigned int n, array_stats* st){
+	__m256i v, mn, mx;
+	__m256d k, lo, hi, s0, s1, q0, q1;
+	int ilane[8], cmin, cmax;
+	unsigned int i, c, end, j;
+	double lane[4], s, q;
+
+	if(n < 32){
+		array__describe_int_scalar(x, n, st);
+		return;
+	}
+	k = _mm256_set1_pd((double)x[0]);
+	s0 = s1 = q0 = q1 = _mm256_setzero_pd();
+	array__stats_begin(st, 0, 0, x[0]);
+	for(c=0; n - c >= 8; c = end){
+		end = n - c > ARRAY__CHUNK ? c + ARRAY__CHUNK : c + (n - c)/8*8;
+		mn = _mm256_set1_epi32((int)st->min);
+		mx = _mm256_set1_epi32((int)st->max);
+		for(i=c; i!=end; i += 8){
+			v = _mm256_loadu_si256((const __m256i*)(x + i));
+			mn = _mm256_min_epi32(mn, v);
+			mx = _mm256_max_epi32(mx, v);
+			lo = _mm256_sub_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)), k);
+			hi = _mm256_sub_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), k);
+			s0 = _mm256_add_pd(s0, lo);
+			q0 = _mm256_add_pd(q0, _mm256_mul_pd(lo, lo));
+			s1 = _mm256_add_pd(s1, hi);
+			q1 = _mm256_add_pd(q1, _mm256_mul_pd(hi, hi));
+		}
+		_mm256_storeu_si256((__m256i*)ilane, mn);
+		for(cmin = ilane[0], j=1; j!=8; ++j) if(cmin > ilane[j]) cmin = ilane[j];
+		_mm256_storeu_si256((__m256i*)ilane, mx);
+		for(cmax = ilane[0], j=1; j!=8; ++j) if(cmax < ilane[j]) cmax = ilane[j];
+		if(cmin < st->min){
+			st->min = cmin;
+			st->imin = c + array__find_int_avx2(x + c, end - c, cmin);
+		}
+		if(cmax > st->max){
+			st->max = cmax;
+			st->imax = c + array__find_int_avx2(x + c, end - c, cmax);
+		}
+	}
+	_mm256_storeu_pd(lane, _mm256_add_pd(s0, s1));
+	s = (lane[0] + lane[1]) + (lane[2] + lane[3]);
+	_mm256_storeu_pd(lane, _mm256_add_pd(q0, q1));
+	q = (lane[0] + lane[1]) + (lane[2] + lane[3]);
+	array__describe_int_fold(x, c, n, x[0], st, &s, &q);
+	array__stats_end(st, n, x[0], s, q);
+}
+
+ULIB__TARGET("avx2")
+static void array__describe_db_avx2(const double* x, unsigned int n, array_stats* st){
+	static const unsigned char bits[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+	__m256d k, v, m, d, sa, sb, qa, qb, mna, mnb, mxa, mxb;
+	double lane[4], kd, s, q, cmin, cmax;
+	unsigned int f, i, c, end, j, nans = 0;
+
+	for(f=0; f<n && ULIB_ISNAN(x[f]); ++f);
+	if(n - f < 16){
+		array__describe_db_scalar(x, n, st);
+		return;
+	}
+	kd = ULIB_ISINF(x[f]) ? 0 : x[f];
+	k = _mm256_set1_pd(kd);
+	sa = sb = qa = qb = _mm256_setzero_pd();
+	array__stats_begin(st, f, f, x[f]);
+	for(c=f; n - c >= 8; c = end){
+		end = n - c > ARRAY__CHUNK ? c + ARRAY__CHUNK : c + (n - c)/8*8;
+		mna = mnb = _mm256_set1_pd(st->min);
+		mxa = mxb = _mm256_set1_pd(st->max);
+		for(i=c; i!=end; i += 8){
+			/* min_pd and max_pd return their second operand when either is NaN */
+			v = _mm256_loadu_pd(x + i);
+			m = _mm256_cmp_pd(v, v, _CMP_UNORD_Q);
+			nans += bits[_mm256_movemask_pd(m)];
+			d = _mm256_andnot_pd(m, _mm256_sub_pd(v, k));
+			sa = _mm256_add_pd(sa, d);
+			qa = _mm256_add_pd(qa, _mm256_mul_pd(d, d));
+			mna = _mm256_min_pd(v, mna);
+			mxa = _mm256_max_pd(v, mxa);
+
+			v = _mm256_loadu_pd(x + i + 4);
+			m = _mm256_cmp_pd(v, v, _CMP_UNORD_Q);
+			nans += bits[_mm256_movemask_pd(m)];
+			d = _mm256_andnot_pd(m, _mm256_sub_pd(v, k));
+			sb = _mm256_add_pd(sb, d);
+			qb = _mm256_add_pd(qb, _mm256_mul_pd(d, d));
+			mnb = _mm256_min_pd(v, mnb);
+			mxb = _mm256_max_pd(v, mxb);
+		}
+		_mm256_storeu_pd(lane, _mm256_min_pd(mna, mnb));
+		for(cmin = lane[0], j=1; j!=4; ++j) if(cmin > lane[j]) cmin = lane[j];
+		_mm256_storeu_pd(lane, _mm256_max_pd(mxa, mxb));
+		for(cmax = lane[0], j=1; j!=4; ++j) if(cmax < lane[j]) cmax = lane[j];
+		if(cmin < st->min){
+			st->imin = c + array__find_db_avx2(x + c, end - c, cmin);
+			st->min = x[st->imin]; /* 0 or -0, whichever came first */
+		}
+		if(cmax > st->max){
+			st->imax = c + array__find_db_avx2(x + c, end - c, cmax);
+			st->max = x[st->imax];
+		}
+	}
+	st->nans += nans;
+	_mm256_storeu_pd(lane, _mm256_add_pd(sa, sb));
+	s = (lane[0] + lane[1]) + (lane[2] + lane[3]);
+	_mm256_storeu_pd(lane, _mm256_add_pd(qa, qb));
+	q = (lane[0] + lane[1]) + (lane[2] + lane[3]);
+	array__describe_db_fold(x, c, n, kd, st, &s, &q);
+	array__describe_db_end(x, n, kd, s, q, st);
+}
+
+#endif /* ULIB_X86 */
+
+/* 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+	Arithmetic kernels
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+/*
+Scalar tier. Ints are added and multiplied as unsigned, so overflow
+wraps, and INT_MIN / -1 wraps to INT_MIN. Every tier rounds each
+double operation once, in the same order, so results match exactly.
+*/
+
+static void array__op_int_scalar(int* z, const int* x, const int* y, unsigned int n, unsigned int op){
+	unsigned int i;
+	switch(op){
+		case ARRAY_ADD:
+			for(i=0; i!=n; ++i) z[i] = (int)((unsigned int)x[i] + (unsigned int)y[i]);
+			break;
+		case ARRAY_SUB:
+			for(i=0; i!=n; ++i) z[i] = (int)((unsigned int)x[i] - (unsigned int)y[i]);
+			break;
+		case ARRAY_MUL:
+			for(i=0; i!=n; ++i) z[i] = (int)((unsigned int)x[i] * (unsigned int)y[i]);
+			break;
+		case ARRAY_DIV:
+			for(i=0; i!=n; ++i) z[i] = y[i] == -1 ? (int)(0u - (unsigned int)x[i]) : x[i]/y[i];
+			break;
+	}
+}
+
+static void array__op_db_scalar(double* z, const double* x, const double* y, unsigned int n, unsigned int op){
+	unsigned int i;
+	switch(op){
+		case ARRAY_ADD:
+			for(i=0; i!=n; ++i) z[i] = x[i] + y[i];
+			break;
+		case ARRAY_SUB:
+			for(i=0; i!=n; ++i) z[i] = x[i] - y[i];
+			break;
+		case ARRAY_MUL:
+			for(i=0; i!=n; ++i) z[i] = x[i] * y[i];
+			break;
+		case ARRAY_DIV:
+			for(i=0; i!=n; ++i) z[i] = x[i] / y[i];
+			break;
+	}
+}
+
+static void array__ops_int_scalar(int* z, const int* x, int s, unsigned int n, unsigned int op){
+	unsigned int i;
+	switch(op){
+		case ARRAY_ADD:
+			for(i=0; i!=n; ++i) z[i] = (int)((unsigned int)x[i] + (unsigned int)s);
+			break;
+		case ARRAY_SUB:
+			for(i=0; i!=n; ++i) z[i] = (int)((unsigned int)x[i] - (unsigned int)s);
+			break;
+		case ARRAY_MUL:
+			for(i=0; i!=n; ++i) z[i] = (int)((unsigned int)x[i] * (unsigned int)s);
+			break;
+		case ARRAY_DIV:
+			if(s == -1) for(i=0; i!=n; ++i) z[i] = (int)(0u - (unsigned int)x[i]);
+			else for(i=0; i!=n; ++i) z[i] = x[i]/s;
+			break;
+	}
+}
+
+static void array__ops_db_scalar(double* z, const double* x, double s, unsigned int n, unsigned int op){
+	unsigned int i;
+	switch(op){
+		case ARRAY_ADD:
+			for(i=0; i!=n; ++i) z[i] = x[i] + s;
+			break;
+		case ARRAY_SUB:
+			for(i=0; i!=n; ++i) z[i] = x[i] - s;
+			break;
+		case ARRAY_MUL:
+			for(i=0; i!=n; ++i) z[i] = x[i] * s;
+			break;
+		case ARRAY_DIV:
+			for(i=0; i!=n; ++i) z[i] = x[i] / s;
+			break;
+	}
+}
+
+static void array__axpy_int_scalar(int* z, int a, const int* x, const int* y, unsigned int n){
+	unsigned int i;
+	for(i=0; i!=n; ++i) z[i] = (int)((unsigned int)a*(unsigned int)x[i] + (unsigned int)y[i]);
+}
+
+static void array__axpy_db_scalar(double* z, double a, const double* x, const double* y, unsigned int n){
+	unsigned int i;
+	for(i=0; i!=n; ++i) z[i] = a*x[i] + y[i];
+}
+
+#ifdef ULIB_X86
+
+/*
+SSE2 tier. SSE2 has no 32-bit multiply keeping the low half, so it is
+built from two 32x32->64 bit ones on the even and odd lanes. There is
+no vector integer division: int divisions run the scalar loops.
+*/
+
+ULIB__TARGET("sse2")
+static __m128i array__mullo_epi32_sse2(__m128i a, __m128i b){
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+		_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+ULIB__TARGET("sse2")
+static void array__op_int_sse2(int* z, const int* x, const int* y, unsigned int n, unsigned int op){
+	__m128i a, b;
+	unsigned int i = 0;
+	switch(op){
+		case ARRAY_ADD:
+			for(; n - i >= 4; i += 4){
+				a = _mm_loadu_si128((const __m128i*)(x + i));
+				b = _mm_loadu_si128((const __m128i*)(y + i));
+				_mm_storeu_si128((__m128i*)(z + i), _mm_add_epi32(a, b));
+			}
+			break;
+		case ARRAY_SUB:
+			for(; n - i >= 4; i += 4){
+				a = _mm_loadu_si128((const __m128i*)(x + i));
+				b = _mm_loadu_si128((const __m128i*)(y + i));
+				_mm_storeu_si128((__m128i*)(z + i), _mm_sub_epi32(a, b));
+			}
+			break;
+		case ARRAY_MUL:
+			for(; n - i >= 4; i += 4){
+				a = _mm_loadu_si128((const __m128i*)(x + i));
+				b = _mm_loadu_si128((const __m128i*)(y + i));
+				_mm_storeu_si128((__m128i*)(z + i), array__mullo_epi32_sse2(a, b));
+			}
+			break;
+	}
+	array__op_int_scalar(z + i, x + i, y + i, n - i, op);
+}
+
+ULIB__TARGET("sse2")
+static void array__op_db_sse2(double* z, const double* x, const double* y, unsigned int n, unsigned int op){
+	unsigned int i = 0;
+	switch(op){
+		case ARRAY_ADD:
+			for(; n - i >= 2; i += 2) _mm_storeu_pd(z + i, _mm_add_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+			break;
+		case ARRAY_SUB:
+			for(; n - i >= 2; i += 2) _mm_storeu_pd(z + i, _mm_sub_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+			break;
+		case ARRAY_MUL:
+			for(; n - i >= 2; i += 2) _mm_storeu_pd(z + i, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+			break;
+		case ARRAY_DIV:
+			for(; n - i >= 2; i += 2) _mm_storeu_pd(z + i, _mm_div_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+			break;
+	}
+	array__op_db_scalar(z + i, x + i, y + i, n - i, op);
+}
+
+ULIB__TARGET("sse2")
+static void array__ops_int_sse2(int* z, const int* x, int s, unsigned int n, unsigned int op){
+	const __m128i b = _mm_set1_epi32(s);
+	__m128i a;
+	unsigned int i = 0;
+	switch(op){
+		case ARRAY_ADD:
+			for(; n - i >= 4; i += 4){
+				a = _mm_loadu_si128((const __m128i*)(x + i));
+				_mm_storeu_si128((__m128i*)(z + i), _mm_add_epi32(a, b));
+			}
+			break;
+		case ARRAY_SUB:
+			for(; n - i >= 4; i += 4){
+				a = _mm_loadu_si128((const __m128i*)(x + i));
+				_mm_storeu_si128((__m128i*)(z + i), _mm_sub_epi32(a, b));
+			}
+			break;
+		case ARRAY_MUL:
+			for(; n - i >= 4; i += 4){
+				a = _mm_loadu_si128((const __m128i*)(x + i));
+				_mm_storeu_si128((__m128i*)(z + i), array__mullo_epi32_sse2(a, b));
+			}
+			break;
+	}
+	array__ops_int_scalar(z + i, x + i, s, n - i, op);
+}
+
+ULIB__TARGET("sse2")
+static void array__ops_db_sse2(double* z, const double* x, double s, unsigned int n, unsigned int op){
+	const __m128d b = _mm_set1_pd(s);
+	unsigned int i = 0;
+	switch(op){
+		case ARRAY_ADD:
+			for(; n - i >= 2; i += 2) _mm_storeu_pd(z + i, _mm_add_pd(_mm_loadu_pd(x + i), b));
+			break;
+		case ARRAY_SUB:
+			for(; n - i >= 2; i += 2) _mm_storeu_pd(z + i, _mm_sub_pd(_mm_loadu_pd(x + i), b));
+			break;
+		case ARRAY_MUL:
+			for(; n - i >= 2; i += 2) _mm_storeu_pd(z + i, _mm_mul_pd(_mm_loadu_pd(x + i), b));
+			break;
+		case ARRAY_DIV:
+			for(; n - i >= 2; i += 2) _mm_storeu_pd(z + i, _mm_div_pd(_mm_loadu_pd(x + i), b));
+			break;
+	}
+	array__ops_db_scalar(z + i, x + i, s, n - i, op);
+}
+
+ULIB__TARGET("sse2")
+static void array__axpy_int_sse2(int* z, int a, const int* x, const int* y, unsigned int n){
+	const __m128i av = _mm_set1_epi32(a);
+	__m128i b;
+	unsigned int i;
+	for(i=0; n - i >= 4; i += 4){
+		b = array__mullo_epi32_sse2(av, _mm_loadu_si128((const __m128i*)(x + i)));
+		_mm_storeu_si128((__m128i*)(z + i), _mm_add_epi32(b, _mm_loadu_si128((const __m128i*)(y + i))));
+	}
+	array__axpy_int_scalar(z + i, a, x + i, y + i, n - i);
+}
+
+ULIB__TARGET("sse2")
+static void array__axpy_db_sse2(double* z, double a, const double* x, const double* y, unsigned int n){
+	const __m128d av = _mm_set1_pd(a);
+	unsigned int i;
+	for(i=0; n - i >= 2; i += 2){
+		_mm_storeu_pd(z + i, _mm_add_pd(_mm_mul_pd(av, _mm_loadu_pd(x + i)), _mm_loadu_pd(y + i)));
+	}
+	array__axpy_db_scalar(z + i, a, x + i, y + i, n - i);
+}
+
+/* AVX2 tier, as the SSE2 one over 32 bytes per register */
+
+ULIB__TARGET("avx2")
+static void array__op_int_avx2(int* z, const int* x, const int* y, unsigned int n, unsigned int op){
+	__m256i a, b;
+	unsigned int i = 0;
+	switch(op){
+		case ARRAY_ADD:
+			for(; n - i >= 8; i += 8){
+				a = _mm256_loadu_si256((const __m256i*)(x + i));
+				b = _mm256_loadu_si256((const __m256i*)(y + i));
+				_mm256_storeu_si256((__m256i*)(z + i), _mm256_add_epi32(a, b));
+			}
+			break;
+		case ARRAY_SUB:
+			for(; n - i >= 8; i += 8){
+				a = _mm256_loadu_si256((const __m256i*)(x + i));
+				b = _mm256_loadu_si256((const __m256i*)(y + i));
+				_mm256_storeu_si256((__m256i*)(z + i), _mm256_sub_epi32(a, b));
+			}
+			break;
+		case ARRAY_MUL:
+			for(; n - i >= 8; i += 8){
+				a = _mm256_loadu_si256((const __m256i*)(x + i));
+				b = _mm256_loadu_si256((const __m256i*)(y + i));
+				_mm256_storeu_si256((__m256i*)(z + i), _mm256_mullo_epi32(a, b));
+			}
+			break;
+	}
+	_mm256_zeroupper(); /* GCC leaves it out before the tail call */
+	array__op_int_scalar(z + i, x + i, y + i, n - i, op);
+}
+
+ULIB__TARGET("avx2")
+static void array__op_db_avx2(double* z, const double* x, const double* y, unsigned int n, unsigned int op){
+	unsigned int i = 0;
+	switch(op){
+		case ARRAY_ADD:
+			for(; n - i >= 4; i += 4) _mm256_storeu_pd(z + i, _mm256_add_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+			break;
+		case ARRAY_SUB:
+			for(; n - i >= 4; i += 4) _mm256_storeu_pd(z + i, _mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+			break;
+		case ARRAY_MUL:
+			for(; n - i >= 4; i += 4) _mm256_storeu_pd(z + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+			break;
+		case ARRAY_DIV:
+			for(; n - i >= 4; i += 4) _mm256_storeu_pd(z + i, _mm256_div_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+			break;
+	}
+	_mm256_zeroupper(); /* GCC leaves it out before the tail call */
+	array__op_db_scalar(z + i, x + i, y + i, n - i, op);
+}
 
-/* No need to know type, just copy chunks of bytes around */
-void array__reverse(array* arr);
+ULIB__TARGET("avx2")
+static void array__ops_int_avx2(int* z, const int* x, int s, unsigned int n, unsigned int op){
+	const __m256i b = _mm256_set1_epi32(s);
+	__m256i a;
+	unsigned int i = 0;
+	switch(op){
+		case ARRAY_ADD:
+			for(; n - i >= 8; i += 8){
+				a = _mm256_loadu_si256((const __m256i*)(x + i));
+				_mm256_storeu_si256((__m256i*)(z + i), _mm256_add_epi32(a, b));
+			}
+			break;
+		case ARRAY_SUB:
+			for(; n - i >= 8; i += 8){
+				a = _mm256_loadu_si256((const __m256i*)(x + i));
+				_mm256_storeu_si256((__m256i*)(z + i), _mm256_sub_epi32(a, b));
+			}
+			break;
+		case ARRAY_MUL:
+			for(; n - i >= 8; i += 8){
+				a = _mm256_loadu_si256((const __m256i*)(x + i));
+				_mm256_storeu_si256((__m256i*)(z + i), _mm256_mullo_epi32(a, b));
+			}
+			break;
+	}
+	_mm256_zeroupper(); /* GCC leaves it out before the tail call */
+	array__ops_int_scalar(z + i, x + i, s, n - i, op);
+}
+
+ULIB__TARGET("avx2")
+static void array__ops_db_avx2(double* z, const double* x, double s, unsigned int n, unsigned int op){
+	const __m256d b = _mm256_set1_pd(s);
+	unsigned int i = 0;
+	switch(op){
+		case ARRAY_ADD:
+			for(; n - i >= 4; i += 4) _mm256_storeu_pd(z + i, _mm256_add_pd(_mm256_loadu_pd(x + i), b));
+			break;
+		case ARRAY_SUB:
+			for(; n - i >= 4; i += 4) _mm256_storeu_pd(z + i, _mm256_sub_pd(_mm256_loadu_pd(x + i), b));
+			break;
+		case ARRAY_MUL:
+			for(; n - i >= 4; i += 4) _mm256_storeu_pd(z + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), b));
+			break;
+		case ARRAY_DIV:
+			for(; n - i >= 4; i += 4) _mm256_storeu_pd(z + i, _mm256_div_pd(_mm256_loadu_pd(x + i), b));
+			break;
+	}
+	_mm256_zeroupper(); /* GCC leaves it out before the tail call */
+	array__ops_db_scalar(z + i, x + i, s, n - i, op);
+}
 
+ULIB__TARGET("avx2")
+static void array__axpy_int_avx2(int* z, int a, const int* x, const int* y, unsigned int n){
+	const __m256i av = _mm256_set1_epi32(a);
+	__m256i b;
+	unsigned int i;
+	for(i=0; n - i >= 8; i += 8){
+		b = _mm256_mullo_epi32(av, _mm256_loadu_si256((const __m256i*)(x + i)));
+		_mm256_storeu_si256((__m256i*)(z + i), _mm256_add_epi32(b, _mm256_loadu_si256((const __m256i*)(y + i))));
+	}
+	array__axpy_int_scalar(z + i, a, x + i, y + i, n - i);
+}
 
-#endif /* array.h */
+/* Multiplies and adds apart, not fused, to round as the other tiers do */
+ULIB__TARGET("avx2")
+static void array__axpy_db_avx2(double* z, double a, const double* x, const double* y, unsigned int n){
+	const __m256d av = _mm256_set1_pd(a);
+	unsigned int i;
+	for(i=0; n - i >= 4; i += 4){
+		_mm256_storeu_pd(z + i, _mm256_add_pd(_mm256_mul_pd(av, _mm256_loadu_pd(x + i)), _mm256_loadu_pd(y + i)));
+	}
+	array__axpy_db_scalar(z + i, a, x + i, y + i, n - i);
+}
 
+#endif /* ULIB_X86 */
+
+/* In the order of ulib__cpu_tiers, tiers past the last use the last */
+static const array_kernels array__kernel_tiers[] = {
+	{
+		array__sum_int_scalar,
+		array__sum_db_scalar,
+		array__max_int_scalar,
+		array__max_db_scalar,
+		array__min_int_scalar,
+		array__min_db_scalar,
+		array__imax_int_scalar,
+		array__imax_db_scalar,
+		array__imin_int_scalar,
+		array__imin_db_scalar,
+		array__describe_int_scalar,
+		array__describe_db_scalar,
+		array__op_int_scalar,
+		array__op_db_scalar,
+		array__ops_int_scalar,
+		array__ops_db_scalar,
+		array__axpy_int_scalar,
+		array__axpy_db_scalar
+	},
+#ifdef ULIB_X86
+	{
+		array__sum_int_sse2,
+		array__sum_db_sse2,
+		array__max_int_sse2,
+		array__max_db_sse2,
+		array__min_int_sse2,
+		array__min_db_sse2,
+		array__imax_int_sse2,
+		array__imax_db_sse2,
+		array__imin_int_sse2,
+		array__imin_db_sse2,
+		array__describe_int_scalar,
+		array__describe_db_scalar,
+		array__op_int_sse2,
+		array__op_db_sse2,
+		array__ops_int_sse2,
+		array__ops_db_sse2,
+		array__axpy_int_sse2,
+		array__axpy_db_sse2
+	},
+	{
+		array__sum_int_avx2,
+		array__sum_db_avx2,
+		array__max_int_avx2,
+		array__max_db_avx2,
+		array__min_int_avx2,
+		array__min_db_avx2,
+		array__imax_int_avx2,
+		array__imax_db_avx2,
+		array__imin_int_avx2,
+		array__imin_db_avx2,
+		array__describe_int_avx2,
+		array__describe_db_avx2,
+		array__op_int_avx2,
+		array__op_db_avx2,
+		array__ops_int_avx2,
+		array__ops_db_avx2,
+		array__axpy_int_avx2,
+		array__axpy_db_avx2
+	}
+#endif
+};
 
+const array_kernels* array__kernels(){
+	unsigned int tier = ulib_cpu_tier();
+	unsigned int last = sizeof(array__kernel_tiers)/sizeof(array__kernel_tiers[0]) - 1;
+	return &array__kernel_tiers[tier < last ? tier : last];
+}
 
-/*
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-		IMPLEMENTATION
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+/* 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 */
 
-#ifdef ARRAY_IMPLEMENTATION
 
+#ifdef ULIB_SHARED_VTABLE
+/* In the order of ARRAY__METHODS */
+static const array_vtable array__methods = {
+	array__length,
+	array__free,
+	array__print,
+	array__fill,
+	array__fill_range,
+	array__fill_linspace,
+	array__from_c_array,
+	array__reverse,
+	array__sort,
+	array__sort_parallel,
+	array__lower_bound,
+	array__upper_bound,
+	array__equal_range,
+	array__setval_int,
+	array__setval_db,
+	array__getval_int,
+	array__getval_db,
+	array__getptr,
+	array__max_int,
+	array__max_db,
+	array__min_int,
+	array__min_db,
+	array__imax,
+	array__imin,
+	array__sum_int,
+	array__sum_db,
+	array__mean,
+	array__describe,
+	array__add,
+	array__sub,
+	array__mul,
+	array__div,
+	array__add_scalar,
+	array__sub_scalar,
+	array__mul_scalar,
+	array__div_scalar,
+	array__axpy
+};
+#endif
+
+static array* array__new(unsigned int size, unsigned int type, const ulib_allocator* alloc, int zero);
 
 array* array_new(unsigned int size, unsigned int type){
+	return array_new_alloc(size, type, NULL);
+}
+
+/* As array_new, taking all memory from 'alloc' (NULL for the default) */
+array* array_new_alloc(unsigned int size, unsigned int type, const ulib_allocator* alloc){
+	return array__new(size, type, alloc, 1);
+}
+
+/* Leaves the members uninitialised unless 'zero' is set */
+static array* array__new(unsigned int size, unsigned int type, const ulib_allocator* alloc, int zero){
 	unsigned int bytes;
 	array* arr;
 
@@ -203,16 +1511,25 @@ array* array_new(unsigned int size, unsigned int type){
 		return NULL;
 	}
 
+	if(!alloc) alloc = &ulib_default_allocator;
 	bytes = array__type_bytes(type);
-	arr = ULIB_MALLOC(sizeof(array));
+	arr = ulib__alloc(alloc, sizeof(array), ULIB_TAG_ARRAY);
 	if(!arr) return NULL;
 
 	arr->size = size;
 	arr->type = type;
 	arr->bytes = bytes;
-	arr->data = calloc(size, bytes);
-	if(!arr->data) return NULL;
+	arr->alloc = alloc;
+	arr->data = zero ? ulib__zalloc(alloc, size*bytes, ULIB_TAG_ARRAY)
+		: ulib__alloc(alloc, size*bytes, ULIB_TAG_ARRAY);
+	if(!arr->data && size){
+		ulib__dealloc(alloc, arr, sizeof(array), ULIB_TAG_ARRAY);
+		return NULL;
+	}
 	
+#ifdef ULIB_SHARED_VTABLE
+	arr->vt = &array__methods;
+#else
 	/* Function pointers */
 	arr->length = array__length;
 	arr->free = array__free;
@@ -239,7 +1556,24 @@ array* array_new(unsigned int size, unsigned int type){
 	arr->sumf = array__sum_db;
 
 	arr->mean = array__mean;
+	arr->describe = array__describe;
+
+	arr->add = array__add;
+	arr->sub = array__sub;
+	arr->mul = array__mul;
+	arr->div = array__div;
+	arr->add_scalar = array__add_scalar;
+	arr->sub_scalar = array__sub_scalar;
+	arr->mul_scalar = array__mul_scalar;
+	arr->div_scalar = array__div_scalar;
+	arr->axpy = array__axpy;
 	arr->reverse = array__reverse;
+	arr->sort = array__sort;
+	arr->sort_parallel = array__sort_parallel;
+	arr->lower_bound = array__lower_bound;
+	arr->upper_bound = array__upper_bound;
+	arr->equal_range = array__equal_range;
+#endif
 
 	return arr;
 }
@@ -258,8 +1592,8 @@ unsigned int array__length(array* arr){
 }
 
 void array__free(array* arr){
-	ULIB_FREE(arr->data);
-	ULIB_FREE(arr);
+	ulib__dealloc(arr->alloc, arr->data, arr->size*arr->bytes, ULIB_TAG_ARRAY);
+	ulib__dealloc(arr->alloc, arr, sizeof(array), ULIB_TAG_ARRAY);
 }
 
 void array__debug(array* arr){
@@ -406,7 +1740,7 @@ void array__fill_range(array* arr, ...){
 void array__fill_linspace_int(array* arr, int start, int step){
 	unsigned int i;
 	for(i=0; i!=arr->size; ++i){
-		arr->seti(arr, i, start);
+		array__setval_int(arr, i, start);
 		start += step;
 	}
 }
@@ -414,7 +1748,7 @@ void array__fill_linspace_int(array* arr, int start, int step){
 void array__fill_linspace_db(array* arr, double start, double step){
 	unsigned int i;
 	for(i=0; i!=arr->size; ++i){
-		arr->setf(arr, i, start);
+		array__setval_db(arr, i, start);
 		start += step;
 	}
 }
@@ -453,63 +1787,27 @@ void array__from_c_array(array* arr, const void* c_arr){
 */
 
 int array__max_int(array* arr){
-	int max = arr->geti(arr,0);
-	unsigned int i;
-	for(i=0; i!=arr->size; ++i){
-		if(max < arr->geti(arr,i)) max = arr->geti(arr,i);
-	}
-	return max;
+	return array__kernels()->max_int((const int*)arr->data, arr->size);
 }
 
 double array__max_db(array* arr){
-	double max = arr->getf(arr,0);
-	unsigned int i;
-	for(i=0; i!=arr->size; ++i){
-		if(max < arr->getf(arr,i)) max = arr->getf(arr,i);
-	}
-	return max;
+	return array__kernels()->max_db((const double*)arr->data, arr->size);
 }
 
 int array__min_int(array* arr){
-	int min = arr->geti(arr,0);
-	unsigned int i;
-	for(i=0; i!=arr->size; ++i){
-		if(min > arr->geti(arr,i)) min = arr->geti(arr,i);
-	}
-	return min;
+	return array__kernels()->min_int((const int*)arr->data, arr->size);
 }
 
 double array__min_db(array* arr){
-	double min = arr->getf(arr,0);
-	unsigned int i;
-	for(i=0; i!=arr->size; ++i){
-		if(min > arr->getf(arr,i)) min = arr->getf(arr,i);
-	}
-	return min;
+	return array__kernels()->min_db((const double*)arr->data, arr->size);
 }
 
 unsigned int array__imax_int(array* arr){
-	unsigned int i, j = 0;
-	int max = arr->geti(arr,0);
-	for(i=0; i!=arr->size; ++i){
-		if(max < arr->geti(arr,i)){
-			max = arr->geti(arr,i);
-			j = i;
-		}
-	}
-	return j;
+	return array__kernels()->imax_int((const int*)arr->data, arr->size);
 }
 
 unsigned int array__imax_db(array* arr){
-	unsigned int i, j = 0;
-	double max = arr->getf(arr,0);
-	for(i=0; i!=arr->size; ++i){
-		if(max < arr->getf(arr,i)){
-			max = arr->getf(arr,i);
-			j = i;
-		}
-	}
-	return j;
+	return array__kernels()->imax_db((const double*)arr->data, arr->size);
 }
 
 unsigned int array__imax(array* arr){
@@ -521,29 +1819,12 @@ unsigned int array__imax(array* arr){
 	}
 }
 
-
 unsigned int array__imin_int(array* arr){
-	unsigned int i, j = 0;
-	int min = arr->geti(arr,0);
-	for(i=0; i!=arr->size; ++i){
-		if(min > arr->geti(arr,i)){
-			min = arr->geti(arr,i);
-			j = i;
-		}
-	}
-	return j;
+	return array__kernels()->imin_int((const int*)arr->data, arr->size);
 }
 
 unsigned int array__imin_db(array* arr){
-	unsigned int i, j = 0;
-	double min = arr->getf(arr,0);
-	for(i=0; i!=arr->size; ++i){
-		if(min > arr->getf(arr,i)){
-			min = arr->getf(arr,i);
-			j = i;
-		}
-	}
-	return j;
+	return array__kernels()->imin_db((const double*)arr->data, arr->size);
 }
 
 unsigned int array__imin(array* arr){
@@ -556,25 +1837,19 @@ unsigned int array__imin(array* arr){
 }
 
 int array__sum_int(array* arr){
-	int sum = 0;
-	unsigned int i;
-	for(i=0; i!=arr->size; ++i) sum += arr->geti(arr,i);
-	return sum;
+	return array__kernels()->sum_int((const int*)arr->data, arr->size);
 }
 
 double array__sum_db(array* arr){
-	double sum = 0;
-	unsigned int i;
-	for(i=0; i!=arr->size; ++i) sum += arr->getf(arr,i);
-	return sum;
+	return array__kernels()->sum_db((const double*)arr->data, arr->size);
 }
 
 double array__mean_int(array* arr){
-	return (double)arr->sumi(arr)/(double)arr->size;
+	return (double)array__sum_int(arr)/(double)arr->size;
 }
 
 double array__mean_db(array* arr){
-	return arr->sumf(arr)/(double)arr->size;
+	return array__sum_db(arr)/(double)arr->size;
 }
 
 double array__mean(array* arr){
@@ -586,11 +1861,31 @@ double array__mean(array* arr){
 	}
 }
 
+void array__describe_int(array* arr, array_stats* st){
+	array__kernels()->describe_int((const int*)arr->data, arr->size, st);
+}
+
+void array__describe_db(array* arr, array_stats* st){
+	array__kernels()->describe_db((const double*)arr->data, arr->size, st);
+}
+
+void array__describe(array* arr, array_stats* st){
+	switch(arr->type){
+		case TYPE_INT: default:
+			array__describe_int(arr, st);
+			break;
+		case TYPE_DOUBLE:
+			array__describe_db(arr, st);
+			break;
+	}
+}
+
 int array__has_nan(array* arr){
-	if (arr->type == TYPE_INT) return 0;
+	const double* x = (const double*)arr->data;
 	unsigned int i, cnt = 0;
-	for(i=0; i!=arr->length(arr); ++i){
-		if( ULIB_ISNAN(arr->getf(arr,i)) ){
+	if (arr->type == TYPE_INT) return 0;
+	for(i=0; i!=arr->size; ++i){
+		if( ULIB_ISNAN(x[i]) ){
 			cnt++;
 		}
 	}
@@ -598,75 +1893,328 @@ int array__has_nan(array* arr){
 }
 
 int array__has_matherr(array* arr){
-	if (arr->type == TYPE_INT) return 0;
+	const double* x = (const double*)arr->data;
 	unsigned int i, cnt = 0;
-	for(i=0; i!=arr->length(arr); ++i){
-		if( ULIB_ISNAN(arr->getf(arr,i)) || ULIB_ISINF(arr->getf(arr,i)) ){
+	if (arr->type == TYPE_INT) return 0;
+	for(i=0; i!=arr->size; ++i){
+		if( ULIB_ISNAN(x[i]) || ULIB_ISINF(x[i]) ){
 			cnt++;
 		}
 	}
 	return cnt;
 }
 
-void array__reverse(array* arr){
-	ULIB_PRINTF("WIP array->reverse (%u)\n", (unsigned int)arr->size);
-}
-
-
 /* 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+	Arithmetic
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 */
 
+/*
+Operand arrays must match in type and length. The in-place forms
+return 'arr', and the array_* forms a new array; both return NULL
+if the operands do not match or an int divisor is zero, leaving
+'arr' unchanged, and the array_* forms if memory runs out.
+Scalar operands are ints or doubles, as the array.
+*/
 
-#endif /* ARRAY_IMPLEMENTATION */
+/* Writes x op y into z, which matches x */
+static array* array__op(array* z, array* x, array* y, unsigned int op){
+	const int* yi = (const int*)y->data;
+	unsigned int i;
+	if(x->type != y->type || x->size != y->size) return NULL;
+	switch(x->type){
+		case TYPE_INT:
+			if(op == ARRAY_DIV) for(i=0; i!=y->size; ++i) if(!yi[i]) return NULL;
+			array__kernels()->op_int((int*)z->data, (const int*)x->data, yi, x->size, op);
+			break;
+		case TYPE_DOUBLE:
+			array__kernels()->op_db((double*)z->data, (const double*)x->data,
+				(const double*)y->data, x->size, op);
+			break;
+	}
+	return z;
+}
 
+/* Writes x op s into z, reading s from 'args' */
+static array* array__ops(array* z, array* x, unsigned int op, ULIB_VA_LIST* args){
+	int s;
+	switch(x->type){
+		case TYPE_INT:
+			s = ULIB_VA_ARG(*args, int);
+			if(op == ARRAY_DIV && !s) return NULL;
+			array__kernels()->ops_int((int*)z->data, (const int*)x->data, s, x->size, op);
+			break;
+		case TYPE_DOUBLE:
+			array__kernels()->ops_db((double*)z->data, (const double*)x->data,
+				ULIB_VA_ARG(*args, double), x->size, op);
+			break;
+	}
+	return z;
+}
 
-/*
+/* Writes a*x + y into z, reading a from 'args' */
+static array* array__axpy_to(array* z, array* x, array* y, ULIB_VA_LIST* args){
+	if(x->type != y->type || x->size != y->size) return NULL;
+	switch(x->type){
+		case TYPE_INT:
+			array__kernels()->axpy_int((int*)z->data, ULIB_VA_ARG(*args, int),
+				(const int*)x->data, (const int*)y->data, x->size);
+			break;
+		case TYPE_DOUBLE:
+			array__kernels()->axpy_db((double*)z->data, ULIB_VA_ARG(*args, double),
+				(const double*)x->data, (const double*)y->data, x->size);
+			break;
+	}
+	return z;
+}
+
+array* array__add(array* arr, array* other){
+	return array__op(arr, arr, other, ARRAY_ADD);
+}
+
+array* array__sub(array* arr, array* other){
+	return array__op(arr, arr, other, ARRAY_SUB);
+}
+
+array* array__mul(array* arr, array* other){
+	return array__op(arr, arr, other, ARRAY_MUL);
+}
+
+array* array__div(array* arr, array* other){
+	return array__op(arr, arr, other, ARRAY_DIV);
+}
+
+array* array__add_scalar(array* arr, ...){
+	array* r;
+	ULIB_VA_LIST args;
+	ULIB_VA_START(args, arr);
+	r = array__ops(arr, arr, ARRAY_ADD, &args);
+	ULIB_VA_END(args);
+	return r;
+}
+
+array* array__sub_scalar(array* arr, ...){
+	array* r;
+	ULIB_VA_LIST args;
+	ULIB_VA_START(args, arr);
+	r = array__ops(arr, arr, ARRAY_SUB, &args);
+	ULIB_VA_END(args);
+	return r;
+}
 
-// Checks that a list is sorted
-int* sorted(int* data, int size){
-	for(int i=1; i!=size; ++i){
-		if(data[i] > data[i-1]) return NULL; //Assumes maximum is first element
+array* array__mul_scalar(array* arr, ...){
+	array* r;
+	ULIB_VA_LIST args;
+	ULIB_VA_START(args, arr);
+	r = array__ops(arr, arr, ARRAY_MUL, &args);
+	ULIB_VA_END(args);
+	return r;
+}
+
+array* array__div_scalar(array* arr, ...){
+	array* r;
+	ULIB_VA_LIST args;
+	ULIB_VA_START(args, arr);
+	r = array__ops(arr, arr, ARRAY_DIV, &args);
+	ULIB_VA_END(args);
+	return r;
+}
+
+/* arr += a*x */
+array* array__axpy(array* arr, array* x, ...){
+	array* r;
+	ULIB_VA_LIST args;
+	ULIB_VA_START(args, x);
+	r = array__axpy_to(arr, x, arr, &args);
+	ULIB_VA_END(args);
+	return r;
+}
+
+/* A new array for the result of an operation on x and y, or NULL if they do not match */
+static array* array__result(array* x, array* y){
+	if(y && (x->type != y->type || x->size != y->size)) return NULL;
+	return array__new(x->size, x->type, x->alloc, 0);
+}
+
+static array* array__op_new(array* x, array* y, unsigned int op){
+	array* z = array__result(x, y);
+	if(z && !array__op(z, x, y, op)){
+		array__free(z);
+		return NULL;
+	}
+	return z;
+}
+
+static array* array__ops_new(array* x, unsigned int op, ULIB_VA_LIST* args){
+	array* z = array__result(x, NULL);
+	if(z && !array__ops(z, x, op, args)){
+		array__free(z);
+		return NULL;
 	}
-	return data;
+	return z;
 }
 
+array* array_add(array* x, array* y){
+	return array__op_new(x, y, ARRAY_ADD);
+}
 
-// Sorting algorithms
-int* selsort(int *data, int size){
-	int c, i, maxi, swap;
-	c = 0;
-	while(c < size){
-		maxi = c;
-		for(i=c; i<size; ++i){
-			if(data[maxi] < data[i]){
-				maxi = i;
-			}
-		}
-		swap = data[c];
-		data[c] = data[maxi];
-		data[maxi] = swap;
-		c++;
-	}
-	return data;
-}
-
-int* bubblesort(int *data, int size){
-	int i, swap;
-	while(!sorted(data, size)){
-		for(i=1; i!=size; ++i){
-			if(data[i-1] >= data[i]) continue;
-			swap = data[i-1];
-			data[i-1] = data[i];
-			data[i] = swap;
-		}
+array* array_sub(array* x, array* y){
+	return array__op_new(x, y, ARRAY_SUB);
+}
+
+array* array_mul(array* x, array* y){
+	return array__op_new(x, y, ARRAY_MUL);
+}
+
+array* array_div(array* x, array* y){
+	return array__op_new(x, y, ARRAY_DIV);
+}
+
+array* array_add_scalar(array* x, ...){
+	array* r;
+	ULIB_VA_LIST args;
+	ULIB_VA_START(args, x);
+	r = array__ops_new(x, ARRAY_ADD, &args);
+	ULIB_VA_END(args);
+	return r;
+}
+
+array* array_sub_scalar(array* x, ...){
+	array* r;
+	ULIB_VA_LIST args;
+	ULIB_VA_START(args, x);
+	r = array__ops_new(x, ARRAY_SUB, &args);
+	ULIB_VA_END(args);
+	return r;
+}
+
+array* array_mul_scalar(array* x, ...){
+	array* r;
+	ULIB_VA_LIST args;
+	ULIB_VA_START(args, x);
+	r = array__ops_new(x, ARRAY_MUL, &args);
+	ULIB_VA_END(args);
+	return r;
+}
+
+array* array_div_scalar(array* x, ...){
+	array* r;
+	ULIB_VA_LIST args;
+	ULIB_VA_START(args, x);
+	r = array__ops_new(x, ARRAY_DIV, &args);
+	ULIB_VA_END(args);
+	return r;
+}
+
+/* Returns a*x + y in a new array */
+array* array_axpy(array* y, array* x, ...){
+	array* z = array__result(x, y);
+	ULIB_VA_LIST args;
+	if(!z) return NULL;
+	ULIB_VA_START(args, x);
+	array__axpy_to(z, x, y, &args);
+	ULIB_VA_END(args);
+	return z;
+}
+
+void array__reverse(array* arr){
+	ULIB_PRINTF("WIP array->reverse (%u)\n", (unsigned int)arr->size);
+}
+
+/* Sorts in ascending order, with scratch memory from the array's allocator */
+void array__sort(array* arr){
+	switch(arr->type){
+		case TYPE_INT:
+			sort_radix_int((int*)arr->data, arr->size, arr->alloc);
+			break;
+		case TYPE_DOUBLE:
+			sort_radix_db((double*)arr->data, arr->size, arr->alloc);
+			break;
+	}
+}
+
+/* As array__sort, on up to 'threads' threads (0 for one per processor) */
+void array__sort_parallel(array* arr, unsigned int threads){
+	switch(arr->type){
+		case TYPE_INT:
+			sort_parallel_int((int*)arr->data, arr->size, threads, arr->alloc);
+			break;
+		case TYPE_DOUBLE:
+			sort_parallel_db((double*)arr->data, arr->size, threads, arr->alloc);
+			break;
+	}
+}
+
+/*
+Binary searches over an array sorted in ascending order, taking
+an int or a double key as the array type.
+lower_bound returns the index of the first member not less than the key,
+upper_bound that of the first member greater than it, either being
+the size if there is no such member.
+*/
+unsigned int array__lower_bound(array* arr, ...){
+	unsigned int i = arr->size;
+	ULIB_VA_LIST args;
+	ULIB_VA_START(args, arr);
+	switch(arr->type){
+		case TYPE_INT:
+			i = sort_lower_bound_int((int*)arr->data, arr->size, ULIB_VA_ARG(args,int));
+			break;
+		case TYPE_DOUBLE:
+			i = sort_lower_bound_db((double*)arr->data, arr->size, ULIB_VA_ARG(args,double));
+			break;
+	}
+	ULIB_VA_END(args);
+	return i;
+}
+
+unsigned int array__upper_bound(array* arr, ...){
+	unsigned int i = arr->size;
+	ULIB_VA_LIST args;
+	ULIB_VA_START(args, arr);
+	switch(arr->type){
+		case TYPE_INT:
+			i = sort_upper_bound_int((int*)arr->data, arr->size, ULIB_VA_ARG(args,int));
+			break;
+		case TYPE_DOUBLE:
+			i = sort_upper_bound_db((double*)arr->data, arr->size, ULIB_VA_ARG(args,double));
+			break;
 	}
-	return data;
+	ULIB_VA_END(args);
+	return i;
 }
 
-//int* quick_sort();
+/* Returns lower_bound, and stores upper_bound in 'end' */
+unsigned int array__equal_range(array* arr, unsigned int* end, ...){
+	unsigned int i = arr->size;
+	int key_i;
+	double key_db;
+	ULIB_VA_LIST args;
+	ULIB_VA_START(args, end);
+	*end = arr->size;
+	switch(arr->type){
+		case TYPE_INT:
+			key_i = ULIB_VA_ARG(args,int);
+			i = sort_lower_bound_int((int*)arr->data, arr->size, key_i);
+			*end = i + sort_upper_bound_int((int*)arr->data + i, arr->size - i, key_i);
+			break;
+		case TYPE_DOUBLE:
+			key_db = ULIB_VA_ARG(args,double);
+			i = sort_lower_bound_db((double*)arr->data, arr->size, key_db);
+			*end = i + sort_upper_bound_db((double*)arr->data + i, arr->size - i, key_db);
+			break;
+	}
+	ULIB_VA_END(args);
+	return i;
+}
 
-//int* merge_sort();
 
+/* 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 */
 
+
+#endif /* ARRAY_IMPLEMENTATION */
+
+
@@ -0,0 +1,112 @@
+/*
+	Cost per member of several producer threads appending ints to one
+	shared container: a vector.h vector behind a mutex, against
+	appendvec.h with push and with push_array in blocks of 64. Each
+	repetition starts from an empty container and splits 'ops' members
+	between 1 to 32 producers; the scaling is bounded by the number of
+	cores of the machine.
+*/
+
+#include <pthread.h>
+#include "bench.h"
+
+#define VECTOR_IMPLEMENTATION
+#include "../vector.h"
+#define APPENDVEC_IMPLEMENTATION
+#include "../appendvec.h"
+
+#define MAX_PRODUCERS 32
+#define BLOCK 64
+
+struct producer {
+	vector* v;
+	pthread_mutex_t* lock;
+	appendvec* a;
+	unsigned long n;
+};
+
+struct ingest_case {
+	unsigned int producers;
+	void* (*fn)(void*);
+};
+
+static void* locked_push(void* arg){
+	struct producer* p = arg;
+	unsigned long i;
+	int x;
+	for(i=0; i!=p->n; ++i){
+		x = (int)i;
+		pthread_mutex_lock(p->lock);
+		p->v->push(p->v, &x);
+		pthread_mutex_unlock(p->lock);
+	}
+	return NULL;
+}
+
+static void* appendvec_push(void* arg){
+	struct producer* p = arg;
+	unsigned long i;
+	int x;
+	for(i=0; i!=p->n; ++i){
+		x = (int)i;
+		p->a->push(p->a, &x);
+	}
+	return NULL;
+}
+
+static void* appendvec_push_array(void* arg){
+	struct producer* p = arg;
+	unsigned long i;
+	int block[BLOCK] = {0};
+	for(i=0; i+BLOCK<=p->n; i+=BLOCK){
+		block[0] = (int)i;
+		p->a->push_array(p->a, block, BLOCK);
+	}
+	return NULL;
+}
+
+/* Runs the producers of the case over fresh containers */
+static void ingest(void* ctx, unsigned long ops){
+	struct ingest_case* c = ctx;
+	struct producer p[MAX_PRODUCERS];
+	pthread_t id[MAX_PRODUCERS];
+	pthread_mutex_t lock;
+	vector* v = vector_new(sizeof(int));
+	appendvec* a = appendvec_new(sizeof(int));
+	unsigned int t;
+
+	pthread_mutex_init(&lock, NULL);
+	for(t=0; t!=c->producers; ++t){
+		p[t].v = v;
+		p[t].lock = &lock;
+		p[t].a = a;
+		p[t].n = ops/c->producers;
+		pthread_create(&id[t], NULL, c->fn, &p[t]);
+	}
+	for(t=0; t!=c->producers; ++t) pthread_join(id[t], NULL);
+	bench_sink += v->length(v) + a->length(a);
+	pthread_mutex_destroy(&lock);
+	a->free(a);
+	v->free(v);
+}
+
+int main(){
+	unsigned int producers[] = {1, 2, 4, 8, 16, 32};
+	unsigned int i;
+	char param[32];
+	struct ingest_case c;
+	unsigned long ops = 1ul << 20;
+
+	bench_header();
+	for(i=0; i!=sizeof(producers)/sizeof(producers[0]); ++i){
+		sprintf(param, "%u", producers[i]);
+		c.producers = producers[i];
+		c.fn = locked_push;
+		bench_report("appendvec", "locked_vector_push", param, bench_run(ingest, &c, ops), sizeof(int));
+		c.fn = appendvec_push;
+		bench_report("appendvec", "appendvec_push", param, bench_run(ingest, &c, ops), sizeof(int));
+		c.fn = appendvec_push_array;
+		bench_report("appendvec", "appendvec_push_array", param, bench_run(ingest, &c, ops), sizeof(int));
+	}
+	return 0;
+}
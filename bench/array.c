@@ -0,0 +1,155 @@
+/*
+	Throughput of the array.h reductions over int and double arrays,
+	on every CPU tier this machine supports (scalar is the plain loop).
+	One operation is one call over the whole array. "describe" is
+	compared with "passes", the same summary from the separate
+	reductions plus a variance loop and a NaN/Inf count.
+	The element-wise operations run in place; "loop" is the same
+	addition through getf/setf (or geti/seti), and bytes count every
+	member read and written.
+*/
+
+#include "bench.h"
+
+#define ARRAY_IMPLEMENTATION
+#include "../array.h"
+
+typedef void (*reduce_fn)(array*);
+
+static void sumi(array* a){ bench_sink += a->sumi(a); }
+static void maxi(array* a){ bench_sink += a->maxi(a); }
+static void mini(array* a){ bench_sink += a->mini(a); }
+static void sumf(array* a){ bench_sink += (unsigned long)a->sumf(a); }
+static void maxf(array* a){ bench_sink += (unsigned long)a->maxf(a); }
+static void minf(array* a){ bench_sink += (unsigned long)a->minf(a); }
+static void imax(array* a){ bench_sink += a->imax(a); }
+static void imin(array* a){ bench_sink += a->imin(a); }
+
+static void describe(array* a){
+	array_stats st;
+	a->describe(a, &st);
+	bench_sink += st.imax + (unsigned long)st.stddev;
+}
+
+static void passes(array* a){
+	const int* xi = (const int*)a->data;
+	const double* xd = (const double*)a->data;
+	unsigned int i;
+	double mean = a->mean(a), d, var = 0;
+	bench_sink += a->imin(a) + a->imax(a);
+	if(a->type == TYPE_INT){
+		bench_sink += (unsigned long)(a->maxi(a) - a->mini(a));
+		for(i=0; i!=a->size; ++i){ d = xi[i] - mean; var += d*d; }
+	} else {
+		bench_sink += (unsigned long)(a->maxf(a) - a->minf(a)) + array__has_matherr(a);
+		for(i=0; i!=a->size; ++i){ d = xd[i] - mean; var += d*d; }
+	}
+	bench_sink += (unsigned long)(var/a->size);
+}
+
+struct reduce_case {
+	reduce_fn fn;
+	array* arr;
+};
+
+static void reduce_run(void* ctx, unsigned long ops){
+	struct reduce_case* c = ctx;
+	unsigned long r;
+	for(r=0; r!=ops; ++r) c->fn(c->arr);
+}
+
+static void reduce(const char* name, reduce_fn fn, array* arr){
+	struct reduce_case c;
+	unsigned long bytes = (unsigned long)arr->size * arr->bytes;
+	char param[32];
+	c.fn = fn;
+	c.arr = arr;
+	sprintf(param, "%s/%u/%s", arr->type == TYPE_INT ? "int" : "double", arr->size, ulib_cpu_name(ulib_cpu_tier()));
+	bench_report("array", name, param, bench_run(reduce_run, &c, (1ul << 24)/bytes + 1), bytes);
+}
+
+typedef void (*arith_fn)(array*, array*);
+
+static void add(array* a, array* b){ a->add(a, b); }
+static void mul_scalar(array* a, array* b){ (void)b; if(a->type == TYPE_INT) a->mul_scalar(a, 1); else a->mul_scalar(a, 1.0); }
+static void axpy(array* a, array* b){ if(a->type == TYPE_INT) a->axpy(a, b, 0); else a->axpy(a, b, 0.0); }
+static void add_loop(array* a, array* b){
+	unsigned int i;
+	if(a->type == TYPE_INT) for(i=0; i!=a->size; ++i) a->seti(a, i, a->geti(a, i) + b->geti(b, i));
+	else for(i=0; i!=a->size; ++i) a->setf(a, i, a->getf(a, i) + b->getf(b, i));
+}
+
+struct arith_case {
+	arith_fn fn;
+	array *a, *b;
+};
+
+static void arith_run(void* ctx, unsigned long ops){
+	struct arith_case* c = ctx;
+	unsigned long r;
+	for(r=0; r!=ops; ++r) c->fn(c->a, c->b);
+	bench_sink += c->a->data[0];
+}
+
+/* 'arrays' is how many arrays the operation reads or writes */
+static void arith(const char* name, arith_fn fn, array* a, array* b, unsigned int arrays){
+	struct arith_case c;
+	unsigned long bytes = (unsigned long)a->size * a->bytes * arrays;
+	char param[32];
+	c.fn = fn;
+	c.a = a;
+	c.b = b;
+	sprintf(param, "%s/%u/%s", a->type == TYPE_INT ? "int" : "double", a->size, ulib_cpu_name(ulib_cpu_tier()));
+	bench_report("array", name, param, bench_run(arith_run, &c, (1ul << 24)/bytes + 1), bytes);
+}
+
+int main(){
+	unsigned int sizes[] = {1024, 65536, 4u<<20};
+	unsigned int i, k, t;
+	array *ai, *ad, *bi, *bd;
+
+	bench_header();
+	for(i=0; i!=sizeof(sizes)/sizeof(sizes[0]); ++i){
+		ai = array_new(sizes[i], TYPE_INT);
+		ad = array_new(sizes[i], TYPE_DOUBLE);
+		bi = array_new(sizes[i], TYPE_INT);
+		bd = array_new(sizes[i], TYPE_DOUBLE);
+		for(k=0; k!=sizes[i]; ++k){
+			ai->seti(ai, k, (int)((k*2654435761u) >> 8));
+			ad->setf(ad, k, (double)((k*2654435761u) >> 8)*0.5);
+		}
+		for(t=ULIB_CPU_SCALAR; t<=ulib_cpu_detect(); ++t){
+			ulib_cpu_set_tier(t);
+			reduce("sum", sumi, ai);
+			reduce("max", maxi, ai);
+			reduce("min", mini, ai);
+			reduce("imax", imax, ai);
+			reduce("imin", imin, ai);
+			reduce("describe", describe, ai);
+			reduce("passes", passes, ai);
+			reduce("sum", sumf, ad);
+			reduce("max", maxf, ad);
+			reduce("min", minf, ad);
+			reduce("imax", imax, ad);
+			reduce("imin", imin, ad);
+			reduce("describe", describe, ad);
+			reduce("passes", passes, ad);
+			/* Adding zeros and scaling by one keep the data unchanged */
+			arith("add", add, ai, bi, 3);
+			arith("mul_scalar", mul_scalar, ai, bi, 2);
+			arith("axpy", axpy, ai, bi, 3);
+			arith("add", add, ad, bd, 3);
+			arith("mul_scalar", mul_scalar, ad, bd, 2);
+			arith("axpy", axpy, ad, bd, 3);
+			if(t == ULIB_CPU_SCALAR){
+				arith("loop", add_loop, ai, bi, 3);
+				arith("loop", add_loop, ad, bd, 3);
+			}
+		}
+		ai->free(ai);
+		ad->free(ad);
+		bi->free(bi);
+		bd->free(bd);
+	}
+	return 0;
+}
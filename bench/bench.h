@@ -0,0 +1,113 @@
+/*
+
+--- bench.h ---
+
+Small benchmark harness for the ulib benchmarks.
+Only meant for the programs in this folder.
+
+A case is a function running 'ops' operations on some context.
+bench_run() calls it BENCH_WARMUP times untimed, then BENCH_REPS
+times timed, and returns the median, 99th percentile and minimum
+time per operation. bench_report() prints one tab-separated line:
+
+	suite  case  param  median_ns  p99_ns  min_ns  bytes_op  GBps
+
+with a header line starting with '#' printed by bench_header().
+Set BENCH_REPS in the environment to change the repetitions.
+
+*/
+
+#ifndef BENCH_H
+#define BENCH_H 1
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef BENCH_REPS
+	#define BENCH_REPS 21
+#endif
+
+#ifndef BENCH_WARMUP
+	#define BENCH_WARMUP 2
+#endif
+
+#define BENCH_MAX_REPS 1001
+
+typedef void (*bench_fn)(void* ctx, unsigned long ops);
+
+typedef struct bench__stats_struct bench_stats;
+struct bench__stats_struct {
+	double median_ns, p99_ns, min_ns; /* per operation */
+	unsigned long ops, reps;
+};
+
+/* Returns a monotonic timestamp in seconds */
+double bench_now(){
+#if defined(CLOCK_MONOTONIC)
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec*1e-9;
+#else
+	return (double)clock()/(double)CLOCKS_PER_SEC;
+#endif
+}
+
+/* Keeps the compiler from optimising away a benchmarked result */
+volatile unsigned long bench_sink;
+
+/* Repetitions to run, from BENCH_REPS in the environment if set */
+unsigned long bench_reps(){
+	const char* env = getenv("BENCH_REPS");
+	long n = env ? strtol(env, NULL, 10) : 0;
+	if(n <= 0) return BENCH_REPS;
+	return n > BENCH_MAX_REPS ? BENCH_MAX_REPS : (unsigned long)n;
+}
+
+/* Times 'fn' over 'ops' operations per repetition */
+bench_stats bench_run(bench_fn fn, void* ctx, unsigned long ops){
+	static double samples[BENCH_MAX_REPS];
+	bench_stats st;
+	unsigned long r, i, reps = bench_reps();
+	double t0, x;
+
+	if(ops == 0) ops = 1;
+	for(r=0; r!=BENCH_WARMUP; ++r) fn(ctx, ops);
+	for(r=0; r!=reps; ++r){
+		t0 = bench_now();
+		fn(ctx, ops);
+		samples[r] = (bench_now() - t0)*1e9/(double)ops;
+	}
+
+	/* Insertion sort, repetitions are few */
+	for(r=1; r<reps; ++r){
+		x = samples[r];
+		for(i=r; i>0 && samples[i-1] > x; --i) samples[i] = samples[i-1];
+		samples[i] = x;
+	}
+	st.median_ns = samples[reps/2];
+	st.p99_ns = samples[(reps*99 + 99)/100 - 1];
+	st.min_ns = samples[0];
+	st.ops = ops;
+	st.reps = reps;
+	return st;
+}
+
+void bench_header(){
+	printf("# suite\tcase\tparam\tmedian_ns\tp99_ns\tmin_ns\tbytes_op\tGBps\n");
+}
+
+/* Prints one result line; 'bytes_op' of 0 means the case moves no data */
+void bench_report(const char* suite, const char* name, const char* param, bench_stats st, double bytes_op){
+	printf("%s\t%s\t%s\t%.3f\t%.3f\t%.3f\t%.0f\t", suite, name, param,
+		st.median_ns, st.p99_ns, st.min_ns, bytes_op);
+	if(bytes_op > 0) printf("%.3f\n", bytes_op/st.median_ns);
+	else printf("-\n");
+	fflush(stdout);
+}
+
+#endif /* BENCH_H */
@@ -0,0 +1,117 @@
+/*
+	Throughput of the defs.h copy engine and string scans against libc.
+	The param column is "<tier>/<bytes>", with tier "libc" for the C library.
+*/
+
+#include "bench.h"
+
+#define DEFS_IMPLEMENTATION
+#include "../defs.h"
+
+#include <string.h>
+
+#define BUDGET (1ul << 24) /* bytes moved per repetition */
+
+typedef void* (*copy_fn)(void*, const void*, unsigned int);
+typedef unsigned long (*scan_fn)(const unsigned char*, const unsigned char*, unsigned int);
+
+static void* libc_memcpy(void* d, const void* s, unsigned int n){ return memcpy(d, s, n); }
+static void* libc_memmove(void* d, const void* s, unsigned int n){ return memmove(d, s, n); }
+
+static unsigned long ulib_strlen(const unsigned char* a, const unsigned char* b, unsigned int n){ (void)b; (void)n; return ulib__strlen((const char*)a); }
+static unsigned long libc_strlen(const unsigned char* a, const unsigned char* b, unsigned int n){ (void)b; (void)n; return strlen((const char*)a); }
+static unsigned long ulib_strcmp(const unsigned char* a, const unsigned char* b, unsigned int n){ (void)n; return (unsigned long)ulib__strcmp((const char*)a, (const char*)b); }
+static unsigned long libc_strcmp(const unsigned char* a, const unsigned char* b, unsigned int n){ (void)n; return (unsigned long)strcmp((const char*)a, (const char*)b); }
+static unsigned long ulib_memchr(const unsigned char* a, const unsigned char* b, unsigned int n){ (void)b; return (unsigned long)ulib__memchr(a, 0, n); }
+static unsigned long libc_memchr(const unsigned char* a, const unsigned char* b, unsigned int n){ (void)b; return (unsigned long)memchr(a, 0, n); }
+static unsigned long ulib_memcmp(const unsigned char* a, const unsigned char* b, unsigned int n){ return (unsigned long)ulib__memcmp(a, b, n); }
+static unsigned long libc_memcmp(const unsigned char* a, const unsigned char* b, unsigned int n){ return (unsigned long)memcmp(a, b, n); }
+
+struct copy_case {
+	copy_fn fn;
+	unsigned char* buf;
+	unsigned int bytes, shift;
+};
+
+static void copy_run(void* ctx, unsigned long ops){
+	struct copy_case* c = ctx;
+	unsigned long r;
+	for(r=0; r!=ops; ++r){
+		c->fn(c->buf + c->shift, c->buf + c->bytes + 64, c->bytes);
+		bench_sink += c->buf[r % c->bytes];
+	}
+}
+
+struct scan_case {
+	scan_fn fn;
+	unsigned char *a, *b;
+	unsigned int bytes;
+};
+
+static void scan_run(void* ctx, unsigned long ops){
+	struct scan_case* c = ctx;
+	unsigned long r;
+	for(r=0; r!=ops; ++r) bench_sink += c->fn(c->a, c->b, c->bytes + 1);
+}
+
+static void copy(const char* name, const char* tier, copy_fn fn, unsigned char* buf, unsigned int bytes, unsigned int shift){
+	struct copy_case c;
+	char param[32];
+	c.fn = fn;
+	c.buf = buf;
+	c.bytes = bytes;
+	c.shift = shift;
+	sprintf(param, "%s/%u", tier, bytes);
+	bench_report("defs", name, param, bench_run(copy_run, &c, BUDGET/bytes + 1), bytes);
+}
+
+/* Scans two equal strings of 'bytes' characters */
+static void scan(const char* name, const char* tier, scan_fn fn, unsigned char* buf, unsigned int bytes){
+	struct scan_case c;
+	char param[32];
+	c.fn = fn;
+	c.a = buf + 1;
+	c.b = buf + bytes + 67;
+	c.bytes = bytes;
+	memset(c.a, 'x', bytes);
+	memset(c.b, 'x', bytes);
+	c.a[bytes] = c.b[bytes] = 0;
+	sprintf(param, "%s/%u", tier, bytes);
+	bench_report("defs", name, param, bench_run(scan_run, &c, BUDGET/bytes + 1), bytes);
+}
+
+int main(){
+	unsigned int sizes[] = {64, 1024, 16384, 262144, 4u<<20, 32u<<20};
+	unsigned int i, t, nsizes = sizeof(sizes)/sizeof(sizes[0]);
+	unsigned char* buf = ULIB_MALLOC(2*(32u<<20) + 256);
+	if(!buf) return 1;
+	memset(buf, 1, 2*(32u<<20) + 256);
+
+	bench_header();
+	for(i=0; i!=nsizes; ++i){
+		copy("memcpy", "libc", libc_memcpy, buf, sizes[i], 0);
+		copy("memcpy+3", "libc", libc_memcpy, buf, sizes[i], 3);
+		copy("memmove", "libc", libc_memmove, buf, sizes[i], 0);
+		for(t=0; t<=ulib_cpu_detect(); ++t){
+			const char* tier = ulib_cpu_name(ulib_cpu_set_tier(t));
+			copy("memcpy", tier, ulib__memcpy, buf, sizes[i], 0);
+			copy("memcpy+3", tier, ulib__memcpy, buf, sizes[i], 3);
+			copy("memmove", tier, ulib__memmove, buf, sizes[i], 0);
+		}
+	}
+	for(i=0; i!=nsizes-2; ++i){
+		scan("strlen", "libc", libc_strlen, buf, sizes[i]);
+		scan("strcmp", "libc", libc_strcmp, buf, sizes[i]);
+		scan("memchr", "libc", libc_memchr, buf, sizes[i]);
+		scan("memcmp", "libc", libc_memcmp, buf, sizes[i]);
+		for(t=0; t<=ulib_cpu_detect(); ++t){
+			const char* tier = ulib_cpu_name(ulib_cpu_set_tier(t));
+			scan("strlen", tier, ulib_strlen, buf, sizes[i]);
+			scan("strcmp", tier, ulib_strcmp, buf, sizes[i]);
+			scan("memchr", tier, ulib_memchr, buf, sizes[i]);
+			scan("memcmp", tier, ulib_memcmp, buf, sizes[i]);
+		}
+	}
+	ULIB_FREE(buf);
+	return 0;
+}
@@ -0,0 +1,79 @@
+/*
+	Cost of deque.h used as a FIFO queue, against vector.h used the
+	same way with v->push and v->delete(v, 0). Both queues are filled
+	to 'n' members beforehand; each operation then enqueues one member
+	and dequeues one, so the length stays at 'n'.
+*/
+
+#include "bench.h"
+
+#define VECTOR_IMPLEMENTATION
+#include "../vector.h"
+#define DEQUE_IMPLEMENTATION
+#include "../deque.h"
+
+struct queue_case {
+	vector* v;
+	deque* q;
+};
+
+static void vector_queue(void* ctx, unsigned long ops){
+	vector* v = ((struct queue_case*)ctx)->v;
+	unsigned long i, sum = 0;
+	int x = 1;
+	for(i=0; i!=ops; ++i){
+		v->push(v, &x);
+		sum += *(int*)v->at(v, 0);
+		v->delete(v, 0);
+	}
+	bench_sink += sum;
+}
+
+static void deque_queue(void* ctx, unsigned long ops){
+	deque* q = ((struct queue_case*)ctx)->q;
+	unsigned long i, sum = 0;
+	int x = 1;
+	for(i=0; i!=ops; ++i){
+		q->push_back(q, &x);
+		q->pop_front(q, &x);
+		sum += x;
+	}
+	bench_sink += sum;
+}
+
+/* The same, in blocks of 64 members */
+static void deque_queue_array(void* ctx, unsigned long ops){
+	deque* q = ((struct queue_case*)ctx)->q;
+	static int block[64];
+	unsigned long i;
+	for(i=0; i+64<=ops; i+=64){
+		q->push_back_array(q, block, 64);
+		q->pop_front_array(q, block, 64);
+	}
+	bench_sink += block[0];
+}
+
+int main(){
+	unsigned int sizes[] = {16, 1024, 65536};
+	unsigned int i, k;
+	char param[32];
+	struct queue_case c;
+	int x = 1;
+
+	bench_header();
+	for(i=0; i!=sizeof(sizes)/sizeof(sizes[0]); ++i){
+		sprintf(param, "%u", sizes[i]);
+		c.v = vector_new(sizeof(int));
+		c.q = deque_new(sizeof(int));
+		for(k=0; k!=sizes[i]; ++k){
+			c.v->push(c.v, &x);
+			c.q->push_back(c.q, &x);
+		}
+		bench_report("deque", "vector_queue", param, bench_run(vector_queue, &c, 4096), sizeof(int));
+		bench_report("deque", "deque_queue", param, bench_run(deque_queue, &c, 4096), sizeof(int));
+		bench_report("deque", "deque_queue_array", param, bench_run(deque_queue_array, &c, 4096), sizeof(int));
+		c.v->free(c.v);
+		c.q->free(c.q);
+	}
+	return 0;
+}
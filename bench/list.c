@@ -0,0 +1,94 @@
+/*
+	Cost per element of list.h appends, lookups and removals.
+	Each repetition builds a list of 'n' ints from empty (or empties
+	a full one), so the param column is the final length.
+*/
+
+#include "bench.h"
+
+#define LIST_IMPLEMENTATION
+#include "../list.h"
+
+struct list_case {
+	unsigned int n;
+	list* l;
+};
+
+static void append(void* ctx, unsigned long ops){
+	list* l = list_new();
+	unsigned long i;
+	int x = 1;
+	(void)ctx;
+	for(i=0; i!=ops; ++i) l->append(l, TYPE_INT, &x);
+	bench_sink += (unsigned long)l->head;
+	l->free(l);
+}
+
+static void insert_front(void* ctx, unsigned long ops){
+	list* l = list_new();
+	unsigned long i;
+	int x = 1;
+	(void)ctx;
+	for(i=0; i!=ops; ++i) l->insert(l, 0, TYPE_INT, &x);
+	bench_sink += (unsigned long)l->head;
+	l->free(l);
+}
+
+/* Fills the list front first, then removes from the front or back */
+static void remove_front(void* ctx, unsigned long ops){
+	list* l = list_new();
+	unsigned long i;
+	int x = 1;
+	(void)ctx;
+	for(i=0; i!=ops; ++i) l->insert(l, 0, TYPE_INT, &x);
+	for(i=0; i!=ops; ++i) l->remove(l, 0);
+	bench_sink += (unsigned long)l->head;
+	l->free(l);
+}
+
+static void pop(void* ctx, unsigned long ops){
+	list* l = list_new();
+	unsigned long i;
+	int x = 1;
+	(void)ctx;
+	for(i=0; i!=ops; ++i) l->insert(l, 0, TYPE_INT, &x);
+	for(i=0; i!=ops; ++i) l->pop(l);
+	bench_sink += (unsigned long)l->head;
+	l->free(l);
+}
+
+/* Strided lookups over a prebuilt list */
+static void at(void* ctx, unsigned long ops){
+	struct list_case* c = ctx;
+	unsigned long i, j = 0, sum = 0;
+	for(i=0; i!=ops; ++i){
+		sum += *(int*)c->l->at(c->l, j)->data;
+		j += 7;
+		if(j >= c->n) j -= c->n;
+	}
+	bench_sink += sum;
+}
+
+int main(){
+	unsigned int sizes[] = {64, 1024, 4096};
+	unsigned int i, k;
+	char param[32];
+	struct list_case c;
+	int x = 3;
+
+	bench_header();
+	for(i=0; i!=sizeof(sizes)/sizeof(sizes[0]); ++i){
+		sprintf(param, "%u", sizes[i]);
+		bench_report("list", "append", param, bench_run(append, NULL, sizes[i]), sizeof(int));
+		bench_report("list", "insert_front", param, bench_run(insert_front, NULL, sizes[i]), sizeof(int));
+		bench_report("list", "insert+remove_front", param, bench_run(remove_front, NULL, sizes[i]), sizeof(int));
+		bench_report("list", "insert+pop", param, bench_run(pop, NULL, sizes[i]), sizeof(int));
+
+		c.n = sizes[i];
+		c.l = list_new();
+		for(k=0; k!=sizes[i]; ++k) c.l->insert(c.l, 0, TYPE_INT, &x);
+		bench_report("list", "at", param, bench_run(at, &c, 100000), sizeof(int));
+		c.l->free(c.l);
+	}
+	return 0;
+}
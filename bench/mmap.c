@@ -0,0 +1,76 @@
+/*
+	Cost of getting a saved vector of doubles back and summing it:
+	reopening the file with vector_mmap_open(), against reading the
+	same file with fread() into a heap vector. Each operation opens,
+	sums and frees the whole vector of 'n' members. The file sits in
+	the page cache, so this measures the copy fread() has to make.
+*/
+
+#define _GNU_SOURCE
+#define ULIB_MMAP
+#include "bench.h"
+
+#define VECTOR_IMPLEMENTATION
+#include "../vector.h"
+
+#define PATH "bin/bench_mmap.vec"
+
+static double sum_vector(vector* v){
+	double s = 0, *d = v->at(v, 0);
+	unsigned int i, n = v->length(v);
+	for(i=0; i!=n; ++i) s += d[i];
+	return s;
+}
+
+static void mmap_reopen_sum(void* ctx, unsigned long ops){
+	unsigned long i;
+	vector* v;
+	(void)ctx;
+	for(i=0; i!=ops; ++i){
+		v = vector_mmap_open(PATH, sizeof(double));
+		bench_sink += (unsigned long)sum_vector(v);
+		v->free(v);
+	}
+}
+
+static void fread_load_sum(void* ctx, unsigned long ops){
+	unsigned int n = *(unsigned int*)ctx;
+	unsigned long i;
+	vector* v;
+	FILE* f;
+	for(i=0; i!=ops; ++i){
+		f = fopen(PATH, "rb");
+		fseek(f, 64, SEEK_SET);
+		v = vector_new(sizeof(double));
+		v->resize(v, n);
+		if(fread(v->at(v, 0), sizeof(double), n, f) != n) exit(1);
+		fclose(f);
+		bench_sink += (unsigned long)sum_vector(v);
+		v->free(v);
+	}
+}
+
+int main(){
+	unsigned int sizes[] = {4096, 262144, 4194304};
+	unsigned int i, k;
+	char param[32];
+	vector* v;
+	double x;
+
+	bench_header();
+	for(i=0; i!=sizeof(sizes)/sizeof(sizes[0]); ++i){
+		sprintf(param, "%u", sizes[i]);
+		remove(PATH);
+		v = vector_mmap_open(PATH, sizeof(double));
+		if(!v) return 1;
+		for(k=0; k!=sizes[i]; ++k){
+			x = k;
+			v->push(v, &x);
+		}
+		v->free(v);
+		bench_report("mmap", "mmap_reopen_sum", param, bench_run(mmap_reopen_sum, &sizes[i], 1), sizes[i]*sizeof(double));
+		bench_report("mmap", "fread_load_sum", param, bench_run(fread_load_sum, &sizes[i], 1), sizes[i]*sizeof(double));
+	}
+	remove(PATH);
+	return 0;
+}
@@ -0,0 +1,131 @@
+/*
+	Insert/remove throughput of pool.h against plain malloc.
+	Each operation allocates or frees a list node plus a small payload,
+	the same traffic list.h generates (churn replaces one such pair).
+	The param column is "<source>/<payload bytes>".
+*/
+
+#include "bench.h"
+
+#define POOL_IMPLEMENTATION
+#include "../pool.h"
+
+#define LIST_IMPLEMENTATION
+#include "../list.h"
+
+#include <stdlib.h>
+
+#define N 4096
+
+static void* slots[N][2];
+
+struct pool_case {
+	pool* p; /* NULL for malloc */
+	unsigned int payload;
+	int lifo;
+};
+
+/* Allocates N node/payload pairs, then frees them oldest or newest first */
+static void batch(void* ctx, unsigned long ops){
+	struct pool_case* c = ctx;
+	unsigned long r, i, j;
+	for(r=0; r!=ops/(2*N); ++r){
+		for(i=0; i!=N; ++i){
+			if(c->p){
+				slots[i][0] = pool__alloc(c->p, sizeof(list_node));
+				slots[i][1] = pool__alloc(c->p, c->payload);
+			}
+			else{
+				slots[i][0] = malloc(sizeof(list_node));
+				slots[i][1] = malloc(c->payload);
+			}
+			*(unsigned long*)slots[i][1] = i;
+		}
+		for(i=0; i!=N; ++i){
+			j = c->lifo ? N-1-i : i;
+			bench_sink += *(unsigned long*)slots[j][1];
+			if(c->p){
+				pool__release(c->p, slots[j][1], c->payload);
+				pool__release(c->p, slots[j][0], sizeof(list_node));
+			}
+			else{
+				free(slots[j][1]);
+				free(slots[j][0]);
+			}
+		}
+	}
+}
+
+/* Keeps N pairs alive and replaces a pseudo-random one each step */
+static void churn(void* ctx, unsigned long ops){
+	struct pool_case* c = ctx;
+	unsigned long r, i, x = 12345;
+	for(i=0; i!=N; ++i){
+		slots[i][0] = c->p ? pool__alloc(c->p, sizeof(list_node)) : malloc(sizeof(list_node));
+		slots[i][1] = c->p ? pool__alloc(c->p, c->payload) : malloc(c->payload);
+	}
+	for(r=0; r!=ops; ++r){
+		x = x*6364136223846793005ul + 1442695040888963407ul;
+		i = (x >> 33) % N;
+		if(c->p){
+			pool__release(c->p, slots[i][1], c->payload);
+			pool__release(c->p, slots[i][0], sizeof(list_node));
+			slots[i][0] = pool__alloc(c->p, sizeof(list_node));
+			slots[i][1] = pool__alloc(c->p, c->payload);
+		}
+		else{
+			free(slots[i][1]);
+			free(slots[i][0]);
+			slots[i][0] = malloc(sizeof(list_node));
+			slots[i][1] = malloc(c->payload);
+		}
+		bench_sink += (unsigned long)slots[i][1];
+	}
+	for(i=0; i!=N; ++i){
+		if(c->p){
+			pool__release(c->p, slots[i][1], c->payload);
+			pool__release(c->p, slots[i][0], sizeof(list_node));
+		}
+		else{
+			free(slots[i][1]);
+			free(slots[i][0]);
+		}
+	}
+}
+
+/* list->insert and list->remove at the head, which is O(1) */
+static void list_ops(void* ctx, unsigned long ops){
+	list* l = list_new();
+	unsigned long i;
+	int x = 7;
+	(void)ctx;
+	for(i=0; i!=ops/2; ++i) l->insert(l, 0, TYPE_INT, &x);
+	for(i=0; i!=ops/2; ++i) l->remove(l, 0);
+	l->free(l);
+}
+
+int main(){
+	unsigned int payloads[] = {sizeof(int), sizeof(double), 50, 200};
+	const char* source[] = {"malloc", "pool"};
+	unsigned int i, k;
+	struct pool_case c;
+	char param[32];
+	pool* p = pool_new();
+
+	bench_header();
+	for(i=0; i!=sizeof(payloads)/sizeof(payloads[0]); ++i){
+		c.payload = payloads[i];
+		for(k=0; k!=2; ++k){
+			c.p = k ? p : NULL;
+			sprintf(param, "%s/%u", source[k], payloads[i]);
+			c.lifo = 0;
+			bench_report("pool", "fifo", param, bench_run(batch, &c, 2*N*64), payloads[i]);
+			c.lifo = 1;
+			bench_report("pool", "lifo", param, bench_run(batch, &c, 2*N*64), payloads[i]);
+			bench_report("pool", "churn", param, bench_run(churn, &c, N*64), payloads[i]);
+		}
+	}
+	bench_report("pool", "list_insert+remove", "pool/4", bench_run(list_ops, NULL, 2*N), sizeof(int));
+	p->free(p);
+	return 0;
+}
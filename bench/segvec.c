@@ -0,0 +1,94 @@
+/*
+	Cost per element of segvec.h against vector.h.
+	Each push repetition builds a container of 'n' ints from empty;
+	the read cases sum a prebuilt one member by member or span by span.
+*/
+
+#include "bench.h"
+
+#define VECTOR_IMPLEMENTATION
+#include "../vector.h"
+#define SEGVEC_IMPLEMENTATION
+#include "../segvec.h"
+
+struct seg_case {
+	unsigned int n;
+	vector* v;
+	segvec* s;
+};
+
+static void vector_push(void* ctx, unsigned long ops){
+	vector* v = vector_new(sizeof(int));
+	unsigned long i;
+	int x = 1;
+	(void)ctx;
+	for(i=0; i!=ops; ++i) v->push(v, &x);
+	bench_sink += v->length(v);
+	v->free(v);
+}
+
+static void segvec_push(void* ctx, unsigned long ops){
+	segvec* s = segvec_new(sizeof(int));
+	unsigned long i;
+	int x = 1;
+	(void)ctx;
+	for(i=0; i!=ops; ++i) s->push(s, &x);
+	bench_sink += s->length(s);
+	s->free(s);
+}
+
+static void vector_at(void* ctx, unsigned long ops){
+	struct seg_case* c = ctx;
+	unsigned long i, sum = 0;
+	for(i=0; i!=ops; ++i) sum += *(int*)c->v->at(c->v, (unsigned int)i);
+	bench_sink += sum;
+}
+
+static void segvec_at(void* ctx, unsigned long ops){
+	struct seg_case* c = ctx;
+	unsigned long i, sum = 0;
+	for(i=0; i!=ops; ++i) sum += *(int*)c->s->at(c->s, (unsigned int)i);
+	bench_sink += sum;
+}
+
+static void segvec_span(void* ctx, unsigned long ops){
+	struct seg_case* c = ctx;
+	unsigned long sum = 0;
+	unsigned int i, k, n;
+	int* p;
+	(void)ops;
+	for(i=0; (p = c->s->span(c->s, i, &n)); i += n){
+		for(k=0; k!=n; ++k) sum += p[k];
+	}
+	bench_sink += sum;
+}
+
+int main(){
+	unsigned int sizes[] = {1024, 65536, 1u << 20};
+	unsigned int i, k;
+	char param[32];
+	struct seg_case c;
+	int x;
+
+	bench_header();
+	for(i=0; i!=sizeof(sizes)/sizeof(sizes[0]); ++i){
+		sprintf(param, "%u", sizes[i]);
+		bench_report("segvec", "vector_push", param, bench_run(vector_push, NULL, sizes[i]), sizeof(int));
+		bench_report("segvec", "segvec_push", param, bench_run(segvec_push, NULL, sizes[i]), sizeof(int));
+
+		c.n = sizes[i];
+		c.v = vector_new(sizeof(int));
+		c.s = segvec_new(sizeof(int));
+		for(k=0; k!=c.n; ++k){
+			x = (int)k;
+			c.v->push(c.v, &x);
+			c.s->push(c.s, &x);
+		}
+		bench_report("segvec", "vector_at", param, bench_run(vector_at, &c, c.n), sizeof(int));
+		bench_report("segvec", "segvec_at", param, bench_run(segvec_at, &c, c.n), sizeof(int));
+		bench_report("segvec", "segvec_span", param, bench_run(segvec_span, &c, c.n), sizeof(int));
+		c.v->free(c.v);
+		c.s->free(c.s);
+	}
+	return 0;
+}
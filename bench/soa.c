@@ -0,0 +1,98 @@
+/*
+	Records of {timestamp, id, value} kept as a vector of structs,
+	against the same records in soa.h columns. The scans sum the value
+	field of every record: a strided loop over the structs, against
+	the array.h kernel over the value column. The pushes append one
+	record per operation to an empty container.
+*/
+
+#include "bench.h"
+
+#define VECTOR_IMPLEMENTATION
+#include "../vector.h"
+#define ARRAY_IMPLEMENTATION
+#include "../array.h"
+#define SOA_IMPLEMENTATION
+#include "../soa.h"
+
+struct record {
+	double ts;
+	int id;
+	double value;
+};
+
+struct records_case {
+	vector* v;
+	soa* s;
+};
+
+static const soa_field schema[] = {{TYPE_DOUBLE, 0}, {TYPE_INT, 0}, {TYPE_DOUBLE, 0}};
+
+static void aos_scan_value(void* ctx, unsigned long ops){
+	vector* v = ((struct records_case*)ctx)->v;
+	const struct record* r = v->at(v, 0);
+	unsigned long i;
+	double sum = 0;
+	for(i=0; i!=ops; ++i) sum += r[i].value;
+	bench_sink += (unsigned long)sum;
+}
+
+static void soa_scan_value(void* ctx, unsigned long ops){
+	soa* s = ((struct records_case*)ctx)->s;
+	bench_sink += (unsigned long)array__kernels()->sum_db(s->column(s, 2), (unsigned int)ops);
+}
+
+static void aos_push(void* ctx, unsigned long ops){
+	vector* v = vector_new(sizeof(struct record));
+	struct record r = {0, 0, 0};
+	unsigned long i;
+	(void)ctx;
+	for(i=0; i!=ops; ++i){
+		r.id = (int)i;
+		v->push(v, &r);
+	}
+	bench_sink += v->length(v);
+	v->free(v);
+}
+
+static void soa_push(void* ctx, unsigned long ops){
+	soa* s = soa_new(schema, 3);
+	struct record r = {0, 0, 0};
+	unsigned long i;
+	(void)ctx;
+	for(i=0; i!=ops; ++i){
+		r.id = (int)i;
+		s->push(s, &r.ts, &r.id, &r.value);
+	}
+	bench_sink += s->length(s);
+	s->free(s);
+}
+
+int main(){
+	unsigned int sizes[] = {1024, 1048576};
+	unsigned int i, k;
+	char param[32];
+	struct records_case c;
+	struct record r;
+
+	bench_header();
+	for(i=0; i!=sizeof(sizes)/sizeof(sizes[0]); ++i){
+		sprintf(param, "%u", sizes[i]);
+		c.v = vector_new(sizeof(struct record));
+		c.s = soa_new(schema, 3);
+		for(k=0; k!=sizes[i]; ++k){
+			r.ts = k;
+			r.id = (int)k;
+			r.value = k*0.5;
+			c.v->push(c.v, &r);
+			c.s->push(c.s, &r.ts, &r.id, &r.value);
+		}
+		bench_report("soa", "aos_scan_value", param, bench_run(aos_scan_value, &c, sizes[i]), sizeof(double));
+		bench_report("soa", "soa_scan_value", param, bench_run(soa_scan_value, &c, sizes[i]), sizeof(double));
+		bench_report("soa", "aos_push", param, bench_run(aos_push, &c, sizes[i]), sizeof(struct record));
+		bench_report("soa", "soa_push", param, bench_run(soa_push, &c, sizes[i]), sizeof(struct record));
+		c.v->free(c.v);
+		c.s->free(c.s);
+	}
+	return 0;
+}
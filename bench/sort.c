@@ -0,0 +1,217 @@
+/*
+	Cost per element of sort.h against the C library qsort.
+	Each repetition copies the unsorted input back and sorts it,
+	so the times include one copy of the data.
+	The parallel cases sort 2M members on 1 to 16 threads; the speedup
+	over 1 thread is bounded by the number of cores of the machine.
+	The search cases look up random keys in sorted ints, per lookup.
+*/
+
+#include "bench.h"
+
+#define SORT_IMPLEMENTATION
+#include "../sort.h"
+
+#include <stdlib.h>
+
+struct sort_case {
+	void* src;
+	void* work;
+	unsigned int n, size, threads;
+};
+
+static void reload(struct sort_case* c){
+	ULIB_MEMCPY(c->work, c->src, c->n*c->size);
+}
+
+static void run_qsort_int(void* ctx, unsigned long ops){
+	struct sort_case* c = ctx;
+	(void)ops;
+	reload(c);
+	qsort(c->work, c->n, sizeof(int), sort_cmp_int);
+	bench_sink += ((int*)c->work)[0];
+}
+
+static void run_pdq_int(void* ctx, unsigned long ops){
+	struct sort_case* c = ctx;
+	(void)ops;
+	reload(c);
+	sort_pdq(c->work, c->n, sizeof(int), sort_cmp_int);
+	bench_sink += ((int*)c->work)[0];
+}
+
+static void run_radix_int(void* ctx, unsigned long ops){
+	struct sort_case* c = ctx;
+	(void)ops;
+	reload(c);
+	sort_radix_int(c->work, c->n, NULL);
+	bench_sink += ((int*)c->work)[0];
+}
+
+static void run_qsort_db(void* ctx, unsigned long ops){
+	struct sort_case* c = ctx;
+	(void)ops;
+	reload(c);
+	qsort(c->work, c->n, sizeof(double), sort_cmp_db);
+	bench_sink += (unsigned long)((double*)c->work)[0];
+}
+
+static void run_pdq_db(void* ctx, unsigned long ops){
+	struct sort_case* c = ctx;
+	(void)ops;
+	reload(c);
+	sort_pdq(c->work, c->n, sizeof(double), sort_cmp_db);
+	bench_sink += (unsigned long)((double*)c->work)[0];
+}
+
+static void run_radix_db(void* ctx, unsigned long ops){
+	struct sort_case* c = ctx;
+	(void)ops;
+	reload(c);
+	sort_radix_db(c->work, c->n, NULL);
+	bench_sink += (unsigned long)((double*)c->work)[0];
+}
+
+static void run_parallel_pdq_int(void* ctx, unsigned long ops){
+	struct sort_case* c = ctx;
+	(void)ops;
+	reload(c);
+	sort_parallel(c->work, c->n, sizeof(int), sort_cmp_int, c->threads, NULL);
+	bench_sink += ((int*)c->work)[0];
+}
+
+static void run_parallel_int(void* ctx, unsigned long ops){
+	struct sort_case* c = ctx;
+	(void)ops;
+	reload(c);
+	sort_parallel_int(c->work, c->n, c->threads, NULL);
+	bench_sink += ((int*)c->work)[0];
+}
+
+static void run_parallel_db(void* ctx, unsigned long ops){
+	struct sort_case* c = ctx;
+	(void)ops;
+	reload(c);
+	sort_parallel_db(c->work, c->n, c->threads, NULL);
+	bench_sink += (unsigned long)((double*)c->work)[0];
+}
+
+/* Sorted members, their Eytzinger layout, and the keys to look up */
+struct search_case {
+	int* sorted;
+	int* eyt;
+	int* keys;
+	unsigned int n, nkeys;
+};
+
+static void run_lower_bound(void* ctx, unsigned long ops){
+	struct search_case* c = ctx;
+	unsigned long i, sum = 0;
+	for(i=0; i!=ops; ++i) sum += sort_lower_bound(c->sorted, c->n, sizeof(int), &c->keys[i % c->nkeys], sort_cmp_int);
+	bench_sink += sum;
+}
+
+static void run_lower_bound_int(void* ctx, unsigned long ops){
+	struct search_case* c = ctx;
+	unsigned long i, sum = 0;
+	for(i=0; i!=ops; ++i) sum += sort_lower_bound_int(c->sorted, c->n, c->keys[i % c->nkeys]);
+	bench_sink += sum;
+}
+
+static void run_eytzinger_int(void* ctx, unsigned long ops){
+	struct search_case* c = ctx;
+	unsigned long i, sum = 0;
+	for(i=0; i!=ops; ++i) sum += sort_eytzinger_lower_bound_int(c->eyt, c->n, c->keys[i % c->nkeys]);
+	bench_sink += sum;
+}
+
+/* Fills 'n' ints: 0 random, 1 sorted, 2 reversed, 3 four distinct keys */
+static void fill_int(int* a, unsigned int n, unsigned int pattern){
+	unsigned int i;
+	for(i=0; i!=n; ++i){
+		switch(pattern){
+			case 0: a[i] = rand() - RAND_MAX/2; break;
+			case 1: a[i] = (int)i; break;
+			case 2: a[i] = (int)(n - i); break;
+			default: a[i] = rand() % 4; break;
+		}
+	}
+}
+
+int main(){
+	unsigned int sizes[] = {1024, 65536};
+	unsigned int threads[] = {1, 2, 4, 8, 16};
+	unsigned int search_sizes[] = {1u << 10, 1u << 16, 1u << 20, 1u << 24};
+	struct search_case sc;
+	const char* patterns[] = {"random", "sorted", "reversed", "few"};
+	unsigned int i, k, p;
+	char param[48];
+	struct sort_case c;
+
+	bench_header();
+	for(i=0; i!=sizeof(sizes)/sizeof(sizes[0]); ++i){
+		c.n = sizes[i];
+		c.src = malloc(c.n*sizeof(double));
+		c.work = malloc(c.n*sizeof(double));
+
+		c.size = sizeof(int);
+		for(p=0; p!=4; ++p){
+			srand(1);
+			fill_int(c.src, c.n, p);
+			sprintf(param, "%u/%s", sizes[i], patterns[p]);
+			bench_report("sort", "qsort_int", param, bench_run(run_qsort_int, &c, c.n), sizeof(int));
+			bench_report("sort", "pdq_int", param, bench_run(run_pdq_int, &c, c.n), sizeof(int));
+			bench_report("sort", "radix_int", param, bench_run(run_radix_int, &c, c.n), sizeof(int));
+		}
+
+		c.size = sizeof(double);
+		srand(1);
+		for(k=0; k!=c.n; ++k) ((double*)c.src)[k] = (double)rand()/RAND_MAX - 0.5;
+		sprintf(param, "%u/random", sizes[i]);
+		bench_report("sort", "qsort_db", param, bench_run(run_qsort_db, &c, c.n), sizeof(double));
+		bench_report("sort", "pdq_db", param, bench_run(run_pdq_db, &c, c.n), sizeof(double));
+		bench_report("sort", "radix_db", param, bench_run(run_radix_db, &c, c.n), sizeof(double));
+
+		free(c.src);
+		free(c.work);
+	}
+
+	c.n = 1u << 21;
+	c.src = malloc(c.n*sizeof(double));
+	c.work = malloc(c.n*sizeof(double));
+	for(i=0; i!=sizeof(threads)/sizeof(threads[0]); ++i){
+		c.threads = threads[i];
+		sprintf(param, "%u/%ut", c.n, c.threads);
+		c.size = sizeof(int);
+		srand(1);
+		fill_int(c.src, c.n, 0);
+		bench_report("sort", "parallel_pdq_int", param, bench_run(run_parallel_pdq_int, &c, c.n), sizeof(int));
+		bench_report("sort", "parallel_int", param, bench_run(run_parallel_int, &c, c.n), sizeof(int));
+		c.size = sizeof(double);
+		srand(1);
+		for(k=0; k!=c.n; ++k) ((double*)c.src)[k] = (double)rand()/RAND_MAX - 0.5;
+		bench_report("sort", "parallel_db", param, bench_run(run_parallel_db, &c, c.n), sizeof(double));
+	}
+	free(c.src);
+	free(c.work);
+
+	sc.nkeys = 1u << 16;
+	sc.keys = malloc(sc.nkeys*sizeof(int));
+	for(i=0; i!=sizeof(search_sizes)/sizeof(search_sizes[0]); ++i){
+		sc.n = search_sizes[i];
+		sc.sorted = malloc(sc.n*sizeof(int));
+		sc.eyt = malloc(sc.n*sizeof(int));
+		for(k=0; k!=sc.n; ++k) sc.sorted[k] = (int)(2*k);
+		sort_eytzinger(sc.sorted, sc.eyt, sc.n, sizeof(int));
+		srand(1);
+		for(k=0; k!=sc.nkeys; ++k) sc.keys[k] = (int)(((unsigned int)rand() * 2654435761u) % (2*sc.n));
+		sprintf(param, "%u", sc.n);
+		bench_report("search", "lower_bound", param, bench_run(run_lower_bound, &sc, sc.nkeys), sizeof(int));
+		bench_report("search", "lower_bound_int", param, bench_run(run_lower_bound_int, &sc, sc.nkeys), sizeof(int));
+		bench_report("search", "eytzinger_int", param, bench_run(run_eytzinger_int, &sc, sc.nkeys), sizeof(int));
+		free(sc.sorted);
+		free(sc.eyt);
+	}
+	free(sc.keys);
+	return 0;
+}
@@ -0,0 +1,84 @@
+/*
+	Cost of string.h construction and editing.
+	Appends and inserts grow one string to 'n' pieces per repetition,
+	so the param column is the number of pieces.
+*/
+
+#include "bench.h"
+
+#define STRING_IMPLEMENTATION
+#include "../string.h"
+
+static void new_literal(void* ctx, unsigned long ops){
+	unsigned long i;
+	string* s;
+	(void)ctx;
+	for(i=0; i!=ops; ++i){
+		s = string_new("Hello world");
+		bench_sink += s->len;
+		s->free(s);
+	}
+}
+
+static void new_format(void* ctx, unsigned long ops){
+	unsigned long i;
+	string* s;
+	(void)ctx;
+	for(i=0; i!=ops; ++i){
+		s = string_new("%s %lu and %g", "item", i, 0.5);
+		bench_sink += s->len;
+		s->free(s);
+	}
+}
+
+static void append(void* ctx, unsigned long ops){
+	string* s = string_new("");
+	unsigned long i;
+	(void)ctx;
+	for(i=0; i!=ops; ++i) s->append(s, "piece");
+	bench_sink += s->len;
+	s->free(s);
+}
+
+static void insert_middle(void* ctx, unsigned long ops){
+	string* s = string_new("");
+	unsigned long i;
+	(void)ctx;
+	for(i=0; i!=ops; ++i) s->insert(s, "piece", s->len/2);
+	bench_sink += s->len;
+	s->free(s);
+}
+
+static void copy(void* ctx, unsigned long ops){
+	string* s = ctx;
+	string* r;
+	unsigned long i;
+	for(i=0; i!=ops; ++i){
+		r = s->copy(s);
+		bench_sink += r->len;
+		r->free(r);
+	}
+}
+
+int main(){
+	unsigned int sizes[] = {16, 256, 4096};
+	unsigned int i, k;
+	char param[32];
+	string* s;
+
+	bench_header();
+	bench_report("string", "new", "literal", bench_run(new_literal, NULL, 10000), 11);
+	bench_report("string", "new", "format", bench_run(new_format, NULL, 10000), 0);
+	for(i=0; i!=sizeof(sizes)/sizeof(sizes[0]); ++i){
+		sprintf(param, "%u", sizes[i]);
+		bench_report("string", "append", param, bench_run(append, NULL, sizes[i]), 5);
+		bench_report("string", "insert_middle", param, bench_run(insert_middle, NULL, sizes[i]), 5);
+
+		s = string_new("");
+		for(k=0; k!=sizes[i]; ++k) s->append(s, "piece");
+		sprintf(param, "%lu", s->len);
+		bench_report("string", "copy", param, bench_run(copy, s, 10000), s->len);
+		s->free(s);
+	}
+	return 0;
+}
@@ -0,0 +1,270 @@
+/*
+	Cost per element of vector.h insertions, deletions and lookups.
+	Each repetition builds a vector of 'n' ints from empty (or empties
+	a full one), so the param column is the final length.
+*/
+
+#include "bench.h"
+
+#define VECTOR_IMPLEMENTATION
+#include "../vector.h"
+
+#include <stdlib.h>
+
+VECTOR_DECLARE_LESS(vec_int, int, VECTOR_LESS)
+
+struct vec_case {
+	unsigned int n;
+	vector* v;
+};
+
+static void insert_back(void* ctx, unsigned long ops){
+	vector* v = vector_new(sizeof(int));
+	unsigned long i;
+	int x = 1;
+	(void)ctx;
+	for(i=0; i!=ops; ++i) v->insert(v, v->length(v), &x);
+	bench_sink += v->length(v);
+	v->free(v);
+}
+
+static void insert_front(void* ctx, unsigned long ops){
+	vector* v = vector_new(sizeof(int));
+	unsigned long i;
+	int x = 1;
+	(void)ctx;
+	for(i=0; i!=ops; ++i) v->insert(v, 0, &x);
+	bench_sink += v->length(v);
+	v->free(v);
+}
+
+static void push(void* ctx, unsigned long ops){
+	vector* v = vector_new(sizeof(int));
+	unsigned long i;
+	int x = 1;
+	(void)ctx;
+	for(i=0; i!=ops; ++i) v->push(v, &x);
+	bench_sink += v->length(v);
+	v->free(v);
+}
+
+static void emplace(void* ctx, unsigned long ops){
+	vector* v = vector_new(sizeof(int));
+	unsigned long i;
+	(void)ctx;
+	for(i=0; i!=ops; ++i) *(int*)v->emplace(v) = (int)i;
+	bench_sink += v->length(v);
+	v->free(v);
+}
+
+static void pop(void* ctx, unsigned long ops){
+	vector* v = vector_new(sizeof(int));
+	unsigned long i;
+	int x;
+	(void)ctx;
+	v->resize(v, ops);
+	for(i=0; i!=ops; ++i) v->pop(v, &x);
+	bench_sink += v->length(v);
+	v->free(v);
+}
+
+/* Builds and frees 'ops' vectors of SMALL_LEN ints each */
+#define SMALL_LEN 6
+
+static void small_heap(void* ctx, unsigned long ops){
+	unsigned long i;
+	int k;
+	(void)ctx;
+	for(i=0; i!=ops; ++i){
+		vector* v = vector_new(sizeof(int));
+		for(k=0; k!=SMALL_LEN; ++k) v->push(v, &k);
+		bench_sink += *(int*)v->back(v);
+		v->free(v);
+	}
+}
+
+static void small_inline(void* ctx, unsigned long ops){
+	unsigned long i;
+	int k;
+	(void)ctx;
+	for(i=0; i!=ops; ++i){
+		vector* v = vector_new_inline(sizeof(int), 8*sizeof(int));
+		for(k=0; k!=SMALL_LEN; ++k) v->push(v, &k);
+		bench_sink += *(int*)v->back(v);
+		v->free(v);
+	}
+}
+
+/* Appends in blocks of 64 members */
+static void append_array(void* ctx, unsigned long ops){
+	vector* v = vector_new(sizeof(int));
+	static int block[64];
+	unsigned long i;
+	(void)ctx;
+	for(i=0; i+64<=ops; i+=64) v->append_array(v, block, 64);
+	v->append_array(v, block, ops-i);
+	bench_sink += v->length(v);
+	v->free(v);
+}
+
+static void insert_middle(void* ctx, unsigned long ops){
+	vector* v = vector_new(sizeof(int));
+	unsigned long i;
+	int x = 1;
+	(void)ctx;
+	for(i=0; i!=ops; ++i) v->insert(v, v->length(v)/2, &x);
+	bench_sink += v->length(v);
+	v->free(v);
+}
+
+static void delete_back(void* ctx, unsigned long ops){
+	vector* v = vector_new(sizeof(int));
+	unsigned long i;
+	(void)ctx;
+	v->resize(v, ops);
+	for(i=0; i!=ops; ++i) v->delete(v, v->length(v)-1);
+	bench_sink += v->length(v);
+	v->free(v);
+}
+
+static void delete_front(void* ctx, unsigned long ops){
+	vector* v = vector_new(sizeof(int));
+	unsigned long i;
+	(void)ctx;
+	v->resize(v, ops);
+	for(i=0; i!=ops; ++i) v->delete(v, 0);
+	bench_sink += v->length(v);
+	v->free(v);
+}
+
+/* Strided reads over a prebuilt vector */
+static void at(void* ctx, unsigned long ops){
+	struct vec_case* c = ctx;
+	unsigned long i, j = 0, sum = 0;
+	for(i=0; i!=ops; ++i){
+		sum += *(int*)c->v->at(c->v, j);
+		j += 7;
+		if(j >= c->n) j -= c->n;
+	}
+	bench_sink += sum;
+}
+
+static void typed_push(void* ctx, unsigned long ops){
+	vec_int v;
+	unsigned long i;
+	(void)ctx;
+	vec_int_init(&v);
+	for(i=0; i!=ops; ++i) vec_int_push(&v, (int)i);
+	bench_sink += v.len;
+	vec_int_free(&v);
+}
+
+/* Sums a prebuilt vector through v->at(), or directly for the typed one */
+static void sum_at(void* ctx, unsigned long ops){
+	struct vec_case* c = ctx;
+	unsigned long r, i, sum = 0;
+	for(r=0; r!=ops/c->n; ++r){
+		for(i=0; i!=c->n; ++i) sum += *(int*)c->v->at(c->v, i);
+	}
+	bench_sink += sum;
+}
+
+static void typed_sum(void* ctx, unsigned long ops){
+	vec_int* v = ctx;
+	unsigned long r, i, sum = 0;
+	for(r=0; r!=ops/v->len; ++r){
+		for(i=0; i!=v->len; ++i) sum += *vec_int_at(v, i);
+	}
+	bench_sink += sum;
+}
+
+static int cmp_int(const int* a, const int* b){
+	return (*a > *b) - (*a < *b);
+}
+
+static int qsort_cmp(const void* a, const void* b){
+	return cmp_int(a, b);
+}
+
+/* Refills with a pseudo-random sequence of 'n' members */
+static void fill(vec_int* v, unsigned long n){
+	unsigned long i;
+	v->len = 0;
+	for(i=0; i!=n; ++i) vec_int_push(v, (int)((i*2654435761u) >> 4));
+}
+
+/* Each sort case refills the vector, then sorts 'ops' members */
+static void sort_qsort(void* ctx, unsigned long ops){
+	vec_int* v = ctx;
+	fill(v, ops);
+	qsort(v->d, v->len, sizeof(int), qsort_cmp);
+	bench_sink += v->d[0];
+}
+
+/* What v->sort runs */
+static void sort_pdq_case(void* ctx, unsigned long ops){
+	vec_int* v = ctx;
+	fill(v, ops);
+	sort_pdq(v->d, v->len, sizeof(int), qsort_cmp);
+	bench_sink += v->d[0];
+}
+
+static void sort_typed(void* ctx, unsigned long ops){
+	vec_int* v = ctx;
+	fill(v, ops);
+	vec_int_sort(v, cmp_int);
+	bench_sink += v->d[0];
+}
+
+static void sort_less(void* ctx, unsigned long ops){
+	vec_int* v = ctx;
+	fill(v, ops);
+	vec_int_sort_less(v);
+	bench_sink += v->d[0];
+}
+
+int main(){
+	unsigned int sizes[] = {64, 1024, 4096};
+	unsigned int i, k;
+	char param[32];
+	struct vec_case c;
+	vec_int t;
+	int x = 3;
+
+	bench_header();
+	for(i=0; i!=sizeof(sizes)/sizeof(sizes[0]); ++i){
+		sprintf(param, "%u", sizes[i]);
+		bench_report("vector", "insert_back", param, bench_run(insert_back, NULL, sizes[i]), sizeof(int));
+		bench_report("vector", "insert_front", param, bench_run(insert_front, NULL, sizes[i]), sizeof(int));
+		bench_report("vector", "insert_middle", param, bench_run(insert_middle, NULL, sizes[i]), sizeof(int));
+		bench_report("vector", "append_array", param, bench_run(append_array, NULL, sizes[i]), sizeof(int));
+		bench_report("vector", "push", param, bench_run(push, NULL, sizes[i]), sizeof(int));
+		bench_report("vector", "emplace", param, bench_run(emplace, NULL, sizes[i]), sizeof(int));
+		bench_report("vector", "pop", param, bench_run(pop, NULL, sizes[i]), sizeof(int));
+		bench_report("vector", "delete_back", param, bench_run(delete_back, NULL, sizes[i]), sizeof(int));
+		bench_report("vector", "delete_front", param, bench_run(delete_front, NULL, sizes[i]), sizeof(int));
+
+		c.n = sizes[i];
+		c.v = vector_new(sizeof(int));
+		for(k=0; k!=sizes[i]; ++k) c.v->insert(c.v, k, &x);
+		bench_report("vector", "at", param, bench_run(at, &c, 1000000), sizeof(int));
+		bench_report("vector", "sum_at", param, bench_run(sum_at, &c, 1000000), sizeof(int));
+		c.v->free(c.v);
+
+		vec_int_init(&t);
+		for(k=0; k!=sizes[i]; ++k) vec_int_push(&t, x);
+		bench_report("vector", "typed_push", param, bench_run(typed_push, NULL, sizes[i]), sizeof(int));
+		bench_report("vector", "typed_sum", param, bench_run(typed_sum, &t, 1000000), sizeof(int));
+		bench_report("vector", "sort_qsort", param, bench_run(sort_qsort, &t, sizes[i]), sizeof(int));
+		bench_report("vector", "sort_pdq", param, bench_run(sort_pdq_case, &t, sizes[i]), sizeof(int));
+		bench_report("vector", "typed_sort", param, bench_run(sort_typed, &t, sizes[i]), sizeof(int));
+		bench_report("vector", "typed_sort_less", param, bench_run(sort_less, &t, sizes[i]), sizeof(int));
+		vec_int_free(&t);
+	}
+
+	/* Whole short vectors: new, SMALL_LEN pushes, free */
+	sprintf(param, "%u", SMALL_LEN);
+	bench_report("vector", "small_heap", param, bench_run(small_heap, NULL, 10000), SMALL_LEN*sizeof(int));
+	bench_report("vector", "small_inline", param, bench_run(small_inline, NULL, 10000), SMALL_LEN*sizeof(int));
+	return 0;
+}
@@ -41,6 +41,10 @@
 	#define ULIB_MEMCPY ulib__memcpy
 #endif
 
+#ifndef ULIB_MEMMOVE
+	#define ULIB_MEMMOVE ulib__memmove
+#endif
+
 #ifndef ULIB_STRLEN
 	#define ULIB_STRLEN ulib__strlen
 #endif
@@ -57,6 +61,14 @@
 	#define ULIB_STRCAT ulib__strcat
 #endif
 
+#ifndef ULIB_MEMCHR
+	#define ULIB_MEMCHR ulib__memchr
+#endif
+
+#ifndef ULIB_MEMCMP
+	#define ULIB_MEMCMP ulib__memcmp
+#endif
+
 /* stdarg.h functions */
 #if !defined(ULIB_VA_LIST)  || \
 	!defined(ULIB_VA_START) || \
@@ -82,31 +94,1097 @@
 #define ULIB_ISINF(N)  (ULIB_ISPINF(N) || ULIB_ISNINF(N))
 
 
+#ifndef ULIB_GETENV
+	#include <stdlib.h>
+	#define ULIB_GETENV getenv
+#endif
+
+/* Functions generated by the *_DECLARE macros are static, and inline where supported */
+#ifndef ULIB_INLINE
+	#if defined(__GNUC__) || defined(__clang__)
+		#define ULIB_INLINE static __inline__
+	#elif defined(_MSC_VER)
+		#define ULIB_INLINE static __inline
+	#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+		#define ULIB_INLINE static inline
+	#else
+		#define ULIB_INLINE static
+	#endif
+#endif
+
+/*
+	Method tables.
+	By default every vector, array, list and string carries its own copy
+	of its function pointers. Defining ULIB_SHARED_VTABLE replaces them
+	with a single pointer 'vt' to a const table shared by all objects of
+	the same kind, which saves sizeof(table) - sizeof(pointer) bytes on
+	each one. Calling through ULIB_M works in both modes:
+		ULIB_M(v)->push(v, &x);
+*/
+#ifdef ULIB_SHARED_VTABLE
+	#define ULIB_M(obj) ((obj)->vt)
+#else
+	#define ULIB_M(obj) (obj)
+#endif
+
+/* 
+	Vector extensions.
+	On x86 with GCC or Clang, SSE2, AVX2 and AVX-512 kernels are always
+	compiled in, and the best tier the CPU supports is picked at first use.
+	Setting the environment variable ULIB_CPU to scalar, sse2, avx2 or
+	avx512 caps the tier, e.g. to benchmark each one.
+	Define ULIB_NO_SIMD to only build the portable word loops.
+*/
+#include <stddef.h>
+
+#if !defined(ULIB_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define ULIB_X86 1
+	#include <immintrin.h>
+	#include <cpuid.h>
+	#define ULIB__TARGET(isa) __attribute__((__target__(isa)))
+#endif
+
+enum ulib__cpu_tiers {
+	ULIB_CPU_SCALAR,
+	ULIB_CPU_SSE2,
+	ULIB_CPU_AVX2,
+	ULIB_CPU_AVX512 /* AVX-512 F + BW */
+};
+
+/* Targets where word loads/stores need not be aligned */
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) \
+	|| defined(_M_X64) || defined(__aarch64__)
+	#define ULIB_UNALIGNED_OK 1
+#endif
+
+/*
+Loads and stores of the dispatch state, which threads may race to
+set up. Without __GNUC__ they are plain, so call ulib_cpu_tier()
+before starting threads there.
+*/
+#ifdef __GNUC__
+	#define ULIB__LOAD(x)     __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+	#define ULIB__STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#else
+	#define ULIB__LOAD(x)     (x)
+	#define ULIB__STORE(x, v) ((x) = (v))
+#endif
+
+/* Hint that the cache line at 'p' will soon be read */
+#ifdef __GNUC__
+	#define ULIB_PREFETCH(p) __builtin_prefetch(p)
+#else
+	#define ULIB_PREFETCH(p) ((void)0)
+#endif
+
+/* Copies at least this large bypass the cache with streaming stores */
+#ifndef ULIB_MEMCPY_STREAM_BYTES
+	#define ULIB_MEMCPY_STREAM_BYTES (1u << 22)
+#endif
+
+/* Machine word used by the word-at-a-time loops, and its unaligned twin */
+#ifdef __GNUC__
+typedef unsigned long __attribute__((__may_alias__)) ulib__word;
+typedef unsigned long __attribute__((__may_alias__, __aligned__(1))) ulib__uword;
+#else
+typedef unsigned long ulib__word;
+typedef unsigned long ulib__uword;
+#endif
+
+#define ULIB__WSIZE (sizeof(ulib__word))
+#define ULIB__WMASK (ULIB__WSIZE - 1)
+#define ULIB__ADDR(p) ((size_t)(p))
+
+/* Words with every byte set to 0x01 and 0x80 */
+#define ULIB__ONES  ((ulib__word)-1 / 0xFF)
+#define ULIB__HIGHS (ULIB__ONES * 0x80)
+
+/* Non-zero when any byte of the word 'w' is zero */
+#define ULIB__HASZERO(w) (((w) - ULIB__ONES) & ~(w) & ULIB__HIGHS)
+
+/*
+	String scans read whole aligned words (or vectors) and may touch
+	bytes past the terminator, though never past the page holding it.
+	Memory checkers report that, so under them only byte loops are used.
+*/
+#ifndef ULIB_PAGE_BYTES
+	#define ULIB_PAGE_BYTES 4096
+#endif
+
+#if defined(__SANITIZE_ADDRESS__) || defined(ULIB_NO_OVERREAD)
+	#define ULIB__NO_OVERREAD 1
+#elif defined(__has_feature)
+	#if __has_feature(address_sanitizer)
+		#define ULIB__NO_OVERREAD 1
+	#endif
+#endif
+
+
+/*
+	Allocator objects.
+	Containers made with the *_new_alloc() constructors take all their
+	memory from the given allocator, which must outlive them. The plain
+	constructors use ulib_default_allocator, built on ULIB_MALLOC,
+	ULIB_REALLOC and ULIB_FREE.
+	'ctx' is handed back to every call. The sizes passed to realloc and
+	free are the ones the block was last allocated with; 'ptr' is never
+	NULL and sizes are never zero.
+*/
+typedef struct ulib__allocator_struct ulib_allocator;
+struct ulib__allocator_struct {
+	void* (*alloc)(void* ctx, unsigned int bytes);
+	void* (*realloc)(void* ctx, void* ptr, unsigned int old_bytes, unsigned int new_bytes);
+	void  (*free)(void* ctx, void* ptr, unsigned int bytes);
+	void* ctx;
+};
+
+extern const ulib_allocator ulib_default_allocator;
+
+/*
+	Allocation tracking.
+	Compile with ULIB_TRACK_ALLOC to count the heap traffic of every
+	container type. Only memory reaching ULIB_MALLOC, ULIB_REALLOC and
+	ULIB_FREE through the default allocator is counted; containers on
+	an arena or pool show up under the tag of that arena or pool.
+	Without the flag, the counters stay at zero.
+*/
+enum ulib__alloc_tags {
+	ULIB_TAG_OTHER,
+	ULIB_TAG_VECTOR,
+	ULIB_TAG_ARRAY,
+	ULIB_TAG_LIST,
+	ULIB_TAG_STRING,
+	ULIB_TAG_ARGLIB,
+	ULIB_TAG_ARENA,
+	ULIB_TAG_POOL,
+	ULIB_TAG_SEGVEC,
+	ULIB_TAG_DEQUE,
+	ULIB_TAG_APPENDVEC,
+	ULIB_TAG_SOA,
+	ULIB_TAG_COUNT
+};
+
+/* Sum of every tag */
+#define ULIB_TAG_ALL ULIB_TAG_COUNT
+
+enum ulib__dump_formats {ULIB_DUMP_TEXT, ULIB_DUMP_JSON};
+
+typedef struct ulib__alloc_stats_struct ulib_alloc_stats;
+struct ulib__alloc_stats_struct {
+	unsigned long allocs, reallocs, frees;
+	unsigned long live_bytes, peak_bytes;
+	unsigned long total_bytes;  /* requested by allocs and growing reallocs */
+	unsigned long copied_bytes; /* moved by reallocs that changed address */
+};
+
+
 /* Function Declarations */
+void* ulib__alloc(const ulib_allocator* a, unsigned int bytes, unsigned int tag);
+void* ulib__zalloc(const ulib_allocator* a, unsigned int bytes, unsigned int tag);
+void* ulib__realloc(const ulib_allocator* a, void* ptr, unsigned int old_bytes, unsigned int new_bytes, unsigned int tag);
+void ulib__dealloc(const ulib_allocator* a, void* ptr, unsigned int bytes, unsigned int tag);
+
+const ulib_alloc_stats* ulib_alloc_query(unsigned int tag);
+const char* ulib_alloc_tag_name(unsigned int tag);
+void ulib_alloc_reset();
+void ulib_alloc_dump(void* stream, unsigned int format);
+
+unsigned int ulib_cpu_detect();
+unsigned int ulib_cpu_tier();
+unsigned int ulib_cpu_set_tier(unsigned int tier);
+const char* ulib_cpu_name(unsigned int tier);
+
 void* ulib__memcpy(void*, const void*, unsigned int);
+void* ulib__memmove(void*, const void*, unsigned int);
 unsigned int ulib__strlen(const char*);
 char* ulib__strcpy(char* dst, const char* src);
 
 int ulib__strcmp(const char*, const char*);
 char* ulib__strcat(char*, const char*);
 
+void* ulib__memchr(const void*, int, unsigned int);
+int ulib__memcmp(const void*, const void*, unsigned int);
+
 #endif /* DEFS_H */
 
 
 #ifdef DEFS_IMPLEMENTATION
 
+/* 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+	CPU feature dispatch
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+static int ulib__cpu_max = -1;
+static int ulib__cpu_cur = -1;
+
+static void ulib__select_kernels();
+
+const char* ulib_cpu_name(unsigned int tier){
+	static const char* names[] = {"scalar", "sse2", "avx2", "avx512"};
+	return tier <= ULIB_CPU_AVX512 ? names[tier] : "unknown";
+}
+
+/* Returns the highest tier supported by both the CPU and the OS */
+unsigned int ulib_cpu_detect(){
+	int max = ULIB__LOAD(ulib__cpu_max);
+	if(max >= 0) return (unsigned int)max;
+	max = ULIB_CPU_SCALAR;
+#ifdef ULIB_X86
+	{
+		unsigned int a, b, c, d, xcr0 = 0;
+		unsigned int leaves = __get_cpuid_max(0, 0);
+		if(leaves >= 1) __cpuid(1, a, b, c, d);
+		else d = c = 0;
+		if(d & bit_SSE2) max = ULIB_CPU_SSE2;
+		/* The OS must save the wide registers for AVX to be usable */
+		if((c & bit_OSXSAVE) && (c & bit_AVX)){
+			__asm__ __volatile__("xgetbv" : "=a"(xcr0), "=d"(d) : "c"(0));
+		}
+		if(leaves >= 7 && (xcr0 & 0x6) == 0x6){
+			__cpuid_count(7, 0, a, b, c, d);
+			if(b & bit_AVX2) max = ULIB_CPU_AVX2;
+			if((xcr0 & 0xE6) == 0xE6 && (b & bit_AVX512F) && (b & bit_AVX512BW)){
+				max = ULIB_CPU_AVX512;
+			}
+		}
+	}
+#endif
+	ULIB__STORE(ulib__cpu_max, max);
+	return (unsigned int)max;
+}
+
+/* Tier in use: the detected one, capped by the ULIB_CPU variable */
+unsigned int ulib_cpu_tier(){
+	unsigned int t, i;
+	const char *env, *name;
+	int cur = ULIB__LOAD(ulib__cpu_cur);
+	if(cur >= 0) return (unsigned int)cur;
+	t = ulib_cpu_detect();
+	env = ULIB_GETENV("ULIB_CPU");
+	/* Plain loop: the dispatched strcmp may not be ready yet */
+	for(i=0; env && i<=ULIB_CPU_AVX512; ++i){
+		name = ulib_cpu_name(i);
+		while(*name && *name == env[name - ulib_cpu_name(i)]) name++;
+		if(*name == 0 && env[name - ulib_cpu_name(i)] == 0 && i < t) t = i;
+	}
+	ULIB__STORE(ulib__cpu_cur, (int)t);
+	return t;
+}
+
+/*
+Switches to the given tier, or the highest supported one below it.
+Calls running meanwhile in other threads may use either tier.
+*/
+unsigned int ulib_cpu_set_tier(unsigned int tier){
+	if(tier > ulib_cpu_detect()) tier = ulib_cpu_detect();
+	ULIB__STORE(ulib__cpu_cur, (int)tier);
+	ulib__select_kernels();
+	return tier;
+}
+
+/*
+	Kernel tables for the defs.h primitives, one per tier, never written.
+	'ulib__kern' starts at a table of stubs that pick the tier's table
+	and forward the call, and is only ever swapped whole, atomically,
+	so threads may make their first calls at the same time.
+*/
+struct ulib__kernels_struct {
+	unsigned int (*copy_fwd)(unsigned char*, const unsigned char*, unsigned int, int);
+	unsigned int (*copy_bwd)(unsigned char*, const unsigned char*, unsigned int);
+	unsigned int (*str_len)(const char*);
+	int (*str_cmp)(const char*, const char*);
+	void* (*mem_chr)(const void*, int, unsigned int);
+	int (*mem_cmp)(const void*, const void*, unsigned int);
+};
+
+static unsigned int ulib__copy_fwd_init(unsigned char*, const unsigned char*, unsigned int, int);
+static unsigned int ulib__copy_bwd_init(unsigned char*, const unsigned char*, unsigned int);
+static unsigned int ulib__strlen_init(const char*);
+static int ulib__strcmp_init(const char*, const char*);
+static void* ulib__memchr_init(const void*, int, unsigned int);
+static int ulib__memcmp_init(const void*, const void*, unsigned int);
+
+static const struct ulib__kernels_struct ulib__kern_init = {
+	ulib__copy_fwd_init,
+	ulib__copy_bwd_init,
+	ulib__strlen_init,
+	ulib__strcmp_init,
+	ulib__memchr_init,
+	ulib__memcmp_init
+};
+
+static const struct ulib__kernels_struct* ulib__kern = &ulib__kern_init;
+
+#define ULIB__KERN() ULIB__LOAD(ulib__kern)
+
+static unsigned int ulib__copy_fwd_init(unsigned char* d, const unsigned char* s, unsigned int n, int stream){
+	ulib__select_kernels();
+	return ULIB__KERN()->copy_fwd(d, s, n, stream);
+}
+
+static unsigned int ulib__copy_bwd_init(unsigned char* d, const unsigned char* s, unsigned int n){
+	ulib__select_kernels();
+	return ULIB__KERN()->copy_bwd(d, s, n);
+}
+
+static unsigned int ulib__strlen_init(const char* str){
+	ulib__select_kernels();
+	return ULIB__KERN()->str_len(str);
+}
+
+static int ulib__strcmp_init(const char* x, const char* y){
+	ulib__select_kernels();
+	return ULIB__KERN()->str_cmp(x, y);
+}
+
+static void* ulib__memchr_init(const void* ptr, int c, unsigned int bytes){
+	ulib__select_kernels();
+	return ULIB__KERN()->mem_chr(ptr, c, bytes);
+}
+
+static int ulib__memcmp_init(const void* x, const void* y, unsigned int bytes){
+	ulib__select_kernels();
+	return ULIB__KERN()->mem_cmp(x, y, bytes);
+}
+
+/* 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+	Scalar tier: word-at-a-time kernels
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+/* Bulk copy step of the scalar tier: left to the word loops */
+static unsigned int ulib__copy_fwd_word(unsigned char* d, const unsigned char* s, unsigned int n, int stream){
+	(void)d; (void)s; (void)n; (void)stream;
+	return 0;
+}
+
+static unsigned int ulib__copy_bwd_word(unsigned char* d, const unsigned char* s, unsigned int n){
+	(void)d; (void)s; (void)n;
+	return 0;
+}
+
+/* The string scans that read past the terminator, or byte loops under checkers */
+#ifndef ULIB__NO_OVERREAD
+static unsigned int ulib__strlen_word(const char* str){
+	const char* p = str;
+	const ulib__word* w;
+	while(ULIB__ADDR(p) & ULIB__WMASK){
+		if(!*p) return (unsigned int)(p - str);
+		p++;
+	}
+	/* Aligned loads never cross a page boundary */
+	w = (const ulib__word*)p;
+	while(!ULIB__HASZERO(*w)) w++;
+	p = (const char*)w;
+	while(*p) p++;
+	return (unsigned int)(p - str);
+}
+
+static int ulib__strcmp_word(const char* x, const char* y){
+	const unsigned char* a = (const unsigned char*)x;
+	const unsigned char* b = (const unsigned char*)y;
+	const ulib__word *wa, *wb;
+	/* Words can only be compared when both strings share alignment */
+	if(((ULIB__ADDR(a) ^ ULIB__ADDR(b)) & ULIB__WMASK) == 0){
+		while(ULIB__ADDR(a) & ULIB__WMASK){
+			if(*a != *b || !*a) return *a - *b;
+			a++;
+			b++;
+		}
+		wa = (const ulib__word*)a;
+		wb = (const ulib__word*)b;
+		while(*wa == *wb && !ULIB__HASZERO(*wa)){
+			wa++;
+			wb++;
+		}
+		a = (const unsigned char*)wa;
+		b = (const unsigned char*)wb;
+	}
+	while(*a && *a == *b){
+		a++;
+		b++;
+	}
+	return *a - *b;
+}
+
+#else
+static unsigned int ulib__strlen_byte(const char* str){
+	const char* p = str;
+	while(*p) p++;
+	return (unsigned int)(p - str);
+}
+
+static int ulib__strcmp_byte(const char* x, const char* y){
+	const unsigned char* a = (const unsigned char*)x;
+	const unsigned char* b = (const unsigned char*)y;
+	while(*a && *a == *b){
+		a++;
+		b++;
+	}
+	return *a - *b;
+}
+#endif
+
+static void* ulib__memchr_word(const void* ptr, int c, unsigned int bytes){
+	const unsigned char* p = ptr;
+	const unsigned char ch = (unsigned char)c;
+	const ulib__word pat = ULIB__ONES * ch;
+	const ulib__word* w;
+	ulib__word v;
+	while(bytes && (ULIB__ADDR(p) & ULIB__WMASK)){
+		if(*p == ch) return (void*)p;
+		p++;
+		bytes--;
+	}
+	for(w = (const ulib__word*)p; bytes >= ULIB__WSIZE; bytes -= ULIB__WSIZE, w++){
+		v = *w ^ pat;
+		if(ULIB__HASZERO(v)) break;
+	}
+	for(p = (const unsigned char*)w; bytes; bytes--, p++){
+		if(*p == ch) return (void*)p;
+	}
+	return NULL;
+}
+
+static int ulib__memcmp_word(const void* x, const void* y, unsigned int bytes){
+	const unsigned char* a = x;
+	const unsigned char* b = y;
+#ifdef ULIB_UNALIGNED_OK
+	const ulib__uword *wa = (const ulib__uword*)a, *wb = (const ulib__uword*)b;
+	for(; bytes >= ULIB__WSIZE && *wa == *wb; bytes -= ULIB__WSIZE){
+		wa++;
+		wb++;
+	}
+	a = (const unsigned char*)wa;
+	b = (const unsigned char*)wb;
+#endif
+	for(; bytes; bytes--, a++, b++){
+		if(*a != *b) return *a - *b;
+	}
+	return 0;
+}
+
+#ifdef ULIB_X86
+
+/* Index of the lowest set bit of a non-zero mask */
+static unsigned int ulib__ctz(unsigned int mask){
+	return (unsigned int)__builtin_ctz(mask);
+}
+
+/* Whether 'bytes' bytes can be read from 'p' without entering the next page */
+#define ULIB__PAGE_SAFE(p, bytes) \
+	((ULIB__ADDR(p) & (ULIB_PAGE_BYTES - 1)) <= ULIB_PAGE_BYTES - (bytes))
+
+/* 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+	SSE2 tier
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+/*
+Copies the largest multiple of 64 bytes forward.
+The destination is aligned to 16 bytes first.
+Returns the number of bytes copied.
+*/
+ULIB__TARGET("sse2")
+static unsigned int ulib__copy_fwd_sse2(unsigned char* d, const unsigned char* s, unsigned int n, int stream){
+	unsigned int done = 0;
+	__m128i a, b, c, e;
+	while(ULIB__ADDR(d + done) & 15){ d[done] = s[done]; done++; }
+	for(; n - done >= 64; done += 64){
+		a = _mm_loadu_si128((const __m128i*)(s + done));
+		b = _mm_loadu_si128((const __m128i*)(s + done + 16));
+		c = _mm_loadu_si128((const __m128i*)(s + done + 32));
+		e = _mm_loadu_si128((const __m128i*)(s + done + 48));
+		if(stream){
+			_mm_stream_si128((__m128i*)(d + done), a);
+			_mm_stream_si128((__m128i*)(d + done + 16), b);
+			_mm_stream_si128((__m128i*)(d + done + 32), c);
+			_mm_stream_si128((__m128i*)(d + done + 48), e);
+		}
+		else{
+			_mm_store_si128((__m128i*)(d + done), a);
+			_mm_store_si128((__m128i*)(d + done + 16), b);
+			_mm_store_si128((__m128i*)(d + done + 32), c);
+			_mm_store_si128((__m128i*)(d + done + 48), e);
+		}
+	}
+	if(stream) _mm_sfence();
+	return done;
+}
+
+/* Backward counterpart: copies from the end, returns bytes copied */
+ULIB__TARGET("sse2")
+static unsigned int ulib__copy_bwd_sse2(unsigned char* d, const unsigned char* s, unsigned int n){
+	unsigned int left = n;
+	__m128i a, b, c, e;
+	while(ULIB__ADDR(d + left) & 15){ left--; d[left] = s[left]; }
+	for(; left >= 64; left -= 64){
+		a = _mm_loadu_si128((const __m128i*)(s + left - 16));
+		b = _mm_loadu_si128((const __m128i*)(s + left - 32));
+		c = _mm_loadu_si128((const __m128i*)(s + left - 48));
+		e = _mm_loadu_si128((const __m128i*)(s + left - 64));
+		_mm_store_si128((__m128i*)(d + left - 16), a);
+		_mm_store_si128((__m128i*)(d + left - 32), b);
+		_mm_store_si128((__m128i*)(d + left - 48), c);
+		_mm_store_si128((__m128i*)(d + left - 64), e);
+	}
+	return n - left;
+}
+
+#ifndef ULIB__NO_OVERREAD
+ULIB__TARGET("sse2")
+static unsigned int ulib__strlen_sse2(const char* str){
+	/* Aligned loads never cross a page boundary */
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i* v = (const __m128i*)(str - (ULIB__ADDR(str) & 15));
+	unsigned int mask;
+
+	mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(v), zero));
+	mask >>= ULIB__ADDR(str) & 15;
+	if(mask) return ulib__ctz(mask);
+	for(;;){
+		v++;
+		mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(v), zero));
+		if(mask) return (unsigned int)((const char*)v - str) + ulib__ctz(mask);
+	}
+}
+
+ULIB__TARGET("sse2")
+static int ulib__strcmp_sse2(const char* x, const char* y){
+	const unsigned char* a = (const unsigned char*)x;
+	const unsigned char* b = (const unsigned char*)y;
+	const __m128i zero = _mm_setzero_si128();
+	__m128i va, vb;
+	unsigned int mask;
+	for(;;){
+		if(ULIB__PAGE_SAFE(a, 16) && ULIB__PAGE_SAFE(b, 16)){
+			va = _mm_loadu_si128((const __m128i*)a);
+			vb = _mm_loadu_si128((const __m128i*)b);
+			/* Bits set where the bytes match and 'a' has not ended */
+			mask = (unsigned int)_mm_movemask_epi8(
+				_mm_andnot_si128(_mm_cmpeq_epi8(va, zero), _mm_cmpeq_epi8(va, vb)));
+			if(mask != 0xFFFF){
+				mask = ulib__ctz(~mask);
+				return a[mask] - b[mask];
+			}
+			a += 16;
+			b += 16;
+		}
+		else{
+			/* Step bytewise over the page boundary */
+			if(*a != *b || !*a) return *a - *b;
+			a++;
+			b++;
+		}
+	}
+}
+#endif
+
+ULIB__TARGET("sse2")
+static void* ulib__memchr_sse2(const void* ptr, int c, unsigned int bytes){
+	const unsigned char* p = ptr;
+	const __m128i pat = _mm_set1_epi8((char)c);
+	unsigned int mask;
+	for(; bytes >= 16; bytes -= 16, p += 16){
+		mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), pat));
+		if(mask) return (void*)(p + ulib__ctz(mask));
+	}
+	for(; bytes; bytes--, p++){
+		if(*p == (unsigned char)c) return (void*)p;
+	}
+	return NULL;
+}
+
+ULIB__TARGET("sse2")
+static int ulib__memcmp_sse2(const void* x, const void* y, unsigned int bytes){
+	const unsigned char* a = x;
+	const unsigned char* b = y;
+	unsigned int mask;
+	for(; bytes >= 16; bytes -= 16, a += 16, b += 16){
+		mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(
+			_mm_loadu_si128((const __m128i*)a), _mm_loadu_si128((const __m128i*)b)));
+		if(mask != 0xFFFF){
+			mask = ulib__ctz(~mask);
+			return a[mask] - b[mask];
+		}
+	}
+	for(; bytes; bytes--, a++, b++){
+		if(*a != *b) return *a - *b;
+	}
+	return 0;
+}
+
+/* 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+	AVX2 tier
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+/* As ulib__copy_fwd_sse2, in 128 byte steps with 32 byte alignment */
+ULIB__TARGET("avx2")
+static unsigned int ulib__copy_fwd_avx2(unsigned char* d, const unsigned char* s, unsigned int n, int stream){
+	unsigned int done = 0;
+	__m256i a, b, c, e;
+	while(ULIB__ADDR(d + done) & 31){ d[done] = s[done]; done++; }
+	for(; n - done >= 128; done += 128){
+		a = _mm256_loadu_si256((const __m256i*)(s + done));
+		b = _mm256_loadu_si256((const __m256i*)(s + done + 32));
+		c = _mm256_loadu_si256((const __m256i*)(s + done + 64));
+		e = _mm256_loadu_si256((const __m256i*)(s + done + 96));
+		if(stream){
+			_mm256_stream_si256((__m256i*)(d + done), a);
+			_mm256_stream_si256((__m256i*)(d + done + 32), b);
+			_mm256_stream_si256((__m256i*)(d + done + 64), c);
+			_mm256_stream_si256((__m256i*)(d + done + 96), e);
+		}
+		else{
+			_mm256_store_si256((__m256i*)(d + done), a);
+			_mm256_store_si256((__m256i*)(d + done + 32), b);
+			_mm256_store_si256((__m256i*)(d + done + 64), c);
+			_mm256_store_si256((__m256i*)(d + done + 96), e);
+		}
+	}
+	if(stream) _mm_sfence();
+	return done;
+}
+
+ULIB__TARGET("avx2")
+static unsigned int ulib__copy_bwd_avx2(unsigned char* d, const unsigned char* s, unsigned int n){
+	unsigned int left = n;
+	__m256i a, b, c, e;
+	while(ULIB__ADDR(d + left) & 31){ left--; d[left] = s[left]; }
+	for(; left >= 128; left -= 128){
+		a = _mm256_loadu_si256((const __m256i*)(s + left - 32));
+		b = _mm256_loadu_si256((const __m256i*)(s + left - 64));
+		c = _mm256_loadu_si256((const __m256i*)(s + left - 96));
+		e = _mm256_loadu_si256((const __m256i*)(s + left - 128));
+		_mm256_store_si256((__m256i*)(d + left - 32), a);
+		_mm256_store_si256((__m256i*)(d + left - 64), b);
+		_mm256_store_si256((__m256i*)(d + left - 96), c);
+		_mm256_store_si256((__m256i*)(d + left - 128), e);
+	}
+	return n - left;
+}
+
+#ifndef ULIB__NO_OVERREAD
+ULIB__TARGET("avx2")
+static unsigned int ulib__strlen_avx2(const char* str){
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i* v = (const __m256i*)(str - (ULIB__ADDR(str) & 31));
+	unsigned int mask;
+
+	mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(v), zero));
+	mask >>= ULIB__ADDR(str) & 31;
+	if(mask) return ulib__ctz(mask);
+	for(;;){
+		v++;
+		mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(v), zero));
+		if(mask) return (unsigned int)((const char*)v - str) + ulib__ctz(mask);
+	}
+}
+#endif
+
+ULIB__TARGET("avx2")
+static void* ulib__memchr_avx2(const void* ptr, int c, unsigned int bytes){
+	const unsigned char* p = ptr;
+	const __m256i pat = _mm256_set1_epi8((char)c);
+	unsigned int mask;
+	for(; bytes >= 32; bytes -= 32, p += 32){
+		mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)p), pat));
+		if(mask) return (void*)(p + ulib__ctz(mask));
+	}
+	return ulib__memchr_sse2(p, c, bytes);
+}
+
+ULIB__TARGET("avx2")
+static int ulib__memcmp_avx2(const void* x, const void* y, unsigned int bytes){
+	const unsigned char* a = x;
+	const unsigned char* b = y;
+	unsigned int mask;
+	for(; bytes >= 32; bytes -= 32, a += 32, b += 32){
+		mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+			_mm256_loadu_si256((const __m256i*)a), _mm256_loadu_si256((const __m256i*)b)));
+		if(mask != 0xFFFFFFFFu){
+			mask = ulib__ctz(~mask);
+			return a[mask] - b[mask];
+		}
+	}
+	return ulib__memcmp_sse2(a, b, bytes);
+}
+
+/* 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+	AVX-512 tier (string scans keep the AVX2 kernels)
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+/* As ulib__copy_fwd_sse2, in 256 byte steps with 64 byte alignment */
+ULIB__TARGET("avx512f")
+static unsigned int ulib__copy_fwd_avx512(unsigned char* d, const unsigned char* s, unsigned int n, int stream){
+	unsigned int done = 0;
+	__m512i a, b, c, e;
+	while(ULIB__ADDR(d + done) & 63){ d[done] = s[done]; done++; }
+	for(; n - done >= 256; done += 256){
+		a = _mm512_loadu_si512((const void*)(s + done));
+		b = _mm512_loadu_si512((const void*)(s + done + 64));
+		c = _mm512_loadu_si512((const void*)(s + done + 128));
+		e = _mm512_loadu_si512((const void*)(s + done + 192));
+		if(stream){
+			_mm512_stream_si512((void*)(d + done), a);
+			_mm512_stream_si512((void*)(d + done + 64), b);
+			_mm512_stream_si512((void*)(d + done + 128), c);
+			_mm512_stream_si512((void*)(d + done + 192), e);
+		}
+		else{
+			_mm512_store_si512((void*)(d + done), a);
+			_mm512_store_si512((void*)(d + done + 64), b);
+			_mm512_store_si512((void*)(d + done + 128), c);
+			_mm512_store_si512((void*)(d + done + 192), e);
+		}
+	}
+	if(stream) _mm_sfence();
+	return done;
+}
+
+ULIB__TARGET("avx512f")
+static unsigned int ulib__copy_bwd_avx512(unsigned char* d, const unsigned char* s, unsigned int n){
+	unsigned int left = n;
+	__m512i a, b, c, e;
+	while(ULIB__ADDR(d + left) & 63){ left--; d[left] = s[left]; }
+	for(; left >= 256; left -= 256){
+		a = _mm512_loadu_si512((const void*)(s + left - 64));
+		b = _mm512_loadu_si512((const void*)(s + left - 128));
+		c = _mm512_loadu_si512((const void*)(s + left - 192));
+		e = _mm512_loadu_si512((const void*)(s + left - 256));
+		_mm512_store_si512((void*)(d + left - 64), a);
+		_mm512_store_si512((void*)(d + left - 128), b);
+		_mm512_store_si512((void*)(d + left - 192), c);
+		_mm512_store_si512((void*)(d + left - 256), e);
+	}
+	return n - left;
+}
+
+#endif /* ULIB_X86 */
+
+/* The string scans that read past the terminator are left out under checkers */
+#ifdef ULIB__NO_OVERREAD
+	#define ULIB__SCAN(fast, safe) safe
+#else
+	#define ULIB__SCAN(fast, safe) fast
+#endif
+
+/* In the order of ulib__cpu_tiers */
+static const struct ulib__kernels_struct ulib__kern_tiers[] = {
+	{
+		ulib__copy_fwd_word,
+		ulib__copy_bwd_word,
+		ULIB__SCAN(ulib__strlen_word, ulib__strlen_byte),
+		ULIB__SCAN(ulib__strcmp_word, ulib__strcmp_byte),
+		ulib__memchr_word,
+		ulib__memcmp_word
+	},
+#ifdef ULIB_X86
+	{
+		ulib__copy_fwd_sse2,
+		ulib__copy_bwd_sse2,
+		ULIB__SCAN(ulib__strlen_sse2, ulib__strlen_byte),
+		ULIB__SCAN(ulib__strcmp_sse2, ulib__strcmp_byte),
+		ulib__memchr_sse2,
+		ulib__memcmp_sse2
+	},
+	{
+		ulib__copy_fwd_avx2,
+		ulib__copy_bwd_avx2,
+		ULIB__SCAN(ulib__strlen_avx2, ulib__strlen_byte),
+		ULIB__SCAN(ulib__strcmp_sse2, ulib__strcmp_byte),
+		ulib__memchr_avx2,
+		ulib__memcmp_avx2
+	},
+	{
+		ulib__copy_fwd_avx512,
+		ulib__copy_bwd_avx512,
+		ULIB__SCAN(ulib__strlen_avx2, ulib__strlen_byte),
+		ULIB__SCAN(ulib__strcmp_sse2, ulib__strcmp_byte),
+		ulib__memchr_avx2,
+		ulib__memcmp_avx2
+	}
+#endif
+};
+
+/* Points the kernel table at the current tier's */
+static void ulib__select_kernels(){
+	unsigned int tier = ulib_cpu_tier();
+	unsigned int last = sizeof(ulib__kern_tiers)/sizeof(ulib__kern_tiers[0]) - 1;
+	ULIB__STORE(ulib__kern, &ulib__kern_tiers[tier < last ? tier : last]);
+}
+
+/* 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+	Memory copy engine
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+/*
+Copies 'n' bytes from low to high addresses.
+Safe for overlapping buffers as long as d <= s.
+*/
+static void ulib__copy_fwd(unsigned char* d, const unsigned char* s, unsigned int n, int stream){
+	ulib__word *wd;
+	const ulib__uword *ws;
+	unsigned int k;
+
+	if(n >= 256){
+		k = ULIB__KERN()->copy_fwd(d, s, n, stream);
+		d += k; s += k; n -= k;
+	}
+
+	if(n >= 2*ULIB__WSIZE){
+		/* Align the destination to a word boundary */
+		while(ULIB__ADDR(d) & ULIB__WMASK){ *d++ = *s++; n--; }
+#ifndef ULIB_UNALIGNED_OK
+		if((ULIB__ADDR(s) & ULIB__WMASK) == 0)
+#endif
+		{
+			wd = (ulib__word*)d;
+			ws = (const ulib__uword*)s;
+			for(k = n / ULIB__WSIZE; k >= 4; k -= 4){
+				wd[0] = ws[0];
+				wd[1] = ws[1];
+				wd[2] = ws[2];
+				wd[3] = ws[3];
+				wd += 4;
+				ws += 4;
+			}
+			while(k--) *wd++ = *ws++;
+			d = (unsigned char*)wd;
+			s = (const unsigned char*)ws;
+			n &= ULIB__WMASK;
+		}
+	}
+	while(n--) *d++ = *s++;
+}
+
+/*
+Copies 'n' bytes from high to low addresses.
+Safe for overlapping buffers as long as d >= s.
+*/
+static void ulib__copy_bwd(unsigned char* d, const unsigned char* s, unsigned int n){
+	ulib__word *wd;
+	const ulib__uword *ws;
+	unsigned int k;
+
+	if(n >= 256) n -= ULIB__KERN()->copy_bwd(d, s, n);
+
+	/* From here on, 'd + n' and 's + n' are the ends of what is left */
+	if(n >= 2*ULIB__WSIZE){
+		while(ULIB__ADDR(d + n) & ULIB__WMASK){ n--; d[n] = s[n]; }
+#ifndef ULIB_UNALIGNED_OK
+		if((ULIB__ADDR(s + n) & ULIB__WMASK) == 0)
+#endif
+		{
+			wd = (ulib__word*)(d + n);
+			ws = (const ulib__uword*)(s + n);
+			for(k = n / ULIB__WSIZE; k >= 4; k -= 4){
+				wd[-1] = ws[-1];
+				wd[-2] = ws[-2];
+				wd[-3] = ws[-3];
+				wd[-4] = ws[-4];
+				wd -= 4;
+				ws -= 4;
+			}
+			while(k--) *--wd = *--ws;
+			n &= ULIB__WMASK;
+		}
+	}
+	while(n){ n--; d[n] = s[n]; }
+}
+
 void* ulib__memcpy(void* dst, const void* src, unsigned int bytes){
-	unsigned int i;
-	char *d = dst;
-	const char* s = src;
-	for (i=0; i!=bytes; ++i) d[i] = s[i];
+	ulib__copy_fwd(dst, src, bytes, bytes >= ULIB_MEMCPY_STREAM_BYTES);
 	return dst;
 }
 
+void* ulib__memmove(void* dst, const void* src, unsigned int bytes){
+	unsigned char* d = dst;
+	const unsigned char* s = src;
+	if(d == s || bytes == 0) return dst;
+	/* Copy forward unless the destination overlaps the tail of the source */
+	if(d < s || d >= s + bytes) ulib__copy_fwd(d, s, bytes, 0);
+	else ulib__copy_bwd(d, s, bytes);
+	return dst;
+}
+
+/* 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+	Allocators
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+static void* ulib__default_alloc(void* ctx, unsigned int bytes){
+	(void)ctx;
+	return ULIB_MALLOC(bytes);
+}
+
+static void* ulib__default_realloc(void* ctx, void* ptr, unsigned int old_bytes, unsigned int new_bytes){
+	(void)ctx;
+	(void)old_bytes;
+	return ULIB_REALLOC(ptr, new_bytes);
+}
+
+static void ulib__default_free(void* ctx, void* ptr, unsigned int bytes){
+	(void)ctx;
+	(void)bytes;
+	ULIB_FREE(ptr);
+}
+
+const ulib_allocator ulib_default_allocator = {
+	ulib__default_alloc,
+	ulib__default_realloc,
+	ulib__default_free,
+	NULL
+};
+
+/* Allocation tracking */
+
+static ulib_alloc_stats ulib__stats[ULIB_TAG_COUNT+1];
+
+static const char* ulib__tag_names[ULIB_TAG_COUNT+1] = {
+	"other", "vector", "array", "list", "string", "arglib", "arena", "pool", "segvec", "deque", "appendvec", "soa", "all"
+};
+
+enum ulib__track_events {ULIB__TRACK_ALLOC, ULIB__TRACK_REALLOC, ULIB__TRACK_FREE};
+
+#ifdef ULIB_TRACK_ALLOC
+/* Records one event on the heap, for 'tag' and for the total */
+static void ulib__track(const ulib_allocator* a, unsigned int tag, unsigned int event,
+	unsigned int old_bytes, unsigned int new_bytes, unsigned int copied){
+	unsigned int i, idx[2];
+	ulib_alloc_stats* st;
+	if(a != &ulib_default_allocator) return;
+	idx[0] = tag < ULIB_TAG_COUNT ? tag : ULIB_TAG_OTHER;
+	idx[1] = ULIB_TAG_ALL;
+	for(i=0; i!=2; ++i){
+		st = &ulib__stats[idx[i]];
+		if(event == ULIB__TRACK_ALLOC) st->allocs++;
+		else if(event == ULIB__TRACK_REALLOC) st->reallocs++;
+		else st->frees++;
+		st->live_bytes += (unsigned long)new_bytes - old_bytes;
+		if(new_bytes > old_bytes) st->total_bytes += new_bytes - old_bytes;
+		if(st->live_bytes > st->peak_bytes) st->peak_bytes = st->live_bytes;
+		st->copied_bytes += copied;
+	}
+}
+#define ULIB__TRACK(a, tag, event, old_bytes, new_bytes, copied) \
+	ulib__track(a, tag, event, old_bytes, new_bytes, copied)
+#else
+#define ULIB__TRACK(a, tag, event, old_bytes, new_bytes, copied) ((void)(tag), (void)(copied))
+#endif
+
+/* Counters for 'tag', or for every tag with ULIB_TAG_ALL */
+const ulib_alloc_stats* ulib_alloc_query(unsigned int tag){
+	if(tag > ULIB_TAG_ALL) return NULL;
+	return &ulib__stats[tag];
+}
+
+const char* ulib_alloc_tag_name(unsigned int tag){
+	if(tag > ULIB_TAG_ALL) return NULL;
+	return ulib__tag_names[tag];
+}
+
+/* Sets every counter back to zero, including live bytes */
+void ulib_alloc_reset(){
+	unsigned int i;
+	ulib_alloc_stats zero = {0, 0, 0, 0, 0, 0, 0};
+	for(i=0; i!=ULIB_TAG_ALL+1; ++i) ulib__stats[i] = zero;
+}
+
+/* Prints every counter to 'stream' as a table or a JSON object */
+void ulib_alloc_dump(void* stream, unsigned int format){
+	unsigned int i;
+	const ulib_alloc_stats* st;
+	if(format == ULIB_DUMP_JSON) ULIB_FPRINTF(stream, "{");
+	else ULIB_FPRINTF(stream, "%-8s %10s %10s %10s %12s %12s %14s %14s\n", "tag",
+		"allocs", "reallocs", "frees", "live", "peak", "requested", "copied");
+	for(i=0; i!=ULIB_TAG_ALL+1; ++i){
+		st = &ulib__stats[i];
+		if(format == ULIB_DUMP_JSON){
+			ULIB_FPRINTF(stream, "%s\"%s\": {\"allocs\": %lu, \"reallocs\": %lu, \"frees\": %lu, "
+				"\"live_bytes\": %lu, \"peak_bytes\": %lu, \"total_bytes\": %lu, \"copied_bytes\": %lu}",
+				i ? ", " : "", ulib__tag_names[i], st->allocs, st->reallocs, st->frees,
+				st->live_bytes, st->peak_bytes, st->total_bytes, st->copied_bytes);
+		}
+		else{
+			ULIB_FPRINTF(stream, "%-8s %10lu %10lu %10lu %12lu %12lu %14lu %14lu\n", ulib__tag_names[i],
+				st->allocs, st->reallocs, st->frees, st->live_bytes, st->peak_bytes,
+				st->total_bytes, st->copied_bytes);
+		}
+	}
+	if(format == ULIB_DUMP_JSON) ULIB_FPRINTF(stream, "}\n");
+}
+
+/*
+The helpers below accept a NULL allocator as the default one.
+'tag' names the container type, for ULIB_TRACK_ALLOC.
+*/
+
+void* ulib__alloc(const ulib_allocator* a, unsigned int bytes, unsigned int tag){
+	void* ptr;
+	if(!a) a = &ulib_default_allocator;
+	if(bytes == 0) return NULL;
+	ptr = a->alloc(a->ctx, bytes);
+	if(ptr) ULIB__TRACK(a, tag, ULIB__TRACK_ALLOC, 0, bytes, 0);
+	return ptr;
+}
+
+/* Allocates zeroed memory */
+void* ulib__zalloc(const ulib_allocator* a, unsigned int bytes, unsigned int tag){
+	void* ptr = ulib__alloc(a, bytes, tag);
+	ulib__word* w = ptr;
+	unsigned char* p;
+	if(!ptr) return NULL;
+	/* allocations are at least word aligned */
+	for(; bytes >= ULIB__WSIZE; bytes -= ULIB__WSIZE) *w++ = 0;
+	for(p = (unsigned char*)w; bytes; bytes--) *p++ = 0;
+	return ptr;
+}
+
+/* Behaves as alloc when 'ptr' is NULL, and as free when 'new_bytes' is 0 */
+void* ulib__realloc(const ulib_allocator* a, void* ptr, unsigned int old_bytes, unsigned int new_bytes, unsigned int tag){
+	size_t old_addr = ULIB__ADDR(ptr);
+	void* r;
+	if(!a) a = &ulib_default_allocator;
+	if(!ptr) return ulib__alloc(a, new_bytes, tag);
+	if(new_bytes == 0){
+		ulib__dealloc(a, ptr, old_bytes, tag);
+		return NULL;
+	}
+	r = a->realloc(a->ctx, ptr, old_bytes, new_bytes);
+	if(r){
+		ULIB__TRACK(a, tag, ULIB__TRACK_REALLOC, old_bytes, new_bytes,
+			ULIB__ADDR(r) != old_addr ? (old_bytes < new_bytes ? old_bytes : new_bytes) : 0);
+	}
+	return r;
+}
+
+void ulib__dealloc(const ulib_allocator* a, void* ptr, unsigned int bytes, unsigned int tag){
+	if(!a) a = &ulib_default_allocator;
+	if(!ptr) return;
+	a->free(a->ctx, ptr, bytes);
+	ULIB__TRACK(a, tag, ULIB__TRACK_FREE, bytes, 0, 0);
+}
+
+/* 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+	String and memory scans
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
 unsigned int ulib__strlen(const char* str){
-	unsigned int len=0;
-	while(*str++) len++;
-	return len;
+	return ULIB__KERN()->str_len(str);
 }
 
 char* ulib__strcpy(char* dst, const char* src){
@@ -114,19 +1192,20 @@ char* ulib__strcpy(char* dst, const char* src){
 }
 
 int ulib__strcmp(const char* x, const char* y){
-	while(*x){
-		if(*x!=*y) break;
-		x++;
-		y++;
-	}
-	return *(const unsigned char*)x - *(const unsigned char*)y;
+	return ULIB__KERN()->str_cmp(x, y);
 }
 
 char* ulib__strcat(char* dst, const char* src){
-	char* ret = dst;
-	while(*dst) dst++;
-	while( (*dst++ = *src++) );
-	return ret;
+	ULIB_MEMCPY(dst + ULIB_STRLEN(dst), src, ULIB_STRLEN(src) + 1);
+	return dst;
+}
+
+void* ulib__memchr(const void* ptr, int c, unsigned int bytes){
+	return ULIB__KERN()->mem_chr(ptr, c, bytes);
+}
+
+int ulib__memcmp(const void* x, const void* y, unsigned int bytes){
+	return ULIB__KERN()->mem_cmp(x, y, bytes);
 }
 
 #endif /* DEFS_IMPLEMENTATION */
@@ -0,0 +1,477 @@
+/*
+
+--- deque.h ---
+
+Header-only library that adds the deque, a double-ended queue of
+members of any size, kept in a ring buffer.
+
+Members may be pushed and popped at either end in O(1), without
+shifting the others as vector->insert(v, 0, ...) and
+vector->delete(v, 0) do. The capacity is a power of two, so the
+position of member i is (head + i) & (capacity - 1). Growing
+doubles it, copying the members to the new buffer in one run.
+
+	deque* q = deque_new( sizeof(T) );
+	q->push_back(q, &x);
+	q->push_front(q, &x);
+	q->pop_front(q, &x);
+	q->pop_back(q, &x);
+	T* p = q->at(q, i);
+	...
+	q->free(q);
+
+Members are contiguous in at most two runs. span returns member i
+and how many follow it before the buffer wraps, and push_back_array
+and pop_front_array move blocks of members with at most two copies:
+	for(i=0; (p = q->span(q, i, &n)); i += n) ...
+
+Pushing may move the members, so pointers from at, front and back
+are only valid until the next push.
+
+In order to use the functions from this library, write:
+	#define DEQUE_IMPLEMENTATION
+and THEN include the library:
+	#include "deque.h"
+
+Standard: ANSI C89
+
+
+VERSIONS
+
+v0.1
+	- Basics: deque_new, deque_new_alloc, free
+	- Ends: push_back, push_front, pop_back, pop_front,
+	emplace_back, emplace_front, front, back
+	- Members: at, set, span, push_back_array, pop_front_array
+	- Storage: length, capacity, elem_size, reserve, clear,
+	shrink_to_fit, mem
+
+*/
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		HEADER
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifndef DEQUE_H
+#define DEQUE_H 1
+
+#ifndef DEFS_IMPLEMENTATION
+#define DEFS_IMPLEMENTATION
+#include "defs.h"
+#endif
+
+/* Capacity of the first buffer, a power of two */
+#ifndef ULIB_DEQUE_MIN
+	#define ULIB_DEQUE_MIN 8
+#endif
+
+
+/*
+ *	DATA STRUCTURES & MACROS
+ */
+
+typedef struct deque__struct deque;
+
+/* Deque methods, shared by every deque under ULIB_SHARED_VTABLE (defs.h) */
+#define DEQUE__METHODS \
+	unsigned int (*length)(deque*); \
+	unsigned int (*capacity)(deque*); \
+	unsigned int (*elem_size)(deque*); \
+	void* (*at)(deque*, unsigned int); \
+	void* (*front)(deque*); \
+	void* (*back)(deque*); \
+	void* (*span)(deque*, unsigned int, unsigned int*); \
+	unsigned int (*mem)(deque*); \
+	deque* (*set)(deque*, unsigned int, const void*); \
+	deque* (*push_back)(deque*, const void*); \
+	deque* (*push_front)(deque*, const void*); \
+	void* (*emplace_back)(deque*); \
+	void* (*emplace_front)(deque*); \
+	deque* (*pop_back)(deque*, void*); \
+	deque* (*pop_front)(deque*, void*); \
+	deque* (*push_back_array)(deque*, const void*, unsigned int); \
+	unsigned int (*pop_front_array)(deque*, void*, unsigned int); \
+	deque* (*reserve)(deque*, unsigned int); \
+	deque* (*clear)(deque*); \
+	deque* (*shrink_to_fit)(deque*); \
+	void (*free)(deque*);
+
+typedef struct deque__vtable_struct deque_vtable;
+struct deque__vtable_struct {
+	DEQUE__METHODS
+};
+
+struct deque__struct {
+	char* d;
+	unsigned int head;  /* slot of the first member */
+	unsigned int len;
+	unsigned int cap;   /* zero or a power of two */
+	unsigned int dtype; /* bytes per member */
+	const ulib_allocator* alloc;
+
+	/* Methods */
+#ifdef ULIB_SHARED_VTABLE
+	const deque_vtable* vt;
+#else
+	DEQUE__METHODS
+#endif
+};
+
+
+/*
+ *	FUNCTION DECLARATIONS
+ */
+
+deque* deque_new(unsigned int bytes);
+deque* deque_new_alloc(unsigned int bytes, const ulib_allocator* alloc);
+
+unsigned int deque__length(deque* q);
+unsigned int deque__capacity(deque* q);
+unsigned int deque__elem_size(deque* q);
+void* deque__at(deque* q, unsigned int i);
+void* deque__front(deque* q);
+void* deque__back(deque* q);
+void* deque__span(deque* q, unsigned int i, unsigned int* n);
+unsigned int deque__mem(deque* q);
+deque* deque__set(deque* q, unsigned int i, const void* src);
+deque* deque__push_back(deque* q, const void* src);
+deque* deque__push_front(deque* q, const void* src);
+void* deque__emplace_back(deque* q);
+void* deque__emplace_front(deque* q);
+deque* deque__pop_back(deque* q, void* dest);
+deque* deque__pop_front(deque* q, void* dest);
+deque* deque__push_back_array(deque* q, const void* src, unsigned int n);
+unsigned int deque__pop_front_array(deque* q, void* dest, unsigned int n);
+deque* deque__reserve(deque* q, unsigned int cap);
+deque* deque__clear(deque* q);
+deque* deque__shrink_to_fit(deque* q);
+void deque__free(deque* q);
+
+#endif /* DEQUE_H */
+
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		IMPLEMENTATION
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifdef DEQUE_IMPLEMENTATION
+
+#ifdef ULIB_SHARED_VTABLE
+static const deque_vtable deque__methods = {
+	deque__length,
+	deque__capacity,
+	deque__elem_size,
+	deque__at,
+	deque__front,
+	deque__back,
+	deque__span,
+	deque__mem,
+	deque__set,
+	deque__push_back,
+	deque__push_front,
+	deque__emplace_back,
+	deque__emplace_front,
+	deque__pop_back,
+	deque__pop_front,
+	deque__push_back_array,
+	deque__pop_front_array,
+	deque__reserve,
+	deque__clear,
+	deque__shrink_to_fit,
+	deque__free
+};
+#endif
+
+/* Address of slot 'k' of the buffer, and of member 'i' */
+#define DEQUE__SLOT(q, k) ((q)->d + (size_t)(k)*(q)->dtype)
+#define DEQUE__AT(q, i) DEQUE__SLOT(q, ((q)->head + (i)) & ((q)->cap - 1))
+
+deque* deque_new(unsigned int bytes){
+	return deque_new_alloc(bytes, NULL);
+}
+
+/* As deque_new, taking its memory from 'alloc' (NULL for the default) */
+deque* deque_new_alloc(unsigned int bytes, const ulib_allocator* alloc){
+	deque* q;
+	if(bytes == 0) return NULL;
+	if(!alloc) alloc = &ulib_default_allocator;
+	q = ulib__alloc(alloc, sizeof(deque), ULIB_TAG_DEQUE);
+	if(!q) return NULL;
+
+	/* Variables */
+	q->d = NULL;
+	q->head = 0;
+	q->len = 0;
+	q->cap = 0;
+	q->dtype = bytes;
+	q->alloc = alloc;
+#ifdef ULIB_SHARED_VTABLE
+	q->vt = &deque__methods;
+#else
+	/* Methods */
+	q->length = deque__length;
+	q->capacity = deque__capacity;
+	q->elem_size = deque__elem_size;
+	q->at = deque__at;
+	q->front = deque__front;
+	q->back = deque__back;
+	q->span = deque__span;
+	q->mem = deque__mem;
+	q->set = deque__set;
+	q->push_back = deque__push_back;
+	q->push_front = deque__push_front;
+	q->emplace_back = deque__emplace_back;
+	q->emplace_front = deque__emplace_front;
+	q->pop_back = deque__pop_back;
+	q->pop_front = deque__pop_front;
+	q->push_back_array = deque__push_back_array;
+	q->pop_front_array = deque__pop_front_array;
+	q->reserve = deque__reserve;
+	q->clear = deque__clear;
+	q->shrink_to_fit = deque__shrink_to_fit;
+	q->free = deque__free;
+#endif
+	return q;
+}
+
+/*
+Moves the members to a buffer of 'cap' slots, a power of two no smaller
+than the length, starting at slot 0. Returns NULL if out of memory.
+*/
+static deque* deque__set_cap(deque* q, unsigned int cap){
+	char* d;
+	unsigned int first;
+	if(cap == q->cap && q->head == 0) return q;
+	if(cap > (unsigned int)-1 / q->dtype) return NULL;
+	if(cap == 0){
+		if(q->d) ulib__dealloc(q->alloc, q->d, q->cap*q->dtype, ULIB_TAG_DEQUE);
+		q->d = NULL;
+		q->cap = q->head = 0;
+		return q;
+	}
+	d = ulib__alloc(q->alloc, cap*q->dtype, ULIB_TAG_DEQUE);
+	if(!d) return NULL;
+
+	/* The run up to the end of the old buffer, then the wrapped one */
+	first = q->cap - q->head < q->len ? q->cap - q->head : q->len;
+	if(first) ULIB_MEMCPY(d, DEQUE__SLOT(q, q->head), first*q->dtype);
+	if(q->len > first) ULIB_MEMCPY(d + first*q->dtype, q->d, (q->len - first)*q->dtype);
+
+	if(q->d) ulib__dealloc(q->alloc, q->d, q->cap*q->dtype, ULIB_TAG_DEQUE);
+	q->d = d;
+	q->cap = cap;
+	q->head = 0;
+	return q;
+}
+
+/* Smallest power of two capacity, from ULIB_DEQUE_MIN, holding 'n' members */
+static unsigned int deque__round(unsigned int n){
+	unsigned int cap = ULIB_DEQUE_MIN;
+	while(cap < n){
+		if(cap > (unsigned int)-1 / 2) return 0;
+		cap *= 2;
+	}
+	return cap;
+}
+
+/* Makes room for 'n' more members */
+static deque* deque__grow(deque* q, unsigned int n){
+	unsigned int cap;
+	if(q->cap - q->len >= n) return q;
+	if(n > (unsigned int)-1 - q->len) return NULL;
+	cap = deque__round(q->len + n);
+	if(!cap) return NULL;
+	/* Both are powers of two, so doubling keeps room for len + n */
+	if(cap < q->cap*2 && q->cap <= (unsigned int)-1 / 2) cap = q->cap*2;
+	return deque__set_cap(q, cap);
+}
+
+unsigned int deque__length(deque* q){
+	return q->len;
+}
+
+unsigned int deque__capacity(deque* q){
+	return q->cap;
+}
+
+unsigned int deque__elem_size(deque* q){
+	return q->dtype;
+}
+
+/* Returns member 'i' counting from the front, or NULL if out of range */
+void* deque__at(deque* q, unsigned int i){
+	if(i >= q->len) return NULL;
+	return DEQUE__AT(q, i);
+}
+
+void* deque__front(deque* q){
+	if(q->len == 0) return NULL;
+	return DEQUE__SLOT(q, q->head);
+}
+
+void* deque__back(deque* q){
+	if(q->len == 0) return NULL;
+	return DEQUE__AT(q, q->len-1);
+}
+
+/*
+Returns member 'i' and stores in 'n' how many members, from it on,
+are contiguous in memory. Returns NULL (and 0 in 'n') past the end.
+*/
+void* deque__span(deque* q, unsigned int i, unsigned int* n){
+	unsigned int k;
+	if(i >= q->len){
+		*n = 0;
+		return NULL;
+	}
+	k = (q->head + i) & (q->cap - 1);
+	*n = q->cap - k < q->len - i ? q->cap - k : q->len - i;
+	return DEQUE__SLOT(q, k);
+}
+
+/* Bytes taken by the deque and its buffer */
+unsigned int deque__mem(deque* q){
+	if(!q) return 0;
+	return sizeof(deque) + q->cap*q->dtype;
+}
+
+deque* deque__set(deque* q, unsigned int i, const void* src){
+	if(i >= q->len) return NULL;
+	ULIB_MEMCPY(DEQUE__AT(q, i), src, q->dtype);
+	return q;
+}
+
+/* Appends an uninitialised member and returns it, or NULL on failure */
+void* deque__emplace_back(deque* q){
+	if(q->len == q->cap && !deque__grow(q, 1)) return NULL;
+	return DEQUE__AT(q, q->len++);
+}
+
+/* Prepends an uninitialised member and returns it, or NULL on failure */
+void* deque__emplace_front(deque* q){
+	if(q->len == q->cap && !deque__grow(q, 1)) return NULL;
+	q->head = (q->head - 1) & (q->cap - 1);
+	q->len++;
+	return DEQUE__SLOT(q, q->head);
+}
+
+/*
+Makes room for one more member and returns 'src', which may point
+into the deque and so is re-derived if the storage moves.
+Returns NULL on failure.
+*/
+static const void* deque__grow_from(deque* q, const void* src){
+	const char* p = (const char*)src;
+	unsigned int i, rem;
+	if(q->len < q->cap) return src;
+	if(!q->d || p < q->d || p >= q->d + (size_t)q->cap*q->dtype){
+		return deque__grow(q, 1) ? src : NULL;
+	}
+	/* Full, so every slot is a member: keep its index and the offset into it */
+	i = (unsigned int)((size_t)(p - q->d) / q->dtype);
+	rem = (unsigned int)((size_t)(p - q->d) % q->dtype);
+	i = (i - q->head) & (q->cap - 1);
+	if(!deque__grow(q, 1)) return NULL;
+	return DEQUE__AT(q, i) + rem;
+}
+
+/* Appends a copy of 'src', which may be a member of 'q' */
+deque* deque__push_back(deque* q, const void* src){
+	void* dest;
+	src = deque__grow_from(q, src);
+	if(!src) return NULL;
+	dest = deque__emplace_back(q);
+	if(!dest) return NULL;
+	ULIB_MEMCPY(dest, src, q->dtype);
+	return q;
+}
+
+/* Prepends a copy of 'src', which may be a member of 'q' */
+deque* deque__push_front(deque* q, const void* src){
+	void* dest;
+	src = deque__grow_from(q, src);
+	if(!src) return NULL;
+	dest = deque__emplace_front(q);
+	if(!dest) return NULL;
+	ULIB_MEMCPY(dest, src, q->dtype);
+	return q;
+}
+
+/* Removes the last member, copying it to 'dest' unless NULL */
+deque* deque__pop_back(deque* q, void* dest){
+	if(q->len == 0) return NULL;
+	q->len--;
+	if(dest) ULIB_MEMCPY(dest, DEQUE__AT(q, q->len), q->dtype);
+	return q;
+}
+
+/* Removes the first member, copying it to 'dest' unless NULL */
+deque* deque__pop_front(deque* q, void* dest){
+	if(q->len == 0) return NULL;
+	if(dest) ULIB_MEMCPY(dest, DEQUE__SLOT(q, q->head), q->dtype);
+	q->head = (q->head + 1) & (q->cap - 1);
+	q->len--;
+	return q;
+}
+
+/* Appends 'n' members from 'src' */
+deque* deque__push_back_array(deque* q, const void* src, unsigned int n){
+	unsigned int k, first;
+	if(n == 0) return q;
+	if(!deque__grow(q, n)) return NULL;
+	k = (q->head + q->len) & (q->cap - 1);
+	first = q->cap - k < n ? q->cap - k : n;
+	ULIB_MEMCPY(DEQUE__SLOT(q, k), src, first*q->dtype);
+	if(n > first) ULIB_MEMCPY(q->d, (const char*)src + first*q->dtype, (n - first)*q->dtype);
+	q->len += n;
+	return q;
+}
+
+/* Removes up to 'n' members from the front into 'dest' (unless NULL), returns how many */
+unsigned int deque__pop_front_array(deque* q, void* dest, unsigned int n){
+	unsigned int first;
+	if(n > q->len) n = q->len;
+	if(n == 0) return 0;
+	first = q->cap - q->head < n ? q->cap - q->head : n;
+	if(dest){
+		ULIB_MEMCPY(dest, DEQUE__SLOT(q, q->head), first*q->dtype);
+		if(n > first) ULIB_MEMCPY((char*)dest + first*q->dtype, q->d, (n - first)*q->dtype);
+	}
+	q->head = (q->head + n) & (q->cap - 1);
+	q->len -= n;
+	return n;
+}
+
+/* Ensures room for 'cap' members without changing the length */
+deque* deque__reserve(deque* q, unsigned int cap){
+	if(cap <= q->cap) return q;
+	return deque__grow(q, cap - q->len);
+}
+
+/* Empties the deque, keeping its buffer */
+deque* deque__clear(deque* q){
+	q->head = 0;
+	q->len = 0;
+	return q;
+}
+
+/* Shrinks the buffer to the smallest power of two that holds the members */
+deque* deque__shrink_to_fit(deque* q){
+	unsigned int cap = q->len ? deque__round(q->len) : 0;
+	if(cap >= q->cap) return q;
+	return deque__set_cap(q, cap);
+}
+
+void deque__free(deque* q){
+	if(!q) return;
+	if(q->d) ulib__dealloc(q->alloc, q->d, q->cap*q->dtype, ULIB_TAG_DEQUE);
+	ulib__dealloc(q->alloc, q, sizeof(deque), ULIB_TAG_DEQUE);
+}
+
+#endif /* DEQUE_IMPLEMENTATION */
@@ -7,6 +7,7 @@
 	####################
 
 	Doubly linked list implementation in C89.
+	Nodes and small payloads are recycled through a pool (pool.h).
 
 	Structs
 	-------
@@ -19,6 +20,7 @@
 	Methods
 	-------
 	new_list()
+	list_new_alloc(allocator)
 	list->begin()
 	list->end()
 	list->next()
@@ -47,6 +49,11 @@
 #include "types.h" /* types.h already includes defs.h */
 #endif
 
+#ifndef POOL_IMPLEMENTATION
+#define POOL_IMPLEMENTATION
+#include "pool.h"
+#endif
+
 typedef struct list__node_struct list_node;
 struct list__node_struct {
 	list_node* next;
@@ -56,32 +63,49 @@ struct list__node_struct {
 };
 
 typedef struct list__methods_struct list;
+
+/* List methods, shared by every list under ULIB_SHARED_VTABLE (defs.h) */
+#define LIST__METHODS \
+	unsigned int (*length) (list*); \
+	list_node*   (*begin)  (list*); \
+	list_node*   (*end)    (list*); \
+	list_node*   (*next)   (list*); \
+	list_node*   (*prev)   (list*); \
+	list_node*   (*at)     (list*, unsigned int); \
+	list_node*   (*set)    (list*, unsigned int, unsigned int, void*); \
+	void*        (*get)    (list*, unsigned int, unsigned int*); \
+	int          (*empty)  (list*); \
+	unsigned int (*bytes)  (list*); \
+	list*        (*append) (list*, unsigned int, void*); \
+	list*        (*insert) (list*, unsigned int, unsigned int, void*); \
+	list*        (*pop)    (list*); \
+	list*        (*remove) (list*, unsigned int); \
+	list*        (*clear)  (list*); \
+	void         (*free)   (list*);
+
+typedef struct list__vtable_struct list_vtable;
+struct list__vtable_struct {
+	LIST__METHODS
+};
+
 struct list__methods_struct {
 	list_node* curr;
 	list_node* head;
+	const ulib_allocator* alloc;
+	pool* nodes; /* nodes and small payloads */
+#ifdef ULIB_SHARED_VTABLE
+	const list_vtable* vt;
+#else
 	/* Methods */
-	unsigned int (*length) (list*);
-	list_node*   (*begin)  (list*);
-	list_node*   (*end)    (list*);
-	list_node*   (*next)   (list*);
-	list_node*   (*prev)   (list*);
-	list_node*   (*at)     (list*, unsigned int);
-	list_node*   (*set)    (list*, unsigned int, unsigned int, void*);
-	void*        (*get)    (list*, unsigned int, unsigned int*);
-	int          (*empty)  (list*);
-	unsigned int (*bytes)  (list*);
-	list*        (*append) (list*, unsigned int, void*);
-	list*        (*insert) (list*, unsigned int, unsigned int, void*);
-	list*        (*pop)    (list*);
-	list*        (*remove) (list*, unsigned int);
-	list*        (*clear)  (list*);
-	void         (*free)   (list*);
+	LIST__METHODS
+#endif
 };
 
 
 /* Function Definitions */
 
 list* list_new();
+list* list_new_alloc(const ulib_allocator* alloc);
 
 unsigned int list__length(list* lst);
 list_node* list__begin(list* lst);
@@ -109,14 +133,54 @@ void list__debug(list* lst);
 
 #ifdef LIST_IMPLEMENTATION
 
+#ifdef ULIB_SHARED_VTABLE
+/* In the order of LIST__METHODS */
+static const list_vtable list__methods = {
+	list__length,
+	list__begin,
+	list__end,
+	list__next,
+	list__prev,
+	list__at,
+	list__set,
+	list__get,
+	list__empty,
+	list__bytes,
+	list__append,
+	list__insert,
+	list__pop,
+	list__remove,
+	list__clear,
+	list__free
+};
+#endif
+
 list* list_new(){
-	list* lst = ULIB_MALLOC(sizeof(list));
+	return list_new_alloc(NULL);
+}
+
+/* As list_new, taking all memory from 'alloc' (NULL for the default).
+Nodes and payloads up to ULIB_POOL_MAX bytes are recycled through a pool. */
+list* list_new_alloc(const ulib_allocator* alloc){
+	list* lst;
+	if(!alloc) alloc = &ulib_default_allocator;
+	lst = ulib__alloc(alloc, sizeof(list), ULIB_TAG_LIST);
 	if(!lst) return NULL;
+	lst->nodes = pool_new_alloc(alloc);
+	if(!lst->nodes){
+		ulib__dealloc(alloc, lst, sizeof(list), ULIB_TAG_LIST);
+		return NULL;
+	}
+	lst->nodes->tag = ULIB_TAG_LIST;
 
 	/* Start with no nodes */
 	lst->head = NULL;
 	lst->curr = NULL;
+	lst->alloc = alloc;
 
+#ifdef ULIB_SHARED_VTABLE
+	lst->vt = &list__methods;
+#else
 	/* Function pointers */
 	lst->begin = list__begin;
 	lst->end = list__end;
@@ -134,6 +198,7 @@ list* list_new(){
 	lst->remove = list__remove;
 	lst->clear = list__clear;
 	lst->free = list__free;
+#endif
 	return lst;
 }
 
@@ -177,7 +242,7 @@ list_node* list__at(list* lst, unsigned int where){
 unsigned int list__length(list* lst){
 	if (lst->head == NULL) return 0;
 	unsigned int i = 0;
-	list_node* b = lst->begin(lst);
+	list_node* b = list__begin(lst);
 	while(b){
 		b = b->next;
 		i++;
@@ -203,7 +268,7 @@ unsigned int list__bytes(list* lst){
 
 list_node* list__set(struct list__methods_struct* lst, unsigned int where, unsigned int type, void* data){
 	/* seek item */
-	list_node* n = lst->at(lst, where);
+	list_node* n = list__at(lst, where);
 	if(!n) return NULL;
 	/* calculate memory */
 	unsigned int size;
@@ -213,7 +278,7 @@ list_node* list__set(struct list__methods_struct* lst, unsigned int where, unsig
 	}
 	else size = types__sizes[type];
 	/* request new memory */
-	void* ndata = ULIB_REALLOC(n->data, size);
+	void* ndata = pool__realloc(lst->nodes, n->data, n->size, size);
 	if(!ndata) return NULL;
 	/* save new data in node */
 	n->data = ndata;
@@ -224,7 +289,7 @@ list_node* list__set(struct list__methods_struct* lst, unsigned int where, unsig
 }
 
 void* list__get(struct list__methods_struct* lst, unsigned int where, unsigned int* ret_type){
-	list_node* n = lst->at(lst, where);
+	list_node* n = list__at(lst, where);
 	if(!n) return NULL;
 	*ret_type = n->type;
 	return n->data;
@@ -232,19 +297,19 @@ void* list__get(struct list__methods_struct* lst, unsigned int where, unsigned i
 
 list* list__append(list* lst, unsigned int type, void* data){	
 	/* list->insert at the end of the list */
-	unsigned int len = lst->length(lst);
-	return lst->insert(lst, len, type, data);
+	unsigned int len = list__length(lst);
+	return list__insert(lst, len, type, data);
 }
 
 
 list* list__insert(list* lst, unsigned int where, unsigned int type, void* data){
 	/* seeking neighbour nodes */
-	list_node* n = lst->at(lst, where);
+	list_node* n = list__at(lst, where);
 	list_node *p;
 	if(n) p = n->prev;
-	else  p = lst->end(lst);
+	else  p = list__end(lst);
 	/* creating new node */
-	list_node* c = ULIB_MALLOC(sizeof(list_node));
+	list_node* c = pool__alloc(lst->nodes, sizeof(list_node));
 	if(!c) return NULL;
 	/* re-linking */
 	c->next = n;
@@ -254,18 +319,19 @@ list* list__insert(list* lst, unsigned int where, unsigned int type, void* data)
 	if(n) n->prev = c;
 	/* saving data */
 	c->data = NULL;
-	if( lst->set(lst,where,type,data) == NULL ) return NULL;
+	c->size = 0;
+	if( list__set(lst,where,type,data) == NULL ) return NULL;
 	return lst;
 }
 
 
 list* list__pop(list* lst){
-	return list__remove(lst, lst->length(lst)-1);
+	return list__remove(lst, list__length(lst)-1);
 }
 
 list* list__remove(list* lst, unsigned int where){
 	/* seek item */
-	list_node* c = lst->at(lst, where);
+	list_node* c = list__at(lst, where);
 	if(!c) return NULL;
 	/* unlink */
 	list_node *p = c->prev;
@@ -274,21 +340,28 @@ list* list__remove(list* lst, unsigned int where){
 	else lst->head = n;
 	if(n) n->prev = p;
 
-	free(c->data);
-	free(c);
+	pool__release(lst->nodes, c->data, c->size);
+	pool__release(lst->nodes, c, sizeof(list_node));
 	return lst;
 }
 
+/* Drops every node at once, releasing only the payloads the pool does not hold */
 list* list__clear(list* lst){
-	while(lst->head) lst->pop(lst);
+	list_node* c;
+	for(c = lst->head; c; c = c->next){
+		if(c->size > ULIB_POOL_MAX) pool__release(lst->nodes, c->data, c->size);
+	}
+	pool__clear(lst->nodes);
+	lst->head = NULL;
+	lst->curr = NULL;
 	return lst;
 }
 
 
 void list__debug(list* lst){
 	ULIB_PRINTF(" ----- LIST DEBUG -----\n");
-	ULIB_PRINTF(" Size: %u bytes\n", lst->bytes(lst));
-	unsigned int i=0, len=lst->length(lst);
+	ULIB_PRINTF(" Size: %u bytes\n", list__bytes(lst));
+	unsigned int i=0, len=list__length(lst);
 	ULIB_PRINTF(" Length: %u items\n", len);
 	list_node* c = lst->head;
 	while(c){
@@ -302,18 +375,9 @@ void list__debug(list* lst){
 }
 
 void list__free(list* lst){
-	if (lst->head == NULL){
-		ULIB_FREE(lst);
-		return;
-	}
-	list_node* c = lst->end(lst);
-	while(c->prev){
-		ULIB_FREE(c->data);
-		c = c->prev;
-		ULIB_FREE(c->next);
-	}
-	ULIB_FREE(c);
-	ULIB_FREE(lst);
+	list__clear(lst);
+	pool__free(lst->nodes);
+	ulib__dealloc(lst->alloc, lst, sizeof(list), ULIB_TAG_LIST);
 }
 
 #endif /* LIST_IMPLEMENTATION */
\ No newline at end of file
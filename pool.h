@@ -0,0 +1,308 @@
+/*
+
+--- pool.h ---
+
+Header-only library that adds the pool (slab) allocator.
+Small objects are carved out of chunks of memory and recycled
+through one free list per size class, so allocating and freeing
+them is a couple of pointer moves instead of a call to malloc.
+
+Size classes are powers of two from ULIB_POOL_MIN (16 bytes) up to
+ULIB_POOL_MAX (256 bytes by default). Larger requests are passed
+on to the parent allocator. Chunks start small and double in size
+until they reach ULIB_POOL_CHUNK bytes (one page), so pools that
+only ever hold a few objects stay cheap.
+
+Lists use a pool for their nodes and small payloads. It may also be
+used directly, or given to any container through its allocator:
+	pool* p = pool_new();
+	void* a = p->alloc(p, 24);
+	p->release(p, a, 24);
+	vector* v = vector_new_alloc(sizeof(int), &p->allocator);
+	...
+	p->free(p);
+
+Unlike malloc, the size of an object must be given back on release,
+which is what lets the pool find its size class without a header.
+A pool is not thread safe; give each thread its own.
+
+In order to use the functions from this library, write:
+	#define POOL_IMPLEMENTATION
+and THEN include the library:
+	#include "pool.h"
+
+Standard: ANSI C89
+
+
+VERSIONS
+
+v0.1
+	- Basics: pool_new, pool_new_alloc, free
+	- Objects: alloc, realloc, release, allocator (for containers)
+	- Whole pool: clear, bytes
+
+*/
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		HEADER
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifndef POOL_H
+#define POOL_H 1
+
+#ifndef DEFS_IMPLEMENTATION
+#define DEFS_IMPLEMENTATION
+#include "defs.h"
+#endif
+
+/* Smallest size class, also the alignment of every object */
+#ifndef ULIB_POOL_MIN
+	#define ULIB_POOL_MIN 16
+#endif
+
+/* Number of size classes, each twice the previous one */
+#ifndef ULIB_POOL_CLASSES
+	#define ULIB_POOL_CLASSES 5
+#endif
+
+/* Largest object served by the pool itself */
+#define ULIB_POOL_MAX (ULIB_POOL_MIN << (ULIB_POOL_CLASSES-1))
+
+/* Largest chunk size, in bytes */
+#ifndef ULIB_POOL_CHUNK
+	#define ULIB_POOL_CHUNK ULIB_PAGE_BYTES
+#endif
+
+/* Objects in the first chunk of each class */
+#ifndef ULIB_POOL_FIRST
+	#define ULIB_POOL_FIRST 8
+#endif
+
+
+/*
+ *	DATA STRUCTURES & MACROS
+ */
+
+typedef struct pool__chunk_struct pool_chunk;
+struct pool__chunk_struct {
+	pool_chunk* next;
+	unsigned int bytes; /* including this header */
+};
+
+typedef struct pool__struct pool;
+struct pool__struct {
+	void* free_list[ULIB_POOL_CLASSES];  /* recycled objects per class */
+	unsigned int grow[ULIB_POOL_CLASSES]; /* objects in the next chunk */
+	pool_chunk* chunks;
+	const ulib_allocator* parent;         /* chunks and large objects */
+	unsigned int tag;                     /* ULIB_TAG_* of the owner */
+	ulib_allocator allocator;             /* hands out memory from this pool */
+
+	/* Methods */
+	void*        (*alloc)   (pool*, unsigned int bytes);
+	void*        (*realloc) (pool*, void* ptr, unsigned int old_bytes, unsigned int new_bytes);
+	void         (*release) (pool*, void* ptr, unsigned int bytes);
+	void         (*clear)   (pool*);
+	unsigned int (*bytes)   (pool*);
+	void         (*free)    (pool*);
+};
+
+
+/*
+ *	FUNCTION DECLARATIONS
+ */
+
+pool* pool_new();
+pool* pool_new_alloc(const ulib_allocator* parent);
+
+void* pool__alloc(pool* p, unsigned int bytes);
+void* pool__realloc(pool* p, void* ptr, unsigned int old_bytes, unsigned int new_bytes);
+void pool__release(pool* p, void* ptr, unsigned int bytes);
+void pool__clear(pool* p);
+unsigned int pool__bytes(pool* p);
+void pool__free(pool* p);
+
+#endif /* POOL_H */
+
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		IMPLEMENTATION
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifdef POOL_IMPLEMENTATION
+
+/* Header size, rounded so that objects stay aligned */
+#define POOL__HEADER ((sizeof(pool_chunk) + ULIB_POOL_MIN-1) & ~(unsigned int)(ULIB_POOL_MIN-1))
+
+/* Size class serving 'bytes' (which must be at most ULIB_POOL_MAX) */
+static unsigned int pool__class(unsigned int bytes){
+	unsigned int c = 0, size = ULIB_POOL_MIN;
+	while(size < bytes){
+		size <<= 1;
+		c++;
+	}
+	return c;
+}
+
+/* ulib_allocator callbacks */
+
+static void* pool__allocator_alloc(void* ctx, unsigned int bytes){
+	return pool__alloc(ctx, bytes);
+}
+
+static void* pool__allocator_realloc(void* ctx, void* ptr, unsigned int old_bytes, unsigned int new_bytes){
+	return pool__realloc(ctx, ptr, old_bytes, new_bytes);
+}
+
+static void pool__allocator_free(void* ctx, void* ptr, unsigned int bytes){
+	pool__release(ctx, ptr, bytes);
+}
+
+pool* pool_new(){
+	return pool_new_alloc(NULL);
+}
+
+/* As pool_new, taking its chunks from 'parent' (NULL for the default) */
+pool* pool_new_alloc(const ulib_allocator* parent){
+	pool* p;
+	unsigned int c;
+	if(!parent) parent = &ulib_default_allocator;
+	p = ulib__alloc(parent, sizeof(pool), ULIB_TAG_POOL);
+	if(!p) return NULL;
+
+	for(c=0; c!=ULIB_POOL_CLASSES; ++c){
+		p->free_list[c] = NULL;
+		p->grow[c] = ULIB_POOL_FIRST;
+	}
+	p->chunks = NULL;
+	p->parent = parent;
+	p->tag = ULIB_TAG_POOL;
+
+	p->allocator.alloc = pool__allocator_alloc;
+	p->allocator.realloc = pool__allocator_realloc;
+	p->allocator.free = pool__allocator_free;
+	p->allocator.ctx = p;
+
+	/* Methods */
+	p->alloc = pool__alloc;
+	p->realloc = pool__realloc;
+	p->release = pool__release;
+	p->clear = pool__clear;
+	p->bytes = pool__bytes;
+	p->free = pool__free;
+
+	return p;
+}
+
+/* Carves a new chunk into objects of class 'c' */
+static void* pool__refill(pool* p, unsigned int c){
+	unsigned int size = ULIB_POOL_MIN << c;
+	unsigned int n = p->grow[c], i;
+	pool_chunk* k;
+	char* obj;
+
+	k = ulib__alloc(p->parent, POOL__HEADER + n*size, p->tag);
+	if(!k) return NULL;
+	k->next = p->chunks;
+	k->bytes = POOL__HEADER + n*size;
+	p->chunks = k;
+	if(n*size < ULIB_POOL_CHUNK) p->grow[c] = n*2;
+
+	/* Thread the objects in address order */
+	obj = (char*)k + POOL__HEADER;
+	for(i=0; i!=n-1; ++i){
+		*(void**)(obj + i*size) = obj + (i+1)*size;
+	}
+	*(void**)(obj + i*size) = NULL;
+	p->free_list[c] = obj;
+	return obj;
+}
+
+void* pool__alloc(pool* p, unsigned int bytes){
+	unsigned int c;
+	void* obj;
+	if(bytes == 0) return NULL;
+	if(bytes > ULIB_POOL_MAX) return ulib__alloc(p->parent, bytes, p->tag);
+
+	c = pool__class(bytes);
+	obj = p->free_list[c];
+	if(!obj && !(obj = pool__refill(p, c))) return NULL;
+	p->free_list[c] = *(void**)obj;
+	return obj;
+}
+
+/* Resizes an object, which stays put while its size class does not change */
+void* pool__realloc(pool* p, void* ptr, unsigned int old_bytes, unsigned int new_bytes){
+	void* obj;
+	if(!ptr) return pool__alloc(p, new_bytes);
+	if(new_bytes == 0){
+		pool__release(p, ptr, old_bytes);
+		return NULL;
+	}
+	if(old_bytes > ULIB_POOL_MAX && new_bytes > ULIB_POOL_MAX){
+		return ulib__realloc(p->parent, ptr, old_bytes, new_bytes, p->tag);
+	}
+	if(old_bytes <= ULIB_POOL_MAX && new_bytes <= ULIB_POOL_MAX
+		&& pool__class(old_bytes) == pool__class(new_bytes)){
+		return ptr;
+	}
+
+	obj = pool__alloc(p, new_bytes);
+	if(!obj) return NULL;
+	ULIB_MEMCPY(obj, ptr, old_bytes < new_bytes ? old_bytes : new_bytes);
+	pool__release(p, ptr, old_bytes);
+	return obj;
+}
+
+/* Returns an object of 'bytes' bytes to its free list */
+void pool__release(pool* p, void* ptr, unsigned int bytes){
+	unsigned int c;
+	if(!ptr) return;
+	if(bytes > ULIB_POOL_MAX){
+		ulib__dealloc(p->parent, ptr, bytes, p->tag);
+		return;
+	}
+	c = pool__class(bytes);
+	*(void**)ptr = p->free_list[c];
+	p->free_list[c] = ptr;
+}
+
+/*
+Gives every chunk back to the parent allocator at once.
+Objects larger than ULIB_POOL_MAX are not tracked and must be released first.
+*/
+void pool__clear(pool* p){
+	pool_chunk *k = p->chunks, *n;
+	unsigned int c;
+	while(k){
+		n = k->next;
+		ulib__dealloc(p->parent, k, k->bytes, p->tag);
+		k = n;
+	}
+	p->chunks = NULL;
+	for(c=0; c!=ULIB_POOL_CLASSES; ++c){
+		p->free_list[c] = NULL;
+		p->grow[c] = ULIB_POOL_FIRST;
+	}
+}
+
+/* Bytes held in chunks, whether handed out or free */
+unsigned int pool__bytes(pool* p){
+	unsigned int n = 0;
+	pool_chunk* k;
+	for(k = p->chunks; k; k = k->next) n += k->bytes;
+	return n;
+}
+
+void pool__free(pool* p){
+	pool__clear(p);
+	ulib__dealloc(p->parent, p, sizeof(pool), ULIB_TAG_POOL);
+}
+
+#endif /* POOL_IMPLEMENTATION */
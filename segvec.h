@@ -0,0 +1,367 @@
+/*
+
+--- segvec.h ---
+
+Header-only library that adds the segmented vector, a growable
+container of members of any size that never moves them.
+
+Members live in blocks whose sizes are powers of two: the first
+holds ULIB_SEGVEC_FIRST members, and every new block twice as
+many as the one before. Growing allocates one more block and leaves
+the rest in place, so a pointer to a member stays valid until the
+member is popped or the segvec freed, and nothing is ever copied.
+Member i sits in block log2(i + FIRST) - log2(FIRST), which takes
+a single bit scan to find, so indexing stays O(1).
+
+	segvec* s = segvec_new( sizeof(T) );
+	T* p = s->emplace(s);         (p stays valid as 's' grows)
+	s->push(s, &x);
+	T* q = s->at(s, i);
+	...
+	s->free(s);
+
+Members are only contiguous within a block. To copy them in bulk,
+walk the blocks with span, which returns member i and how many
+members follow it in the same block:
+	for(i=0; (p = s->span(s, i, &n)); i += n) ...
+
+Popping keeps the blocks; shrink_to_fit releases those left empty.
+Growing is not thread safe, but members may be handed to other
+threads while the segvec grows.
+
+In order to use the functions from this library, write:
+	#define SEGVEC_IMPLEMENTATION
+and THEN include the library:
+	#include "segvec.h"
+
+Standard: ANSI C89
+
+
+VERSIONS
+
+v0.1
+	- Basics: segvec_new, segvec_new_alloc, free
+	- Members: at, set, push, emplace, pop, back, span
+	- Storage: length, capacity, elem_size, reserve, resize,
+	clear, shrink_to_fit, mem
+
+*/
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		HEADER
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifndef SEGVEC_H
+#define SEGVEC_H 1
+
+#ifndef DEFS_IMPLEMENTATION
+#define DEFS_IMPLEMENTATION
+#include "defs.h"
+#endif
+
+/* Members in the first block, a power of two */
+#ifndef ULIB_SEGVEC_FIRST
+	#define ULIB_SEGVEC_FIRST 16
+#endif
+
+/* Room for one block per bit of an index */
+#define SEGVEC__BLOCKS (sizeof(unsigned int)*8)
+
+
+/*
+ *	DATA STRUCTURES & MACROS
+ */
+
+typedef struct segvec__struct segvec;
+
+/* Segvec methods, shared by every segvec under ULIB_SHARED_VTABLE (defs.h) */
+#define SEGVEC__METHODS \
+	unsigned int (*length)(segvec*); \
+	unsigned int (*capacity)(segvec*); \
+	unsigned int (*elem_size)(segvec*); \
+	void* (*at)(segvec*, unsigned int); \
+	void* (*span)(segvec*, unsigned int, unsigned int*); \
+	unsigned int (*mem)(segvec*); \
+	segvec* (*set)(segvec*, unsigned int, const void*); \
+	segvec* (*push)(segvec*, const void*); \
+	void* (*emplace)(segvec*); \
+	segvec* (*pop)(segvec*, void*); \
+	void* (*back)(segvec*); \
+	segvec* (*reserve)(segvec*, unsigned int); \
+	segvec* (*resize)(segvec*, unsigned int); \
+	segvec* (*clear)(segvec*); \
+	segvec* (*shrink_to_fit)(segvec*); \
+	void (*free)(segvec*);
+
+typedef struct segvec__vtable_struct segvec_vtable;
+struct segvec__vtable_struct {
+	SEGVEC__METHODS
+};
+
+struct segvec__struct {
+	void* blocks[SEGVEC__BLOCKS]; /* block b holds ULIB_SEGVEC_FIRST << b members */
+	unsigned int len;
+	unsigned int nblocks;         /* blocks allocated */
+	unsigned int dtype;           /* bytes per member */
+	const ulib_allocator* alloc;
+
+	/* Methods */
+#ifdef ULIB_SHARED_VTABLE
+	const segvec_vtable* vt;
+#else
+	SEGVEC__METHODS
+#endif
+};
+
+
+/*
+ *	FUNCTION DECLARATIONS
+ */
+
+segvec* segvec_new(unsigned int bytes);
+segvec* segvec_new_alloc(unsigned int bytes, const ulib_allocator* alloc);
+
+unsigned int segvec__length(segvec* s);
+unsigned int segvec__capacity(segvec* s);
+unsigned int segvec__elem_size(segvec* s);
+void* segvec__at(segvec* s, unsigned int i);
+void* segvec__span(segvec* s, unsigned int i, unsigned int* n);
+unsigned int segvec__mem(segvec* s);
+segvec* segvec__set(segvec* s, unsigned int i, const void* src);
+segvec* segvec__push(segvec* s, const void* src);
+void* segvec__emplace(segvec* s);
+segvec* segvec__pop(segvec* s, void* dest);
+void* segvec__back(segvec* s);
+segvec* segvec__reserve(segvec* s, unsigned int cap);
+segvec* segvec__resize(segvec* s, unsigned int n);
+segvec* segvec__clear(segvec* s);
+segvec* segvec__shrink_to_fit(segvec* s);
+void segvec__free(segvec* s);
+
+#endif /* SEGVEC_H */
+
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		IMPLEMENTATION
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifdef SEGVEC_IMPLEMENTATION
+
+#ifdef ULIB_SHARED_VTABLE
+static const segvec_vtable segvec__methods = {
+	segvec__length,
+	segvec__capacity,
+	segvec__elem_size,
+	segvec__at,
+	segvec__span,
+	segvec__mem,
+	segvec__set,
+	segvec__push,
+	segvec__emplace,
+	segvec__pop,
+	segvec__back,
+	segvec__reserve,
+	segvec__resize,
+	segvec__clear,
+	segvec__shrink_to_fit,
+	segvec__free
+};
+#endif
+
+/* Index of the highest set bit of 'x', which must not be zero */
+static unsigned int segvec__log2(unsigned int x){
+#ifdef __GNUC__
+	return (unsigned int)(sizeof(unsigned int)*8 - 1) - (unsigned int)__builtin_clz(x);
+#else
+	unsigned int r = 0;
+	while(x >>= 1) r++;
+	return r;
+#endif
+}
+
+/* Members in block 'b', and in blocks 0 to b-1 */
+#define SEGVEC__BLOCK_LEN(b) ((unsigned int)ULIB_SEGVEC_FIRST << (b))
+#define SEGVEC__BLOCK_START(b) (SEGVEC__BLOCK_LEN(b) - ULIB_SEGVEC_FIRST)
+
+/* Blocks that fit before indices run out */
+#define SEGVEC__MAX_BLOCKS (SEGVEC__BLOCKS - segvec__log2(ULIB_SEGVEC_FIRST))
+
+/* Address of member 'i', which must be within the capacity */
+static char* segvec__ptr(segvec* s, unsigned int i){
+	unsigned int j = i + ULIB_SEGVEC_FIRST, h = segvec__log2(j);
+	return (char*)s->blocks[h - segvec__log2(ULIB_SEGVEC_FIRST)]
+		+ (size_t)(j - (1u << h))*s->dtype;
+}
+
+segvec* segvec_new(unsigned int bytes){
+	return segvec_new_alloc(bytes, NULL);
+}
+
+/* As segvec_new, taking its memory from 'alloc' (NULL for the default) */
+segvec* segvec_new_alloc(unsigned int bytes, const ulib_allocator* alloc){
+	segvec* s;
+	unsigned int b;
+	if(bytes == 0) return NULL;
+	if(!alloc) alloc = &ulib_default_allocator;
+	s = ulib__alloc(alloc, sizeof(segvec), ULIB_TAG_SEGVEC);
+	if(!s) return NULL;
+
+	/* Variables */
+	for(b=0; b!=SEGVEC__BLOCKS; ++b) s->blocks[b] = NULL;
+	s->len = 0;
+	s->nblocks = 0;
+	s->dtype = bytes;
+	s->alloc = alloc;
+#ifdef ULIB_SHARED_VTABLE
+	s->vt = &segvec__methods;
+#else
+	/* Methods */
+	s->length = segvec__length;
+	s->capacity = segvec__capacity;
+	s->elem_size = segvec__elem_size;
+	s->at = segvec__at;
+	s->span = segvec__span;
+	s->mem = segvec__mem;
+	s->set = segvec__set;
+	s->push = segvec__push;
+	s->emplace = segvec__emplace;
+	s->pop = segvec__pop;
+	s->back = segvec__back;
+	s->reserve = segvec__reserve;
+	s->resize = segvec__resize;
+	s->clear = segvec__clear;
+	s->shrink_to_fit = segvec__shrink_to_fit;
+	s->free = segvec__free;
+#endif
+	return s;
+}
+
+/* Allocates the next block, returns 0 if out of memory or indices */
+static int segvec__grow(segvec* s){
+	unsigned int b = s->nblocks;
+	if(b == SEGVEC__MAX_BLOCKS || SEGVEC__BLOCK_LEN(b) > (unsigned int)-1 / s->dtype) return 0;
+	s->blocks[b] = ulib__alloc(s->alloc, SEGVEC__BLOCK_LEN(b)*s->dtype, ULIB_TAG_SEGVEC);
+	if(!s->blocks[b]) return 0;
+	s->nblocks++;
+	return 1;
+}
+
+unsigned int segvec__length(segvec* s){
+	return s->len;
+}
+
+/* Members that fit in the allocated blocks */
+unsigned int segvec__capacity(segvec* s){
+	return SEGVEC__BLOCK_START(s->nblocks);
+}
+
+unsigned int segvec__elem_size(segvec* s){
+	return s->dtype;
+}
+
+/* Returns member 'i', or NULL if out of range */
+void* segvec__at(segvec* s, unsigned int i){
+	if(i >= s->len) return NULL;
+	return segvec__ptr(s, i);
+}
+
+/*
+Returns member 'i' and stores in 'n' how many members, from it on,
+are contiguous in memory. Returns NULL (and 0 in 'n') past the end.
+*/
+void* segvec__span(segvec* s, unsigned int i, unsigned int* n){
+	unsigned int end;
+	if(i >= s->len){
+		*n = 0;
+		return NULL;
+	}
+	end = SEGVEC__BLOCK_START(segvec__log2(i + ULIB_SEGVEC_FIRST) - segvec__log2(ULIB_SEGVEC_FIRST) + 1);
+	*n = (end < s->len ? end : s->len) - i;
+	return segvec__ptr(s, i);
+}
+
+/* Bytes taken by the segvec and its blocks */
+unsigned int segvec__mem(segvec* s){
+	if(!s) return 0;
+	return sizeof(segvec) + segvec__capacity(s)*s->dtype;
+}
+
+segvec* segvec__set(segvec* s, unsigned int i, const void* src){
+	if(i >= s->len) return NULL;
+	ULIB_MEMCPY(segvec__ptr(s, i), src, s->dtype);
+	return s;
+}
+
+segvec* segvec__push(segvec* s, const void* src){
+	void* dest = segvec__emplace(s);
+	if(!dest) return NULL;
+	ULIB_MEMCPY(dest, src, s->dtype);
+	return s;
+}
+
+/* Appends an uninitialised member and returns it, or NULL on failure */
+void* segvec__emplace(segvec* s){
+	if(s->len == segvec__capacity(s) && !segvec__grow(s)) return NULL;
+	return segvec__ptr(s, s->len++);
+}
+
+/* Removes the last member, copying it to 'dest' unless NULL */
+segvec* segvec__pop(segvec* s, void* dest){
+	if(s->len == 0) return NULL;
+	s->len--;
+	if(dest) ULIB_MEMCPY(dest, segvec__ptr(s, s->len), s->dtype);
+	return s;
+}
+
+/* Returns the last member, or NULL if empty */
+void* segvec__back(segvec* s){
+	if(s->len == 0) return NULL;
+	return segvec__ptr(s, s->len-1);
+}
+
+/* Ensures room for 'cap' members without changing the length */
+segvec* segvec__reserve(segvec* s, unsigned int cap){
+	while(segvec__capacity(s) < cap){
+		if(!segvec__grow(s)) return NULL;
+	}
+	return s;
+}
+
+/* Sets the length, leaving any new members uninitialised */
+segvec* segvec__resize(segvec* s, unsigned int n){
+	if(!segvec__reserve(s, n)) return NULL;
+	s->len = n;
+	return s;
+}
+
+/* Empties the segvec, keeping its blocks */
+segvec* segvec__clear(segvec* s){
+	s->len = 0;
+	return s;
+}
+
+/* Releases the blocks past the last member */
+segvec* segvec__shrink_to_fit(segvec* s){
+	unsigned int b;
+	while(s->nblocks && SEGVEC__BLOCK_START(s->nblocks-1) >= s->len){
+		b = --s->nblocks;
+		ulib__dealloc(s->alloc, s->blocks[b], SEGVEC__BLOCK_LEN(b)*s->dtype, ULIB_TAG_SEGVEC);
+		s->blocks[b] = NULL;
+	}
+	return s;
+}
+
+void segvec__free(segvec* s){
+	if(!s) return;
+	s->len = 0;
+	segvec__shrink_to_fit(s);
+	ulib__dealloc(s->alloc, s, sizeof(segvec), ULIB_TAG_SEGVEC);
+}
+
+#endif /* SEGVEC_IMPLEMENTATION */
@@ -0,0 +1,413 @@
+/*
+
+--- soa.h ---
+
+Header-only library that adds the struct-of-arrays container, which
+stores records column by column: every field of the schema gets its
+own contiguous buffer, so a scan over one field reads that field alone
+instead of striding over whole records.
+
+The schema lists the fields with their types.h ids, and their sizes
+in bytes, or 0 for the size of the type (TYPE_OTHER is a pointer).
+A field of any other size gives that size with TYPE_OTHER:
+
+	soa_field schema[] = {{TYPE_DOUBLE, 0}, {TYPE_INT, 0}, {TYPE_OTHER, 16}};
+	soa* s = soa_new(schema, 3);
+
+Rows are appended and read back with one pointer per field, in the
+order of the schema:
+
+	s->push(s, &ts, &id, tag);
+	s->gather(s, i, &ts, &id, tag);
+	double* p = s->at(s, i, 0);
+
+A column is a plain C array of length(s) members, so it may be handed
+straight to the array.h reduction kernels:
+
+	const double* ts = s->column(s, 0);
+	double total = array__kernels()->sum_db(ts, s->length(s));
+
+Appending may reallocate the columns, so pointers into them only last
+until the next push, reserve or resize.
+
+In order to use the functions from this library, write:
+	#define SOA_IMPLEMENTATION
+and THEN include the library:
+	#include "soa.h"
+
+Standard: ANSI C89
+
+
+VERSIONS
+
+v0.1
+	- Basics: soa_new, soa_new_alloc, free
+	- Rows: push, gather, pop
+	- Members: at, set, column
+	- Storage: length, capacity, fields, field_size, reserve,
+	resize, clear, mem
+
+*/
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		HEADER
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifndef SOA_H
+#define SOA_H 1
+
+#ifndef TYPES_IMPLEMENTATION
+#define TYPES_IMPLEMENTATION
+#include "types.h" /* types.h already includes defs.h */
+#endif
+
+/* Rows of the first allocation */
+#ifndef ULIB_SOA_MIN
+	#define ULIB_SOA_MIN 16
+#endif
+
+
+/*
+ *	DATA STRUCTURES & MACROS
+ */
+
+/* A field of the schema */
+typedef struct soa__field_struct soa_field;
+struct soa__field_struct {
+	unsigned int type;  /* types.h id */
+	unsigned int bytes; /* size of a member, or 0 for that of 'type' */
+};
+
+typedef struct soa__struct soa;
+
+/* Soa methods, shared by every soa under ULIB_SHARED_VTABLE (defs.h) */
+#define SOA__METHODS \
+	unsigned int (*length)(soa*); \
+	unsigned int (*capacity)(soa*); \
+	unsigned int (*fields)(soa*); \
+	unsigned int (*field_size)(soa*, unsigned int); \
+	void* (*column)(soa*, unsigned int); \
+	void* (*at)(soa*, unsigned int, unsigned int); \
+	soa* (*set)(soa*, unsigned int, unsigned int, const void*); \
+	soa* (*push)(soa*, ...); \
+	soa* (*gather)(soa*, unsigned int, ...); \
+	soa* (*pop)(soa*); \
+	soa* (*reserve)(soa*, unsigned int); \
+	soa* (*resize)(soa*, unsigned int); \
+	soa* (*clear)(soa*); \
+	unsigned int (*mem)(soa*); \
+	void (*free)(soa*);
+
+typedef struct soa__vtable_struct soa_vtable;
+struct soa__vtable_struct {
+	SOA__METHODS
+};
+
+struct soa__struct {
+	char** cols;        /* one buffer of 'cap' members per field */
+	soa_field* schema;  /* with the size of every field filled in */
+	unsigned int nfields;
+	unsigned int len;
+	unsigned int cap;
+	const ulib_allocator* alloc;
+
+	/* Methods */
+#ifdef ULIB_SHARED_VTABLE
+	const soa_vtable* vt;
+#else
+	SOA__METHODS
+#endif
+};
+
+
+/*
+ *	FUNCTION DECLARATIONS
+ */
+
+soa* soa_new(const soa_field* schema, unsigned int nfields);
+soa* soa_new_alloc(const soa_field* schema, unsigned int nfields, const ulib_allocator* alloc);
+
+unsigned int soa__length(soa* s);
+unsigned int soa__capacity(soa* s);
+unsigned int soa__fields(soa* s);
+unsigned int soa__field_size(soa* s, unsigned int f);
+void* soa__column(soa* s, unsigned int f);
+void* soa__at(soa* s, unsigned int row, unsigned int f);
+soa* soa__set(soa* s, unsigned int row, unsigned int f, const void* src);
+soa* soa__push(soa* s, ...);
+soa* soa__gather(soa* s, unsigned int row, ...);
+soa* soa__pop(soa* s);
+soa* soa__reserve(soa* s, unsigned int cap);
+soa* soa__resize(soa* s, unsigned int n);
+soa* soa__clear(soa* s);
+unsigned int soa__mem(soa* s);
+void soa__free(soa* s);
+
+#endif /* SOA_H */
+
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		IMPLEMENTATION
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifdef SOA_IMPLEMENTATION
+
+#ifdef ULIB_SHARED_VTABLE
+static const soa_vtable soa__methods = {
+	soa__length,
+	soa__capacity,
+	soa__fields,
+	soa__field_size,
+	soa__column,
+	soa__at,
+	soa__set,
+	soa__push,
+	soa__gather,
+	soa__pop,
+	soa__reserve,
+	soa__resize,
+	soa__clear,
+	soa__mem,
+	soa__free
+};
+#endif
+
+/* Copies a member. Most are too short for ULIB_MEMCPY to pay off. */
+static void soa__copy(char* d, const char* s, unsigned int n){
+	if(n > 16){
+		ULIB_MEMCPY(d, s, n);
+		return;
+	}
+	while(n--) *d++ = *s++;
+}
+
+/* Member 'row' of field 'f' */
+#define SOA__PTR(s, row, f) ((s)->cols[f] + (size_t)(row)*(s)->schema[f].bytes)
+
+soa* soa_new(const soa_field* schema, unsigned int nfields){
+	return soa_new_alloc(schema, nfields, NULL);
+}
+
+/*
+As soa_new, taking its memory from 'alloc' (NULL for the default).
+Returns NULL if the schema is empty, or a field has no known size.
+*/
+soa* soa_new_alloc(const soa_field* schema, unsigned int nfields, const ulib_allocator* alloc){
+	soa* s;
+	unsigned int f;
+	if(nfields == 0) return NULL;
+	for(f=0; f!=nfields; ++f){
+		if(schema[f].bytes == 0 && schema[f].type > TYPE_OTHER) return NULL;
+	}
+	if(!alloc) alloc = &ulib_default_allocator;
+	s = ulib__alloc(alloc, sizeof(soa), ULIB_TAG_SOA);
+	if(!s) return NULL;
+	s->schema = ulib__alloc(alloc, nfields*sizeof(soa_field), ULIB_TAG_SOA);
+	s->cols = ulib__alloc(alloc, nfields*sizeof(char*), ULIB_TAG_SOA);
+	if(!s->schema || !s->cols){
+		ulib__dealloc(alloc, s->schema, nfields*sizeof(soa_field), ULIB_TAG_SOA);
+		ulib__dealloc(alloc, s->cols, nfields*sizeof(char*), ULIB_TAG_SOA);
+		ulib__dealloc(alloc, s, sizeof(soa), ULIB_TAG_SOA);
+		return NULL;
+	}
+
+	/* Variables */
+	for(f=0; f!=nfields; ++f){
+		s->schema[f].type = schema[f].type;
+		s->schema[f].bytes = schema[f].bytes ? schema[f].bytes : types__sizes[schema[f].type];
+		s->cols[f] = NULL;
+	}
+	s->nfields = nfields;
+	s->len = 0;
+	s->cap = 0;
+	s->alloc = alloc;
+#ifdef ULIB_SHARED_VTABLE
+	s->vt = &soa__methods;
+#else
+	/* Methods */
+	s->length = soa__length;
+	s->capacity = soa__capacity;
+	s->fields = soa__fields;
+	s->field_size = soa__field_size;
+	s->column = soa__column;
+	s->at = soa__at;
+	s->set = soa__set;
+	s->push = soa__push;
+	s->gather = soa__gather;
+	s->pop = soa__pop;
+	s->reserve = soa__reserve;
+	s->resize = soa__resize;
+	s->clear = soa__clear;
+	s->mem = soa__mem;
+	s->free = soa__free;
+#endif
+	return s;
+}
+
+unsigned int soa__length(soa* s){
+	return s->len;
+}
+
+unsigned int soa__capacity(soa* s){
+	return s->cap;
+}
+
+/* Fields in the schema */
+unsigned int soa__fields(soa* s){
+	return s->nfields;
+}
+
+/* Bytes per member of field 'f', or 0 if there is no such field */
+unsigned int soa__field_size(soa* s, unsigned int f){
+	if(f >= s->nfields) return 0;
+	return s->schema[f].bytes;
+}
+
+/*
+Returns the members of field 'f', contiguous, one per row.
+Returns NULL if there is no such field, or no room yet.
+*/
+void* soa__column(soa* s, unsigned int f){
+	if(f >= s->nfields) return NULL;
+	return s->cols[f];
+}
+
+/* Returns field 'f' of row 'row', or NULL if out of range */
+void* soa__at(soa* s, unsigned int row, unsigned int f){
+	if(row >= s->len || f >= s->nfields) return NULL;
+	return SOA__PTR(s, row, f);
+}
+
+soa* soa__set(soa* s, unsigned int row, unsigned int f, const void* src){
+	if(row >= s->len || f >= s->nfields) return NULL;
+	soa__copy(SOA__PTR(s, row, f), src, s->schema[f].bytes);
+	return s;
+}
+
+/* Makes room for another row, doubling up to the most rows every field allows */
+static soa* soa__grow(soa* s){
+	unsigned int f, max = (unsigned int)-1;
+	unsigned int cap = s->cap ? s->cap*2 : ULIB_SOA_MIN;
+	for(f=0; f!=s->nfields; ++f){
+		if(max > (unsigned int)-1 / s->schema[f].bytes) max = (unsigned int)-1 / s->schema[f].bytes;
+	}
+	if(s->len >= max) return NULL;
+	if(cap < s->cap || cap > max) cap = max;
+	return soa__reserve(s, cap);
+}
+
+/*
+Appends a row, reading each field from the pointers that follow 's',
+one per field in the order of the schema. Returns NULL on failure.
+*/
+soa* soa__push(soa* s, ...){
+	ULIB_VA_LIST args;
+	unsigned int f;
+	if(s->len == s->cap && !soa__grow(s)) return NULL;
+	ULIB_VA_START(args, s);
+	for(f=0; f!=s->nfields; ++f){
+		soa__copy(SOA__PTR(s, s->len, f), ULIB_VA_ARG(args, const void*), s->schema[f].bytes);
+	}
+	ULIB_VA_END(args);
+	s->len++;
+	return s;
+}
+
+/*
+Copies row 'row' out to the pointers that follow it, one per field
+in the order of the schema. A NULL pointer skips its field.
+Returns NULL if out of range.
+*/
+soa* soa__gather(soa* s, unsigned int row, ...){
+	ULIB_VA_LIST args;
+	unsigned int f;
+	void* dest;
+	if(row >= s->len) return NULL;
+	ULIB_VA_START(args, row);
+	for(f=0; f!=s->nfields; ++f){
+		dest = ULIB_VA_ARG(args, void*);
+		if(dest) soa__copy(dest, SOA__PTR(s, row, f), s->schema[f].bytes);
+	}
+	ULIB_VA_END(args);
+	return s;
+}
+
+/* Removes the last row */
+soa* soa__pop(soa* s){
+	if(s->len == 0) return NULL;
+	s->len--;
+	return s;
+}
+
+/*
+Ensures room for 'cap' rows. Every column moves to a new buffer
+only once all of them are allocated, so a failure changes nothing.
+*/
+soa* soa__reserve(soa* s, unsigned int cap){
+	char** tmp;
+	unsigned int f, g;
+	if(cap <= s->cap) return s;
+	for(f=0; f!=s->nfields; ++f){
+		if(cap > (unsigned int)-1 / s->schema[f].bytes) return NULL;
+	}
+	tmp = ulib__alloc(s->alloc, s->nfields*sizeof(char*), ULIB_TAG_SOA);
+	if(!tmp) return NULL;
+	for(f=0; f!=s->nfields; ++f){
+		tmp[f] = ulib__alloc(s->alloc, cap*s->schema[f].bytes, ULIB_TAG_SOA);
+		if(!tmp[f]) break;
+	}
+	if(f == s->nfields){
+		for(g=0; g!=s->nfields; ++g){
+			if(s->len) ULIB_MEMCPY(tmp[g], s->cols[g], (size_t)s->len*s->schema[g].bytes);
+			ulib__dealloc(s->alloc, s->cols[g], s->cap*s->schema[g].bytes, ULIB_TAG_SOA);
+			s->cols[g] = tmp[g];
+		}
+		s->cap = cap;
+	}
+	else{
+		for(g=0; g!=f; ++g) ulib__dealloc(s->alloc, tmp[g], cap*s->schema[g].bytes, ULIB_TAG_SOA);
+	}
+	ulib__dealloc(s->alloc, tmp, s->nfields*sizeof(char*), ULIB_TAG_SOA);
+	return s->cap == cap ? s : NULL;
+}
+
+/* Sets the number of rows, leaving any new ones uninitialised */
+soa* soa__resize(soa* s, unsigned int n){
+	if(!soa__reserve(s, n)) return NULL;
+	s->len = n;
+	return s;
+}
+
+/* Removes every row, keeping the columns */
+soa* soa__clear(soa* s){
+	s->len = 0;
+	return s;
+}
+
+/* Bytes taken by the soa, its schema and its columns */
+unsigned int soa__mem(soa* s){
+	unsigned int f, bytes;
+	if(!s) return 0;
+	bytes = sizeof(soa) + s->nfields*(sizeof(soa_field) + sizeof(char*));
+	for(f=0; f!=s->nfields; ++f) bytes += s->cap*s->schema[f].bytes;
+	return bytes;
+}
+
+void soa__free(soa* s){
+	unsigned int f;
+	if(!s) return;
+	for(f=0; f!=s->nfields; ++f){
+		ulib__dealloc(s->alloc, s->cols[f], s->cap*s->schema[f].bytes, ULIB_TAG_SOA);
+	}
+	ulib__dealloc(s->alloc, s->cols, s->nfields*sizeof(char*), ULIB_TAG_SOA);
+	ulib__dealloc(s->alloc, s->schema, s->nfields*sizeof(soa_field), ULIB_TAG_SOA);
+	ulib__dealloc(s->alloc, s, sizeof(soa), ULIB_TAG_SOA);
+}
+
+#endif /* SOA_IMPLEMENTATION */
@@ -0,0 +1,1022 @@
+/*
+
+--- sort.h ---
+
+Header-only library with the sorting algorithms behind
+vector->sort and array->sort. They may also be called directly
+on any C array.
+
+sort_pdq sorts members of any size with a qsort-style comparator,
+using pattern-defeating quicksort (Orson Peters): quicksort on a
+median-of-3 (or ninther) pivot with insertion sort for short runs,
+a heapsort fallback once partitions keep coming out unbalanced,
+and detection of sorted runs and repeated keys, which then take
+linear time. It is not stable.
+
+sort_radix_int and sort_radix_db sort ints and doubles by their bits,
+one byte per pass, skipping the passes where every key has the same
+byte. They take a scratch buffer as large as the data from an
+allocator, and fall back to sort_pdq should it fail.
+Doubles sort as -NaN < -inf < ... < -0.0 < 0.0 < ... < inf < NaN.
+
+sort_parallel, sort_parallel_int and sort_parallel_db split large
+inputs into one bucket per thread around splitters drawn from a random
+sample, then sort every bucket on its own thread. Threads are only
+used when ULIB_THREADS is defined (link with -pthread); otherwise they
+are the sorts above.
+
+sort_lower_bound, sort_upper_bound and sort_equal_range find a key in
+sorted members by binary search, with _int and _db versions that
+compare directly. For large read-mostly data, sort_eytzinger copies
+sorted members into breadth-first (Eytzinger) order, where the members
+read by a search share few cache lines and can be prefetched some
+levels ahead; sort_eytzinger_lower_bound then searches that copy.
+
+	unsigned int i = sort_lower_bound_int(a, 3, 2);     (i == 1)
+
+	int a[] = {3, -1, 2};
+	sort_pdq(a, 3, sizeof(int), sort_cmp_int);
+	sort_radix_int(a, 3, NULL);
+
+In order to use the functions from this library, write:
+	#define SORT_IMPLEMENTATION
+and THEN include the library:
+	#include "sort.h"
+
+Standard: ANSI C89
+
+
+VERSIONS
+
+v0.1
+	- sort_pdq, with comparators sort_cmp_int and sort_cmp_db
+	- sort_radix_int, sort_radix_db
+	- sort_parallel, sort_parallel_int, sort_parallel_db (ULIB_THREADS)
+	- sort_lower_bound, sort_upper_bound, sort_equal_range
+	- sort_eytzinger, sort_eytzinger_lower_bound
+
+*/
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		HEADER
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifndef SORT_H
+#define SORT_H 1
+
+#ifndef DEFS_IMPLEMENTATION
+#define DEFS_IMPLEMENTATION
+#include "defs.h"
+#endif
+
+/* Runs shorter than this are insertion sorted */
+#ifndef ULIB_SORT_INSERTION
+	#define ULIB_SORT_INSERTION 24
+#endif
+
+/* Inputs shorter than this skip the radix passes */
+#ifndef ULIB_SORT_RADIX_MIN
+	#define ULIB_SORT_RADIX_MIN 64
+#endif
+
+/* Inputs shorter than this are sorted on the calling thread alone */
+#ifndef ULIB_SORT_PARALLEL_MIN
+	#define ULIB_SORT_PARALLEL_MIN 65536
+#endif
+
+/* Upper bound on the threads of a parallel sort, one bucket each */
+#ifndef ULIB_SORT_MAX_THREADS
+	#define ULIB_SORT_MAX_THREADS 64
+#endif
+#if ULIB_SORT_MAX_THREADS > 256
+	#error "ULIB_SORT_MAX_THREADS must be at most 256, as bucket numbers are bytes"
+#endif
+
+
+/*
+ *	DATA STRUCTURES & MACROS
+ */
+
+/* Negative, zero or positive as 'a' goes before, with or after 'b' */
+typedef int (*sort_cmp)(const void* a, const void* b);
+
+
+/*
+ *	FUNCTION DECLARATIONS
+ */
+
+void sort_pdq(void* base, unsigned int n, unsigned int size, sort_cmp cmp);
+void sort_radix_int(int* a, unsigned int n, const ulib_allocator* alloc);
+void sort_radix_db(double* a, unsigned int n, const ulib_allocator* alloc);
+
+void sort_parallel(void* base, unsigned int n, unsigned int size, sort_cmp cmp,
+	unsigned int threads, const ulib_allocator* alloc);
+void sort_parallel_int(int* a, unsigned int n, unsigned int threads, const ulib_allocator* alloc);
+void sort_parallel_db(double* a, unsigned int n, unsigned int threads, const ulib_allocator* alloc);
+
+/* Searching sorted members. Bounds are indices from 0 to n. */
+unsigned int sort_lower_bound(const void* base, unsigned int n, unsigned int size,
+	const void* key, sort_cmp cmp);
+unsigned int sort_upper_bound(const void* base, unsigned int n, unsigned int size,
+	const void* key, sort_cmp cmp);
+unsigned int sort_equal_range(const void* base, unsigned int n, unsigned int size,
+	const void* key, sort_cmp cmp, unsigned int* end);
+unsigned int sort_lower_bound_int(const int* a, unsigned int n, int key);
+unsigned int sort_upper_bound_int(const int* a, unsigned int n, int key);
+unsigned int sort_lower_bound_db(const double* a, unsigned int n, double key);
+unsigned int sort_upper_bound_db(const double* a, unsigned int n, double key);
+
+/* Eytzinger layout, and searches over it */
+void sort_eytzinger(const void* sorted, void* out, unsigned int n, unsigned int size);
+unsigned int sort_eytzinger_lower_bound(const void* eyt, unsigned int n, unsigned int size,
+	const void* key, sort_cmp cmp);
+unsigned int sort_eytzinger_lower_bound_int(const int* eyt, unsigned int n, int key);
+unsigned int sort_eytzinger_lower_bound_db(const double* eyt, unsigned int n, double key);
+
+int sort_cmp_int(const void* a, const void* b);
+int sort_cmp_db(const void* a, const void* b);
+
+#endif /* SORT_H */
+
+
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+		IMPLEMENTATION
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*/
+
+#ifdef SORT_IMPLEMENTATION
+
+#ifdef ULIB_THREADS
+	#include <pthread.h>
+	#include <unistd.h>
+#endif
+
+/* Partitions longer than this pick the ninther as pivot */
+#define SORT__NINTHER 128
+
+/* Members up to this size are insertion sorted by shifting */
+#define SORT__TMP 64
+
+/* Element moves allowed before a partial insertion sort gives up */
+#define SORT__PARTIAL_LIMIT 8
+
+#define SORT__AT(b, i) ((b) + (size_t)(i)*s)
+#define SORT__LESS(a, b) (cmp((a), (b)) < 0)
+
+int sort_cmp_int(const void* a, const void* b){
+	int x = *(const int*)a, y = *(const int*)b;
+	return (x > y) - (x < y);
+}
+
+int sort_cmp_db(const void* a, const void* b){
+	double x = *(const double*)a, y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+/* Swaps two members, a word at a time when they are aligned */
+static void sort__swap(char* a, char* b, unsigned int s){
+	if(((ULIB__ADDR(a) | ULIB__ADDR(b) | s) & ULIB__WMASK) == 0){
+		ulib__word *x = (ulib__word*)a, *y = (ulib__word*)b, t;
+		for(s /= ULIB__WSIZE; s; --s){
+			t = *x; *x++ = *y; *y++ = t;
+		}
+	}
+	else if(s == sizeof(int) && ((ULIB__ADDR(a) | ULIB__ADDR(b)) & (sizeof(int)-1)) == 0){
+		int t = *(int*)a;
+		*(int*)a = *(int*)b;
+		*(int*)b = t;
+	}
+	else{
+		char t;
+		for(; s; --s){
+			t = *a; *a++ = *b; *b++ = t;
+		}
+	}
+}
+
+/* Copies one member, a word at a time when aligned */
+static void sort__copy(char* a, const char* b, unsigned int s){
+	if(((ULIB__ADDR(a) | ULIB__ADDR(b) | s) & ULIB__WMASK) == 0){
+		ulib__word* x = (ulib__word*)a;
+		const ulib__word* y = (const ulib__word*)b;
+		for(s /= ULIB__WSIZE; s; --s) *x++ = *y++;
+	}
+	else if(s == sizeof(int) && ((ULIB__ADDR(a) | ULIB__ADDR(b)) & (sizeof(int)-1)) == 0){
+		*(int*)a = *(const int*)b;
+	}
+	else{
+		for(; s; --s) *a++ = *b++;
+	}
+}
+
+/*
+Insertion sort of [b, e). Members up to SORT__TMP bytes are held aside
+and the larger ones shifted up; bigger members are swapped down.
+*/
+static void sort__insertion(char* b, char* e, unsigned int s, sort_cmp cmp){
+	ulib__word tmp[SORT__TMP/sizeof(ulib__word)];
+	char *i, *j, *t = (char*)tmp;
+	if(s > SORT__TMP){
+		for(i = b + s; i < e; i += s){
+			for(j = i; j > b && SORT__LESS(j, j - s); j -= s) sort__swap(j, j - s, s);
+		}
+		return;
+	}
+	for(i = b + s; i < e; i += s){
+		if(!SORT__LESS(i, i - s)) continue;
+		sort__copy(t, i, s);
+		j = i;
+		do{
+			sort__copy(j, j - s, s);
+			j -= s;
+		} while(j > b && SORT__LESS(t, j - s));
+		sort__copy(j, t, s);
+	}
+}
+
+/* As sort__insertion, giving up (and returning 0) after a few moves */
+static int sort__partial_insertion(char* b, char* e, unsigned int s, sort_cmp cmp){
+	unsigned int moves = 0;
+	char *i, *j;
+	for(i = b + s; i < e; i += s){
+		for(j = i; j > b && SORT__LESS(j, j - s); j -= s){
+			sort__swap(j, j - s, s);
+			if(++moves > SORT__PARTIAL_LIMIT) return 0;
+		}
+	}
+	return 1;
+}
+
+static void sort__sort2(char* a, char* b, unsigned int s, sort_cmp cmp){
+	if(SORT__LESS(b, a)) sort__swap(a, b, s);
+}
+
+static void sort__sort3(char* a, char* b, char* c, unsigned int s, sort_cmp cmp){
+	sort__sort2(a, b, s, cmp);
+	sort__sort2(b, c, s, cmp);
+	sort__sort2(a, b, s, cmp);
+}
+
+static void sort__sift(char* b, unsigned int i, unsigned int n, unsigned int s, sort_cmp cmp){
+	unsigned int c;
+	while((c = 2*i + 1) < n){
+		if(c + 1 < n && SORT__LESS(SORT__AT(b, c), SORT__AT(b, c+1))) c++;
+		if(!SORT__LESS(SORT__AT(b, i), SORT__AT(b, c))) return;
+		sort__swap(SORT__AT(b, i), SORT__AT(b, c), s);
+		i = c;
+	}
+}
+
+static void sort__heap(char* b, unsigned int n, unsigned int s, sort_cmp cmp){
+	unsigned int i;
+	for(i = n/2; i-- > 0; ) sort__sift(b, i, n, s, cmp);
+	for(i = n; i-- > 1; ){
+		sort__swap(b, SORT__AT(b, i), s);
+		sort__sift(b, 0, i, s, cmp);
+	}
+}
+
+/*
+Partitions [b, e) around the pivot in *b, with the members equal to it
+on the right. The pivot needs a member no less than it after b.
+Returns where the pivot ends up, and sets '*done' if nothing had to move.
+*/
+static char* sort__partition_right(char* b, char* e, unsigned int s, sort_cmp cmp, int* done){
+	char *first = b, *last = e;
+
+	do first += s; while(SORT__LESS(first, b));
+	if(first - s == b){
+		while(first < last && !SORT__LESS(last -= s, b)) ;
+	}
+	else{
+		while(!SORT__LESS(last -= s, b)) ;
+	}
+	*done = first >= last;
+
+	while(first < last){
+		sort__swap(first, last, s);
+		do first += s; while(SORT__LESS(first, b));
+		do last -= s; while(!SORT__LESS(last, b));
+	}
+	sort__swap(b, first - s, s);
+	return first - s;
+}
+
+/*
+Partitions [b, e) around the pivot in *b, with the members equal to it
+on the left. Used when the pivot equals the member before b, so that
+the left side is already in place. Returns where the pivot ends up.
+*/
+static char* sort__partition_left(char* b, char* e, unsigned int s, sort_cmp cmp){
+	char *first = b, *last = e;
+
+	do last -= s; while(SORT__LESS(b, last));
+	if(last + s == e){
+		while(first < last && !SORT__LESS(b, first += s)) ;
+	}
+	else{
+		while(!SORT__LESS(b, first += s)) ;
+	}
+
+	while(first < last){
+		sort__swap(first, last, s);
+		do last -= s; while(SORT__LESS(b, last));
+		do first += s; while(!SORT__LESS(b, first));
+	}
+	sort__swap(b, last, s);
+	return last;
+}
+
+/* Swaps a few members of [b, e), 'n' long, to break up a bad pattern */
+static void sort__shuffle(char* b, char* e, unsigned int n, unsigned int s){
+	unsigned int q = n/4;
+	sort__swap(b, SORT__AT(b, q), s);
+	sort__swap(e - s, e - (size_t)q*s, s);
+	if(n > SORT__NINTHER){
+		sort__swap(SORT__AT(b, 1), SORT__AT(b, q+1), s);
+		sort__swap(SORT__AT(b, 2), SORT__AT(b, q+2), s);
+		sort__swap(e - 2*s, e - (size_t)(q+1)*s, s);
+		sort__swap(e - 3*s, e - (size_t)(q+2)*s, s);
+	}
+}
+
+/*
+Sorts [b, e). 'bad' is how many unbalanced partitions are left before
+switching to heapsort. 'leftmost' is 0 when the member before b is
+no greater than any in the range.
+*/
+static void sort__pdq_loop(char* b, char* e, unsigned int s, sort_cmp cmp, unsigned int bad, int leftmost){
+	unsigned int n, half, nl, nr;
+	char *pivot;
+	int done;
+
+	for(;;){
+		n = (unsigned int)((size_t)(e - b)/s);
+		if(n < ULIB_SORT_INSERTION){
+			sort__insertion(b, e, s, cmp);
+			return;
+		}
+
+		/* Median of 3 to *b, or the ninther for long runs */
+		half = n/2;
+		if(n > SORT__NINTHER){
+			sort__sort3(b, SORT__AT(b, half), e - s, s, cmp);
+			sort__sort3(SORT__AT(b, 1), SORT__AT(b, half-1), e - 2*s, s, cmp);
+			sort__sort3(SORT__AT(b, 2), SORT__AT(b, half+1), e - 3*s, s, cmp);
+			sort__sort3(SORT__AT(b, half-1), SORT__AT(b, half), SORT__AT(b, half+1), s, cmp);
+			sort__swap(b, SORT__AT(b, half), s);
+		}
+		else{
+			sort__sort3(SORT__AT(b, half), b, e - s, s, cmp);
+		}
+
+		/* Many copies of the pivot: they all go left, and are done with */
+		if(!leftmost && !SORT__LESS(b - s, b)){
+			b = sort__partition_left(b, e, s, cmp) + s;
+			continue;
+		}
+
+		pivot = sort__partition_right(b, e, s, cmp, &done);
+		nl = (unsigned int)((size_t)(pivot - b)/s);
+		nr = n - nl - 1;
+
+		if(nl < n/8 || nr < n/8){
+			if(--bad == 0){
+				sort__heap(b, n, s, cmp);
+				return;
+			}
+			if(nl >= ULIB_SORT_INSERTION) sort__shuffle(b, pivot, nl, s);
+			if(nr >= ULIB_SORT_INSERTION) sort__shuffle(pivot + s, e, nr, s);
+		}
+		else if(done && sort__partial_insertion(b, pivot, s, cmp)
+			&& sort__partial_insertion(pivot + s, e, s, cmp)){
+			return;
+		}
+
+		/* Recurse into the shorter side, loop on the longer one */
+		if(nl < nr){
+			sort__pdq_loop(b, pivot, s, cmp, bad, leftmost);
+			b = pivot + s;
+			leftmost = 0;
+		}
+		else{
+			sort__pdq_loop(pivot + s, e, s, cmp, bad, 0);
+			e = pivot;
+		}
+	}
+}
+
+/* Sorts 'n' members of 'size' bytes at 'base' in the order given by 'cmp' */
+void sort_pdq(void* base, unsigned int n, unsigned int size, sort_cmp cmp){
+	unsigned int bad = 1;
+	if(n < 2 || size == 0) return;
+	while(n >> bad) bad++;
+	sort__pdq_loop(base, (char*)base + (size_t)n*size, size, cmp, bad, 1);
+}
+
+/* Radix keys: unsigned, in the same order as the values */
+
+#define SORT__INT_SIGN (((unsigned int)-1 >> 1) + 1)
+#define SORT__LONG_SIGN (((unsigned long)-1 >> 1) + 1)
+
+#define SORT__INT_KEY(x) ((unsigned int)(x) ^ SORT__INT_SIGN)
+
+static unsigned long sort__db_key(double x){
+	union { double d; unsigned long u; } k;
+	k.d = x;
+	return (k.u & SORT__LONG_SIGN) ? ~k.u : (k.u | SORT__LONG_SIGN);
+}
+
+/* Turns byte counts into starting offsets, returns 0 if one byte holds every key */
+static int sort__offsets(unsigned int* count, unsigned int n){
+	unsigned int d, sum = 0, c;
+	for(d=0; d!=256; ++d){
+		c = count[d];
+		if(c == n) return 0;
+		count[d] = sum;
+		sum += c;
+	}
+	return 1;
+}
+
+static void sort__insertion_int(int* a, unsigned int n){
+	unsigned int i, j;
+	int x;
+	for(i=1; i<n; ++i){
+		x = a[i];
+		for(j=i; j && x < a[j-1]; --j) a[j] = a[j-1];
+		a[j] = x;
+	}
+}
+
+static void sort__insertion_db(double* a, unsigned int n){
+	unsigned int i, j;
+	double x;
+	unsigned long k;
+	for(i=1; i<n; ++i){
+		x = a[i];
+		k = sort__db_key(x);
+		for(j=i; j && k < sort__db_key(a[j-1]); --j) a[j] = a[j-1];
+		a[j] = x;
+	}
+}
+
+/*
+Radix sorts 'n' ints at 'a', using 'tmp' (as large) as scratch.
+Returns whichever of the two buffers holds the result.
+*/
+static int* sort__radix_int(int* a, int* tmp, unsigned int n){
+	unsigned int count[sizeof(int)][256];
+	unsigned int i, p, shift, k;
+	int *src = a, *dst = tmp, *swap;
+
+	if(n < ULIB_SORT_RADIX_MIN){
+		sort__insertion_int(a, n);
+		return a;
+	}
+
+	/* Every histogram in one read */
+	for(p=0; p!=sizeof(int); ++p){
+		for(k=0; k!=256; ++k) count[p][k] = 0;
+	}
+	for(i=0; i!=n; ++i){
+		k = SORT__INT_KEY(a[i]);
+		for(p=0; p!=sizeof(int); ++p, k >>= 8) count[p][k & 255]++;
+	}
+
+	for(p=0; p!=sizeof(int); ++p){
+		if(!sort__offsets(count[p], n)) continue;
+		shift = 8*p;
+		for(i=0; i!=n; ++i){
+			k = (SORT__INT_KEY(src[i]) >> shift) & 255;
+			dst[count[p][k]++] = src[i];
+		}
+		swap = src; src = dst; dst = swap;
+	}
+	return src;
+}
+
+/* As sort__radix_int, for doubles. Needs an unsigned long as large as a double. */
+static double* sort__radix_db(double* a, double* tmp, unsigned int n){
+	unsigned int count[sizeof(double)][256];
+	unsigned int i, p, shift, k;
+	unsigned long key;
+	double *src = a, *dst = tmp, *swap;
+
+	if(n < ULIB_SORT_RADIX_MIN){
+		sort__insertion_db(a, n);
+		return a;
+	}
+
+	for(p=0; p!=sizeof(double); ++p){
+		for(k=0; k!=256; ++k) count[p][k] = 0;
+	}
+	for(i=0; i!=n; ++i){
+		key = sort__db_key(a[i]);
+		for(p=0; p!=sizeof(double); ++p, key >>= 8) count[p][key & 255]++;
+	}
+
+	for(p=0; p!=sizeof(double); ++p){
+		if(!sort__offsets(count[p], n)) continue;
+		shift = 8*p;
+		for(i=0; i!=n; ++i){
+			k = (unsigned int)(sort__db_key(src[i]) >> shift) & 255;
+			dst[count[p][k]++] = src[i];
+		}
+		swap = src; src = dst; dst = swap;
+	}
+	return src;
+}
+
+/* Sorts 'n' ints, taking scratch memory from 'alloc' (NULL for the default) */
+void sort_radix_int(int* a, unsigned int n, const ulib_allocator* alloc){
+	int *tmp, *res;
+	if(n < ULIB_SORT_RADIX_MIN){
+		sort__insertion_int(a, n);
+		return;
+	}
+	if(!alloc) alloc = &ulib_default_allocator;
+	tmp = ulib__alloc(alloc, n*sizeof(int), ULIB_TAG_OTHER);
+	if(!tmp){
+		sort_pdq(a, n, sizeof(int), sort_cmp_int);
+		return;
+	}
+	res = sort__radix_int(a, tmp, n);
+	if(res != a) ULIB_MEMCPY(a, res, n*sizeof(int));
+	ulib__dealloc(alloc, tmp, n*sizeof(int), ULIB_TAG_OTHER);
+}
+
+/*
+Sorts 'n' doubles, taking scratch memory from 'alloc' (NULL for the default).
+Targets where unsigned long cannot hold a double use sort_pdq instead.
+*/
+void sort_radix_db(double* a, unsigned int n, const ulib_allocator* alloc){
+	double *tmp, *res;
+	if(sizeof(unsigned long) != sizeof(double)){
+		sort_pdq(a, n, sizeof(double), sort_cmp_db);
+		return;
+	}
+	if(n < ULIB_SORT_RADIX_MIN){
+		sort__insertion_db(a, n);
+		return;
+	}
+	if(!alloc) alloc = &ulib_default_allocator;
+	tmp = ulib__alloc(alloc, n*sizeof(double), ULIB_TAG_OTHER);
+	if(!tmp){
+		sort_pdq(a, n, sizeof(double), sort_cmp_db);
+		return;
+	}
+	res = sort__radix_db(a, tmp, n);
+	if(res != a) ULIB_MEMCPY(a, res, n*sizeof(double));
+	ulib__dealloc(alloc, tmp, n*sizeof(double), ULIB_TAG_OTHER);
+}
+
+/*
+ *	PARALLEL SAMPLE SORT
+ */
+
+/* What the members of a parallel sort are */
+#define SORT__ANY 0
+#define SORT__INT 1
+#define SORT__DB  2
+
+/* Samples drawn per bucket when choosing the splitters */
+#define SORT__OVERSAMPLE 32
+
+#ifdef ULIB_THREADS
+
+/* State shared by the workers of one parallel sort */
+struct sort__par {
+	char* base;             /* input, and output */
+	char* tmp;              /* members grouped by bucket */
+	unsigned char* bucket;  /* bucket of every member, hence ULIB_SORT_MAX_THREADS <= 256 */
+	char* splitters;        /* threads-1 members bounding the buckets */
+	unsigned int* count;    /* threads x threads: chunk t writes bucket b from count[t*threads+b] */
+	unsigned int* start;    /* bucket b spans start[b] to start[b+1] */
+	unsigned int n, size, threads, kind;
+	sort_cmp cmp;
+};
+
+struct sort__worker {
+	struct sort__par* par;
+	unsigned int id;
+};
+
+/* Members [lo,hi) of the chunk that thread 't' out of 'threads' classifies and scatters */
+static void sort__chunk(unsigned int n, unsigned int t, unsigned int threads,
+	unsigned int* lo, unsigned int* hi){
+	unsigned int q = n / threads, r = n % threads;
+	*lo = t*q + (t < r ? t : r);
+	*hi = *lo + q + (t < r);
+}
+
+/* Orders doubles as sort__radix_db does, NaNs included */
+static int sort__cmp_db_key(const void* a, const void* b){
+	unsigned long x = sort__db_key(*(const double*)a), y = sort__db_key(*(const double*)b);
+	return (x > y) - (x < y);
+}
+
+/* Phase 1: bucket of each member of a chunk, and the size of each bucket in it */
+static void* sort__classify(void* arg){
+	struct sort__worker* w = arg;
+	struct sort__par* p = w->par;
+	unsigned int* count = p->count + w->id*p->threads;
+	unsigned int i, lo, hi, l, h, m, s = p->size;
+
+	sort__chunk(p->n, w->id, p->threads, &lo, &hi);
+	for(i=0; i!=p->threads; ++i) count[i] = 0;
+
+	/* Bucket = number of splitters not greater than the member */
+	if(p->kind == SORT__INT){
+		const int* a = (const int*)p->base;
+		const int* sp = (const int*)p->splitters;
+		for(i=lo; i!=hi; ++i){
+			for(l=0, h=p->threads-1; l<h; ){
+				m = (l + h)/2;
+				if(a[i] < sp[m]) h = m; else l = m + 1;
+			}
+			p->bucket[i] = (unsigned char)l;
+			count[l]++;
+		}
+	}
+	else if(p->kind == SORT__DB){
+		const double* a = (const double*)p->base;
+		const double* sp = (const double*)p->splitters;
+		unsigned long k;
+		for(i=lo; i!=hi; ++i){
+			k = sort__db_key(a[i]);
+			for(l=0, h=p->threads-1; l<h; ){
+				m = (l + h)/2;
+				if(k < sort__db_key(sp[m])) h = m; else l = m + 1;
+			}
+			p->bucket[i] = (unsigned char)l;
+			count[l]++;
+		}
+	}
+	else{
+		for(i=lo; i!=hi; ++i){
+			const char* x = SORT__AT(p->base, i);
+			for(l=0, h=p->threads-1; l<h; ){
+				m = (l + h)/2;
+				if(p->cmp(x, SORT__AT(p->splitters, m)) < 0) h = m; else l = m + 1;
+			}
+			p->bucket[i] = (unsigned char)l;
+			count[l]++;
+		}
+	}
+	return NULL;
+}
+
+/* Phase 2: copies each member of a chunk to its bucket in 'tmp' */
+static void* sort__scatter(void* arg){
+	struct sort__worker* w = arg;
+	struct sort__par* p = w->par;
+	unsigned int* at = p->count + w->id*p->threads;
+	unsigned int i, lo, hi, s = p->size;
+
+	sort__chunk(p->n, w->id, p->threads, &lo, &hi);
+	if(p->kind == SORT__INT){
+		for(i=lo; i!=hi; ++i) ((int*)p->tmp)[at[p->bucket[i]]++] = ((int*)p->base)[i];
+	}
+	else if(p->kind == SORT__DB){
+		for(i=lo; i!=hi; ++i) ((double*)p->tmp)[at[p->bucket[i]]++] = ((double*)p->base)[i];
+	}
+	else{
+		for(i=lo; i!=hi; ++i) sort__copy(SORT__AT(p->tmp, at[p->bucket[i]]++), SORT__AT(p->base, i), s);
+	}
+	return NULL;
+}
+
+/* Phase 3: sorts one bucket back into its place in 'base' */
+static void* sort__bucket(void* arg){
+	struct sort__worker* w = arg;
+	struct sort__par* p = w->par;
+	unsigned int lo = p->start[w->id], m = p->start[w->id+1] - lo, s = p->size;
+
+	if(p->kind == SORT__INT){
+		int* a = (int*)p->base + lo;
+		int* r = sort__radix_int((int*)p->tmp + lo, a, m);
+		if(r != a) ULIB_MEMCPY(a, r, m*sizeof(int));
+	}
+	else if(p->kind == SORT__DB){
+		double* a = (double*)p->base + lo;
+		double* r = sort__radix_db((double*)p->tmp + lo, a, m);
+		if(r != a) ULIB_MEMCPY(a, r, m*sizeof(double));
+	}
+	else{
+		ULIB_MEMCPY(SORT__AT(p->base, lo), SORT__AT(p->tmp, lo), (size_t)m*s);
+		sort_pdq(SORT__AT(p->base, lo), m, s, p->cmp);
+	}
+	return NULL;
+}
+
+/* Runs 'fn' once per worker, each on its own thread but the first, which runs here */
+static void sort__run(void* (*fn)(void*), struct sort__worker* w, unsigned int threads){
+	pthread_t id[ULIB_SORT_MAX_THREADS];
+	int started[ULIB_SORT_MAX_THREADS];
+	unsigned int t;
+	for(t=1; t<threads; ++t) started[t] = pthread_create(&id[t], NULL, fn, &w[t]) == 0;
+	fn(&w[0]);
+	for(t=1; t<threads; ++t){
+		if(started[t]) pthread_join(id[t], NULL);
+		else fn(&w[t]);
+	}
+}
+
+/* Picks threads-1 splitters from a sorted random sample. Returns 0 if out of memory. */
+static int sort__splitters(struct sort__par* p, const ulib_allocator* alloc){
+	unsigned int i, j, ns = p->threads*SORT__OVERSAMPLE, s = p->size;
+	unsigned long r = 12345;
+	sort_cmp cmp = p->cmp;
+
+	p->splitters = ulib__alloc(alloc, ns*s, ULIB_TAG_OTHER);
+	if(!p->splitters) return 0;
+	for(i=0; i!=ns; ++i){
+		r = r*1103515245UL + 12345UL;
+		j = (unsigned int)((r >> 8) % p->n);
+		sort__copy(SORT__AT(p->splitters, i), SORT__AT(p->base, j), s);
+	}
+	if(p->kind == SORT__INT) cmp = sort_cmp_int;
+	else if(p->kind == SORT__DB) cmp = sort__cmp_db_key;
+	sort_pdq(p->splitters, ns, s, cmp);
+	for(i=1; i!=p->threads; ++i){
+		sort__copy(SORT__AT(p->splitters, i-1), SORT__AT(p->splitters, i*SORT__OVERSAMPLE), s);
+	}
+	return 1;
+}
+
+/* Sample sort on 'threads' threads. Returns 0, leaving 'base' untouched, if out of memory. */
+static int sort__sample(char* base, unsigned int n, unsigned int s, sort_cmp cmp,
+	unsigned int kind, unsigned int threads, const ulib_allocator* alloc){
+	struct sort__par p;
+	struct sort__worker w[ULIB_SORT_MAX_THREADS];
+	unsigned int t, b, c, sum, ns = threads*SORT__OVERSAMPLE;
+	int ok;
+
+	p.base = base;
+	p.n = n;
+	p.size = s;
+	p.cmp = cmp;
+	p.kind = kind;
+	p.threads = threads;
+	p.tmp = ulib__alloc(alloc, n*s, ULIB_TAG_OTHER);
+	p.bucket = ulib__alloc(alloc, n, ULIB_TAG_OTHER);
+	p.count = ulib__alloc(alloc, (threads*threads + threads + 1)*sizeof(unsigned int), ULIB_TAG_OTHER);
+	ok = p.tmp && p.bucket && p.count && sort__splitters(&p, alloc);
+	if(ok){
+		p.start = p.count + threads*threads;
+		for(t=0; t!=threads; ++t){
+			w[t].par = &p;
+			w[t].id = t;
+		}
+		sort__run(sort__classify, w, threads);
+
+		/* Where each chunk writes into each bucket */
+		for(b=0, sum=0; b!=threads; ++b){
+			p.start[b] = sum;
+			for(t=0; t!=threads; ++t){
+				c = p.count[t*threads + b];
+				p.count[t*threads + b] = sum;
+				sum += c;
+			}
+		}
+		p.start[threads] = n;
+
+		sort__run(sort__scatter, w, threads);
+		sort__run(sort__bucket, w, threads);
+		ulib__dealloc(alloc, p.splitters, ns*s, ULIB_TAG_OTHER);
+	}
+
+	if(p.count) ulib__dealloc(alloc, p.count, (threads*threads + threads + 1)*sizeof(unsigned int), ULIB_TAG_OTHER);
+	if(p.bucket) ulib__dealloc(alloc, p.bucket, n, ULIB_TAG_OTHER);
+	if(p.tmp) ulib__dealloc(alloc, p.tmp, n*s, ULIB_TAG_OTHER);
+	return ok;
+}
+
+#endif /* ULIB_THREADS */
+
+/* Threads a parallel sort of 'n' members runs on, 1 meaning on the caller alone */
+static unsigned int sort__threads(unsigned int threads, unsigned int n){
+#ifdef ULIB_THREADS
+	if(threads == 0){
+	#ifdef _SC_NPROCESSORS_ONLN
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = online > 0 ? (unsigned int)online : 1;
+	#else
+		threads = 1;
+	#endif
+	}
+	if(threads > ULIB_SORT_MAX_THREADS) threads = ULIB_SORT_MAX_THREADS;
+	if(n < ULIB_SORT_PARALLEL_MIN) threads = 1;
+	return threads;
+#else
+	(void)threads;
+	(void)n;
+	return 1;
+#endif
+}
+
+/*
+Sorts 'n' members of 'size' bytes on up to 'threads' threads (0 for one per
+online processor), taking scratch memory from 'alloc' (NULL for the default).
+Without ULIB_THREADS, or when short of memory, it is sort_pdq.
+*/
+void sort_parallel(void* base, unsigned int n, unsigned int size, sort_cmp cmp,
+	unsigned int threads, const ulib_allocator* alloc){
+	threads = sort__threads(threads, n);
+	if(!alloc) alloc = &ulib_default_allocator;
+#ifdef ULIB_THREADS
+	if(threads > 1 && size && n <= (unsigned int)-1 / size
+		&& sort__sample(base, n, size, cmp, SORT__ANY, threads, alloc)) return;
+#endif
+	sort_pdq(base, n, size, cmp);
+}
+
+/* As sort_parallel for ints, each bucket radix sorted */
+void sort_parallel_int(int* a, unsigned int n, unsigned int threads, const ulib_allocator* alloc){
+	threads = sort__threads(threads, n);
+	if(!alloc) alloc = &ulib_default_allocator;
+#ifdef ULIB_THREADS
+	if(threads > 1 && n <= (unsigned int)-1 / sizeof(int)
+		&& sort__sample((char*)a, n, sizeof(int), sort_cmp_int, SORT__INT, threads, alloc)) return;
+#endif
+	sort_radix_int(a, n, alloc);
+}
+
+/* As sort_parallel for doubles, each bucket radix sorted, in the order of sort_radix_db */
+void sort_parallel_db(double* a, unsigned int n, unsigned int threads, const ulib_allocator* alloc){
+	threads = sort__threads(threads, n);
+	if(!alloc) alloc = &ulib_default_allocator;
+#ifdef ULIB_THREADS
+	if(threads > 1 && sizeof(unsigned long) == sizeof(double) && n <= (unsigned int)-1 / sizeof(double)
+		&& sort__sample((char*)a, n, sizeof(double), sort_cmp_db, SORT__DB, threads, alloc)) return;
+#endif
+	sort_radix_db(a, n, alloc);
+}
+
+/*
+ *	SEARCHING
+ */
+
+/*
+Binary searches keep the answer within [b, b+n] and halve n
+without branching on the comparison, as the branch is unpredictable.
+*/
+
+/* Index of the first member not less than 'key', or 'n' if there is none */
+unsigned int sort_lower_bound(const void* base, unsigned int n, unsigned int size,
+	const void* key, sort_cmp cmp){
+	const char* b = base;
+	unsigned int half, s = size;
+	if(n == 0) return 0;
+	while(n > 1){
+		half = n/2;
+		b = cmp(SORT__AT(b, half), key) < 0 ? SORT__AT(b, half) : b;
+		n -= half;
+	}
+	return (unsigned int)((size_t)(b - (const char*)base)/s) + (cmp(b, key) < 0);
+}
+
+/* Index of the first member greater than 'key', or 'n' if there is none */
+unsigned int sort_upper_bound(const void* base, unsigned int n, unsigned int size,
+	const void* key, sort_cmp cmp){
+	const char* b = base;
+	unsigned int half, s = size;
+	if(n == 0) return 0;
+	while(n > 1){
+		half = n/2;
+		b = cmp(SORT__AT(b, half), key) <= 0 ? SORT__AT(b, half) : b;
+		n -= half;
+	}
+	return (unsigned int)((size_t)(b - (const char*)base)/s) + (cmp(b, key) <= 0);
+}
+
+/* Members equal to 'key' span from the returned index up to 'end' */
+unsigned int sort_equal_range(const void* base, unsigned int n, unsigned int size,
+	const void* key, sort_cmp cmp, unsigned int* end){
+	unsigned int lo = sort_lower_bound(base, n, size, key, cmp);
+	*end = lo + sort_upper_bound((const char*)base + (size_t)lo*size, n - lo, size, key, cmp);
+	return lo;
+}
+
+unsigned int sort_lower_bound_int(const int* a, unsigned int n, int key){
+	const int* b = a;
+	unsigned int half;
+	if(n == 0) return 0;
+	while(n > 1){
+		half = n/2;
+		b = b[half] < key ? b + half : b;
+		n -= half;
+	}
+	return (unsigned int)(b - a) + (*b < key);
+}
+
+unsigned int sort_upper_bound_int(const int* a, unsigned int n, int key){
+	const int* b = a;
+	unsigned int half;
+	if(n == 0) return 0;
+	while(n > 1){
+		half = n/2;
+		b = b[half] <= key ? b + half : b;
+		n -= half;
+	}
+	return (unsigned int)(b - a) + (*b <= key);
+}
+
+unsigned int sort_lower_bound_db(const double* a, unsigned int n, double key){
+	const double* b = a;
+	unsigned int half;
+	if(n == 0) return 0;
+	while(n > 1){
+		half = n/2;
+		b = b[half] < key ? b + half : b;
+		n -= half;
+	}
+	return (unsigned int)(b - a) + (*b < key);
+}
+
+unsigned int sort_upper_bound_db(const double* a, unsigned int n, double key){
+	const double* b = a;
+	unsigned int half;
+	if(n == 0) return 0;
+	while(n > 1){
+		half = n/2;
+		b = b[half] <= key ? b + half : b;
+		n -= half;
+	}
+	return (unsigned int)(b - a) + (*b <= key);
+}
+
+/*
+Eytzinger layout: node k (from 1) is stored at index k-1,
+and its children are nodes 2k and 2k+1.
+*/
+
+/* Fills the subtree at node 'k' in order from sorted member 'i' on, returns the next one */
+static unsigned int sort__eytzinger(const char* src, char* out, unsigned int i,
+	unsigned long k, unsigned int n, unsigned int s){
+	if(k <= n){
+		i = sort__eytzinger(src, out, i, 2*k, n, s);
+		sort__copy(SORT__AT(out, k-1), SORT__AT(src, i), s);
+		i = sort__eytzinger(src, out, i+1, 2*k + 1, n, s);
+	}
+	return i;
+}
+
+/* Copies 'n' sorted members into Eytzinger order at 'out', which must not overlap them */
+void sort_eytzinger(const void* sorted, void* out, unsigned int n, unsigned int size){
+	sort__eytzinger(sorted, out, 0, 1, n, size);
+}
+
+/*
+The search descends from the root, going right past members less than the key.
+The answer is the last node where it went left: shifting out the trailing
+right turns (ones) and that left turn leaves it, or 0 if it never turned left.
+*/
+#ifdef __GNUC__
+	#define SORT__EYTZINGER_RESULT(k, n) \
+		(k) >>= __builtin_ctzl(~(k)) + 1; \
+		return (k) ? (unsigned int)(k) - 1 : (n);
+#else
+	#define SORT__EYTZINGER_RESULT(k, n) \
+		while((k) & 1) (k) >>= 1; \
+		(k) >>= 1; \
+		return (k) ? (unsigned int)(k) - 1 : (n);
+#endif
+
+/* Index in the layout of the first member not less than 'key', or 'n' if there is none */
+unsigned int sort_eytzinger_lower_bound(const void* eyt, unsigned int n, unsigned int size,
+	const void* key, sort_cmp cmp){
+	const char* e = eyt;
+	unsigned long k = 1;
+	unsigned int s = size;
+	while(k <= n) k = 2*k + (cmp(SORT__AT(e, k-1), key) < 0);
+	SORT__EYTZINGER_RESULT(k, n)
+}
+
+/* Prefetches the 16 nodes four levels down, which share a cache line */
+unsigned int sort_eytzinger_lower_bound_int(const int* eyt, unsigned int n, int key){
+	unsigned long k = 1;
+	while(k <= n){
+		ULIB_PREFETCH(eyt + 16*k - 1);
+		k = 2*k + (eyt[k-1] < key);
+	}
+	SORT__EYTZINGER_RESULT(k, n)
+}
+
+/* Prefetches the 8 nodes three levels down */
+unsigned int sort_eytzinger_lower_bound_db(const double* eyt, unsigned int n, double key){
+	unsigned long k = 1;
+	while(k <= n){
+		ULIB_PREFETCH(eyt + 8*k - 1);
+		k = 2*k + (eyt[k-1] < key);
+	}
+	SORT__EYTZINGER_RESULT(k, n)
+}
+
+#endif /* SORT_IMPLEMENTATION */
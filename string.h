@@ -29,6 +29,10 @@ v0.1 - 20/03/2021
 v0.2 - 22/0.3/2021
 	- Editing: append, clear, slice, substr
 
+v0.3
+	- Initialising: new_alloc, taking memory from a ulib_allocator.
+	- string_new formats straight into the new string.
+
 TO-DO
 	- Let string_new accept formatted strings like sprintf.
 		E.g. string* string_new(char*, ...) ->
@@ -57,24 +61,38 @@ TO-DO
  */
 
 typedef struct string__struct string;
+
+/* String methods, shared by every string under ULIB_SHARED_VTABLE (defs.h) */
+#define STRING__METHODS \
+	unsigned int (*length)(string*); \
+	void (*free)(string*); \
+	void (*print)(string*); \
+	string* (*copy)(string*); \
+	char* (*at)(string*, int j); \
+	char (*getc)(string*, int j); \
+	string* (*insert)(string*, const char* substr, int j); \
+	string* (*append)(string*, const char* substr); \
+	string* (*erase)(string* s, int j, unsigned int n); \
+	string* (*clear)(string* s); \
+	string* (*slice)(string* s, int j, int k); \
+	string* (*substr)(string* s, int j, int k);
+
+typedef struct string__vtable_struct string_vtable;
+struct string__vtable_struct {
+	STRING__METHODS
+};
+
 struct string__struct {
 	char* str;
 	unsigned long len;
+	const ulib_allocator* alloc;
 
+#ifdef ULIB_SHARED_VTABLE
+	const string_vtable* vt;
+#else
 	/* Function pointers */
-	unsigned int (*length)(string*);
-	void (*free)(string*);
-	void (*print)(string*);
-	string* (*copy)(string*);
-	char* (*at)(string*, int j);
-	char (*getc)(string*, int j);
-	string* (*insert)(string*, const char* substr, int j);
-	string* (*append)(string*, const char* substr);
-	
-	string* (*erase)(string* s, int j, unsigned int n);
-	string* (*clear)(string* s);
-	string* (*slice)(string* s, int j, int k);
-	string* (*substr)(string* s, int j, int k);
+	STRING__METHODS
+#endif
 };
 
 
@@ -83,6 +101,7 @@ struct string__struct {
  */
 string* string_init(string* s, const char* s_orig);
 string* string_new(const char* s_orig, ...);
+string* string_new_alloc(const ulib_allocator* alloc, const char* s_orig, ...);
 void string__free(string* s);
 
 unsigned int string__length(string* s);
@@ -150,13 +169,34 @@ string* string__split(string* s, const char* tokens)
 
 #ifdef STRING_IMPLEMENTATION
 
-string* string_init(string* s, const char* s_orig){
+#ifdef ULIB_SHARED_VTABLE
+/* In the order of STRING__METHODS */
+static const string_vtable string__methods = {
+	string__length,
+	string__free,
+	string__print,
+	string__copy,
+	string__at,
+	string__getc,
+	string__insert,
+	string__append,
+	string__erase,
+	string__clear,
+	string__slice,
+	string__substr
+};
+#endif
 
-	s->len = s_orig ? ULIB_STRLEN(s_orig) : 0;
-	s->str = calloc(s->len+1, sizeof(char));
+/* Gives 's' an empty buffer for 'len' characters, from the allocator in s->alloc */
+static string* string__setup(string* s, unsigned long len){
+
+	s->len = len;
+	s->str = ulib__zalloc(s->alloc, s->len+1, ULIB_TAG_STRING);
 	if(!s->str) return NULL;
-	if(s_orig) ULIB_STRCPY(s->str, s_orig);
 
+#ifdef ULIB_SHARED_VTABLE
+	s->vt = &string__methods;
+#else
 	/* Function pointers */
 	s->free = &string__free;
 	s->length = string__length;
@@ -172,7 +212,15 @@ string* string_init(string* s, const char* s_orig){
 	s->clear = &string__clear;
 	s->slice = &string__slice;
 	s->substr = &string__substr;
+#endif
+
+	return s;
+}
 
+string* string_init(string* s, const char* s_orig){
+	s->alloc = &ulib_default_allocator;
+	if(!string__setup(s, s_orig ? ULIB_STRLEN(s_orig) : 0)) return NULL;
+	if(s_orig) ULIB_STRCPY(s->str, s_orig);
 	return s;
 }
 
@@ -196,44 +244,68 @@ int vfstrlen(const char* fmt, ULIB_VA_LIST vargs){
 	return len;
 }
 
-string* string_new(const char* fmt, ...){
-	/* allocate string */
-	string* s = ULIB_MALLOC(sizeof(string));
-	if(!s) return NULL;
-	if(!fmt) return string_init(s, NULL); /* create empty string */
-
-	/*
-	 * Fake snprintf for C89 (not in standard lib till C99).
-	 * fprintf to NUL to get final length,
-	 * allocate as much, and create formatted string.
-	 * This avoids buffer overflow on sprintf.
-	 */
-	ULIB_VA_LIST vargs;
-	ULIB_VA_START(vargs, fmt);
-	int slength = vfstrlen(fmt, vargs); /* returns negative number on fail */
-	
+/*
+ * Allocates a string of 'slength' characters and formats it.
+ * Fake snprintf for C89 (not in standard lib till C99):
+ * the caller fprintfs to NUL to get the final length first.
+ * A va_list cannot be read twice in C89, so each
+ * pass gets its own ULIB_VA_START from the caller.
+ */
+static string* string__vnew(const ulib_allocator* alloc, int slength, const char* fmt, ULIB_VA_LIST vargs){
+	string* s;
+
 	#ifdef ULIB_DEBUG
 	ULIB_PRINTF("DEBUG: new string vfstrlen -> %d\n", slength);
 	#endif
 
-	if(slength < 0){
-		ULIB_FREE(s);
+	if(slength < 0) return NULL;
+	s = ulib__alloc(alloc, sizeof(string), ULIB_TAG_STRING);
+	if(!s) return NULL;
+	s->alloc = alloc;
+	if(!string__setup(s, slength)){
+		ulib__dealloc(alloc, s, sizeof(string), ULIB_TAG_STRING);
 		return NULL;
 	}
-	char* fullstr = ULIB_MALLOC(slength+1);
-	if(!fullstr){
-		ULIB_FREE(s);
+	if(!fmt) return s; /* empty string */
+
+	if(ULIB_VSPRINTF(s->str, fmt, vargs) != slength){ /* returns negative number on fail */
+		string__free(s);
 		return NULL;
 	}
-	int retsize = ULIB_VSPRINTF(fullstr, fmt, vargs); /* returns negative number on fail */
-	if (retsize < 0 || retsize != slength){
-		ULIB_FREE(s);
-		ULIB_FREE(fullstr);
-		return NULL;
+	return s;
+}
+
+string* string_new(const char* fmt, ...){
+	ULIB_VA_LIST vargs;
+	string* s;
+	int slength = 0;
+
+	if(fmt){
+		ULIB_VA_START(vargs, fmt);
+		slength = vfstrlen(fmt, vargs); /* returns negative number on fail */
+		ULIB_VA_END(vargs);
 	}
+	ULIB_VA_START(vargs, fmt);
+	s = string__vnew(&ulib_default_allocator, slength, fmt, vargs);
+	ULIB_VA_END(vargs);
+	return s;
+}
+
+/* As string_new, taking all memory from 'alloc' (NULL for the default) */
+string* string_new_alloc(const ulib_allocator* alloc, const char* fmt, ...){
+	ULIB_VA_LIST vargs;
+	string* s;
+	int slength = 0;
+
+	if(!alloc) alloc = &ulib_default_allocator;
+	if(fmt){
+		ULIB_VA_START(vargs, fmt);
+		slength = vfstrlen(fmt, vargs);
+		ULIB_VA_END(vargs);
+	}
+	ULIB_VA_START(vargs, fmt);
+	s = string__vnew(alloc, slength, fmt, vargs);
 	ULIB_VA_END(vargs);
-	s = string_init(s, fullstr);
-	ULIB_FREE(fullstr);
 	return s;
 }
 
@@ -248,7 +320,7 @@ char* string__at(string* s, int j){
 }
 
 char string__getc(string* s, int j){
-	char *c = s->at(s, j);
+	char *c = string__at(s, j);
 	if(!c) return (char)0;
 	return *c;
 }
@@ -259,17 +331,20 @@ void string__print(string* s){
 
 void string__free(string* s){
 	if(!s) return;
-	if(s->str) ULIB_FREE(s->str);
-	ULIB_FREE(s);
+	ulib__dealloc(s->alloc, s->str, s->len+1, ULIB_TAG_STRING);
+	ulib__dealloc(s->alloc, s, sizeof(string), ULIB_TAG_STRING);
 }
 
 string* string__copy(string* s){
 	string *new;
-	new = malloc(sizeof(string));
+	new = ulib__alloc(s->alloc, sizeof(string), ULIB_TAG_STRING);
 	if(!new) return NULL;
 	ULIB_MEMCPY(new, s, sizeof(string));
-	new->str = malloc(s->len+1);
-	if(!new->str) return NULL;
+	new->str = ulib__alloc(s->alloc, s->len+1, ULIB_TAG_STRING);
+	if(!new->str){
+		ulib__dealloc(s->alloc, new, sizeof(string), ULIB_TAG_STRING);
+		return NULL;
+	}
 	ULIB_MEMCPY(new->str, s->str, s->len+1);
 	return new;
 }
@@ -280,15 +355,15 @@ string* string__insert(string* s, const char* substr, int j){
 	if(j > (int)s->len || j < 0) return NULL;
 
 	unsigned int sslength = ULIB_STRLEN(substr);
-	char* insptr = s->str + j;
 
-	char* newstr = realloc(s->str, (s->len + sslength + 1)*sizeof(char) );
+	char* newstr = ulib__realloc(s->alloc, s->str, s->len + 1, s->len + sslength + 1, ULIB_TAG_STRING);
 	if(!newstr) return NULL;
 
+	char* insptr = newstr + j;
 	s->str = newstr;
 	s->len += sslength;
 
-	ULIB_MEMCPY(insptr + sslength, insptr, s->len - sslength - j);
+	ULIB_MEMMOVE(insptr + sslength, insptr, s->len - sslength - j);
 	ULIB_MEMCPY(insptr, substr, sslength);
 	*(s->str + s->len) = (char)0;
 
@@ -296,7 +371,7 @@ string* string__insert(string* s, const char* substr, int j){
 }
 
 string* string__append(string* s, const char* substr){
-	return ( s->insert(s, substr, s->len) );
+	return ( string__insert(s, substr, s->len) );
 }
 
 string* string__erase(string* s, int j, unsigned int n){
@@ -304,10 +379,10 @@ string* string__erase(string* s, int j, unsigned int n){
 	if(j > (int)s->len || j < 0) return NULL;
 	if(j+(int)n > (int)s->len) n = s->len - j;
 
-	ULIB_MEMCPY(s->str+j, s->str+j+n, s->len-j-n);
+	ULIB_MEMMOVE(s->str+j, s->str+j+n, s->len-j-n);
 
 	char *newstr = NULL;
-	newstr = realloc(s->str, s->len - n + 1 );
+	newstr = ulib__realloc(s->alloc, s->str, s->len + 1, s->len - n + 1, ULIB_TAG_STRING);
 	if(!newstr) return NULL;
 
 	s->str = newstr;
@@ -317,25 +392,25 @@ string* string__erase(string* s, int j, unsigned int n){
 }
 
 string* string__clear(string* s){
-	return s->erase(s, 0, s->len+1);
+	return string__erase(s, 0, s->len+1);
 }
 
 string* string__slice(string* s, int j, int k){
 	unsigned int n;
 	j < 0 ? n = s->len+(unsigned int)j : (n = (unsigned int)j);
-	if( s->erase(s, 0, n) == NULL ) return NULL;
-	if( s->erase(s, k-j, s->len) == NULL) return NULL;
+	if( string__erase(s, 0, n) == NULL ) return NULL;
+	if( string__erase(s, k-j, s->len) == NULL) return NULL;
 	return s;
 }
 
 
 string* string__substr(string* s, int j, int k){
-	string *substr = s->copy(s);
+	string *substr = string__copy(s);
 	if(!substr) return NULL;
 
-	string* ret = substr->slice(substr, j, k);
+	string* ret = string__slice(substr, j, k);
 	if(!ret){
-		substr->free(substr);
+		string__free(substr);
 		return NULL;
 	}
 
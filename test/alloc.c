@@ -0,0 +1,338 @@
+
+
+#define ULIB_TRACK_ALLOC
+#include "../ulib.h"
+
+/*
+ * Counting allocator: a header in front of every block records its size,
+ * so the sizes the containers report on realloc and free can be checked.
+ */
+struct counter {
+	unsigned int blocks;
+	unsigned int bytes;
+	unsigned int bad_sizes;
+};
+
+void* count_alloc(void* ctx, unsigned int bytes){
+	struct counter* c = ctx;
+	double* h = malloc(sizeof(double) + bytes);
+	if(!h) return NULL;
+	*(unsigned int*)h = bytes;
+	c->blocks++;
+	c->bytes += bytes;
+	return h + 1;
+}
+
+void* count_realloc(void* ctx, void* ptr, unsigned int old_bytes, unsigned int new_bytes){
+	struct counter* c = ctx;
+	double* h = (double*)ptr - 1;
+	if(*(unsigned int*)h != old_bytes) c->bad_sizes++;
+	h = realloc(h, sizeof(double) + new_bytes);
+	if(!h) return NULL;
+	*(unsigned int*)h = new_bytes;
+	c->bytes += new_bytes - old_bytes;
+	return h + 1;
+}
+
+void count_free(void* ctx, void* ptr, unsigned int bytes){
+	struct counter* c = ctx;
+	double* h = (double*)ptr - 1;
+	if(*(unsigned int*)h != bytes) c->bad_sizes++;
+	c->blocks--;
+	c->bytes -= bytes;
+	free(h);
+}
+
+int balanced(struct counter* c){
+	return c->blocks == 0 && c->bytes == 0 && c->bad_sizes == 0;
+}
+
+void test_vector_alloc(){
+	struct counter c = {0, 0, 0};
+	ulib_allocator a = {count_alloc, count_realloc, count_free, NULL};
+	vector* v;
+	int i;
+	a.ctx = &c;
+
+	v = vector_new_alloc(sizeof(int), &a);
+	for(i=0; i!=100; ++i) v->insert(v, 0, &i);
+	for(i=0; i!=50; ++i) v->delete(v, 10);
+	v->resize(v, 10);
+	if(c.blocks != 2 || v->length(v) != 10){
+		ULIB_FPRINTF(stderr, "Vector alloc: FAILED (blocks)\n");
+		exit(1);
+	}
+	v->free(v);
+	if(!balanced(&c)){
+		ULIB_FPRINTF(stderr, "Vector alloc: FAILED (%u blocks, %u bytes, %u sizes)\n",
+			c.blocks, c.bytes, c.bad_sizes);
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "Vector alloc: PASSED\n");
+}
+
+void test_vector_inline_alloc(){
+	struct counter c = {0, 0, 0};
+	ulib_allocator a = {count_alloc, count_realloc, count_free, NULL};
+	vector* v;
+	int i;
+	a.ctx = &c;
+
+	/* Eight ints fit with the object in a single block */
+	v = vector_new_inline_alloc(sizeof(int), 8*sizeof(int), &a);
+	for(i=0; i!=8; ++i) v->push(v, &i);
+	if(c.blocks != 1){
+		ULIB_FPRINTF(stderr, "Vector inline alloc: FAILED (inline)\n");
+		exit(1);
+	}
+	for(i=8; i!=100; ++i) v->push(v, &i);
+	if(c.blocks != 2){
+		ULIB_FPRINTF(stderr, "Vector inline alloc: FAILED (spill)\n");
+		exit(1);
+	}
+	while(v->length(v) > 2) v->pop(v, NULL);
+	v->shrink_to_fit(v);
+	if(c.blocks != 1 || *(int*)v->back(v) != 1){
+		ULIB_FPRINTF(stderr, "Vector inline alloc: FAILED (back inline)\n");
+		exit(1);
+	}
+	v->free(v);
+	if(!balanced(&c)){
+		ULIB_FPRINTF(stderr, "Vector inline alloc: FAILED (%u blocks, %u bytes, %u sizes)\n",
+			c.blocks, c.bytes, c.bad_sizes);
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "Vector inline alloc: PASSED\n");
+}
+
+void test_array_alloc(){
+	struct counter c = {0, 0, 0};
+	ulib_allocator a = {count_alloc, count_realloc, count_free, NULL};
+	array* arr;
+	a.ctx = &c;
+
+	arr = array_new_alloc(100, TYPE_DOUBLE, &a);
+	if(!arr || c.blocks != 2 || arr->getf(arr, 99) != 0.0){
+		ULIB_FPRINTF(stderr, "Array alloc: FAILED (new)\n");
+		exit(1);
+	}
+	arr->free(arr);
+	if(!balanced(&c)){
+		ULIB_FPRINTF(stderr, "Array alloc: FAILED\n");
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "Array alloc: PASSED\n");
+}
+
+void test_list_alloc(){
+	struct counter c = {0, 0, 0};
+	ulib_allocator a = {count_alloc, count_realloc, count_free, NULL};
+	list* l;
+	int i;
+	double x = 1.5;
+	char str[50] = "Hello";
+	a.ctx = &c;
+
+	l = list_new_alloc(&a);
+	for(i=0; i!=20; ++i) l->append(l, TYPE_INT, &i);
+	l->set(l, 3, TYPE_DOUBLE, &x);
+	l->set(l, 4, TYPE_STR_50, str);
+	l->remove(l, 5);
+	l->pop(l);
+	l->free(l);
+	if(!balanced(&c)){
+		ULIB_FPRINTF(stderr, "List alloc: FAILED\n");
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "List alloc: PASSED\n");
+}
+
+void test_string_alloc(){
+	struct counter c = {0, 0, 0};
+	ulib_allocator a = {count_alloc, count_realloc, count_free, NULL};
+	string *s, *r;
+	a.ctx = &c;
+
+	s = string_new_alloc(&a, "%d apples and %s", 12, "pears");
+	if(!s || ULIB_STRCMP(s->str, "12 apples and pears") != 0){
+		ULIB_FPRINTF(stderr, "String alloc: FAILED (new)\n");
+		exit(1);
+	}
+	s->append(s, ", please");
+	s->erase(s, 0, 3);
+	r = s->substr(s, 0, 6);
+	if(!r || ULIB_STRCMP(r->str, "apples") != 0){
+		ULIB_FPRINTF(stderr, "String alloc: FAILED (substr)\n");
+		exit(1);
+	}
+	r->free(r);
+	s->free(s);
+	if(!balanced(&c)){
+		ULIB_FPRINTF(stderr, "String alloc: FAILED\n");
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "String alloc: PASSED\n");
+}
+
+void test_segvec_alloc(){
+	struct counter c = {0, 0, 0};
+	ulib_allocator a = {count_alloc, count_realloc, count_free, NULL};
+	segvec* s;
+	int i;
+	a.ctx = &c;
+
+	/* Growth allocates blocks and never reallocates */
+	s = segvec_new_alloc(sizeof(int), &a);
+	for(i=0; i!=1000; ++i) s->push(s, &i);
+	if(c.blocks != 1 + s->nblocks || c.bytes != s->mem(s)){
+		ULIB_FPRINTF(stderr, "Segvec alloc: FAILED (blocks)\n");
+		exit(1);
+	}
+	s->resize(s, 20);
+	s->shrink_to_fit(s);
+	s->free(s);
+	if(!balanced(&c)){
+		ULIB_FPRINTF(stderr, "Segvec alloc: FAILED\n");
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "Segvec alloc: PASSED\n");
+}
+
+void test_deque_alloc(){
+	struct counter c = {0, 0, 0};
+	ulib_allocator a = {count_alloc, count_realloc, count_free, NULL};
+	deque* q;
+	int i;
+	a.ctx = &c;
+
+	q = deque_new_alloc(sizeof(int), &a);
+	for(i=0; i!=1000; ++i){
+		q->push_front(q, &i);
+		if(i % 3 == 0) q->pop_back(q, NULL);
+	}
+	if(c.blocks != 2 || c.bytes != q->mem(q)){
+		ULIB_FPRINTF(stderr, "Deque alloc: FAILED (buffer)\n");
+		exit(1);
+	}
+	q->shrink_to_fit(q);
+	q->free(q);
+	if(!balanced(&c)){
+		ULIB_FPRINTF(stderr, "Deque alloc: FAILED\n");
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "Deque alloc: PASSED\n");
+}
+
+void test_soa_alloc(){
+	struct counter c = {0, 0, 0};
+	ulib_allocator a = {count_alloc, count_realloc, count_free, NULL};
+	soa_field schema[] = {{TYPE_INT, 0}, {TYPE_DOUBLE, 0}};
+	soa* s;
+	double x = 1;
+	int i;
+	a.ctx = &c;
+
+	/* A column per field, plus the schema */
+	s = soa_new_alloc(schema, 2, &a);
+	for(i=0; i!=1000; ++i) s->push(s, &i, &x);
+	if(c.blocks != 5 || c.bytes != s->mem(s)){
+		ULIB_FPRINTF(stderr, "Soa alloc: FAILED (columns)\n");
+		exit(1);
+	}
+	s->free(s);
+	if(!balanced(&c)){
+		ULIB_FPRINTF(stderr, "Soa alloc: FAILED\n");
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "Soa alloc: PASSED\n");
+}
+
+void test_appendvec_alloc(){
+	struct counter c = {0, 0, 0};
+	ulib_allocator a = {count_alloc, count_realloc, count_free, NULL};
+	appendvec* v;
+	int i;
+	a.ctx = &c;
+
+	/* Blocks carry a flag per member, and are never reallocated */
+	v = appendvec_new_alloc(sizeof(int), &a);
+	for(i=0; i!=1000; ++i) v->push(v, &i);
+	if(c.bytes != v->mem(v)){
+		ULIB_FPRINTF(stderr, "Appendvec alloc: FAILED (blocks)\n");
+		exit(1);
+	}
+	v->clear(v);
+	v->free(v);
+	if(!balanced(&c)){
+		ULIB_FPRINTF(stderr, "Appendvec alloc: FAILED\n");
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "Appendvec alloc: PASSED\n");
+}
+
+void test_track_alloc(){
+	const ulib_alloc_stats* st = ulib_alloc_query(ULIB_TAG_VECTOR);
+	const ulib_alloc_stats* all = ulib_alloc_query(ULIB_TAG_ALL);
+	const char* argv[] = {"prog", "-n", "42", "--name", "ulib"};
+	vector* v;
+	list* l;
+	int i;
+
+	ulib_alloc_reset();
+	v = vector_new(sizeof(int));
+	for(i=0; i!=100; ++i) v->insert(v, 0, &i);
+	/* 4, 8, 16, 32, 64, 128 */
+	if(st->allocs != 2 || st->reallocs != 5
+		|| st->live_bytes != sizeof(vector) + 128*sizeof(int)
+		|| st->peak_bytes != st->live_bytes || st->total_bytes != st->live_bytes){
+		ULIB_FPRINTF(stderr, "Track alloc: FAILED (vector)\n");
+		exit(1);
+	}
+	v->free(v);
+	if(st->frees != 2 || st->live_bytes != 0 || st->peak_bytes == 0){
+		ULIB_FPRINTF(stderr, "Track alloc: FAILED (vector free)\n");
+		exit(1);
+	}
+
+	/* Containers on other allocators count as that allocator */
+	l = list_new();
+	for(i=0; i!=100; ++i) l->append(l, TYPE_INT, &i);
+	if(ulib_alloc_query(ULIB_TAG_LIST)->live_bytes == 0
+		|| ulib_alloc_query(ULIB_TAG_POOL)->live_bytes == 0){
+		ULIB_FPRINTF(stderr, "Track alloc: FAILED (list)\n");
+		exit(1);
+	}
+	l->free(l);
+
+	arglib_init();
+	arglib_add_option('n', "num", "A number", ARG_INT, ARG_OPT);
+	arglib_add_option('s', "name", NULL, ARG_STR, ARG_OPT);
+	arglib_parse(5, argv);
+	if(ulib_alloc_query(ULIB_TAG_ARGLIB)->live_bytes == 0){
+		ULIB_FPRINTF(stderr, "Track alloc: FAILED (arglib)\n");
+		exit(1);
+	}
+	arglib_free();
+
+	if(all->live_bytes != 0 || all->allocs != all->frees
+		|| all->peak_bytes < st->peak_bytes){
+		ULIB_FPRINTF(stderr, "Track alloc: FAILED (totals)\n");
+		ulib_alloc_dump(stderr, ULIB_DUMP_TEXT);
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "Track alloc: PASSED\n");
+}
+
+int main(){
+	test_vector_alloc();
+	test_vector_inline_alloc();
+	test_array_alloc();
+	test_list_alloc();
+	test_string_alloc();
+	test_segvec_alloc();
+	test_deque_alloc();
+	test_soa_alloc();
+	test_appendvec_alloc();
+	test_track_alloc();
+	return 0;
+}
@@ -0,0 +1,153 @@
+#include <pthread.h>
+#include "../ulib.h"
+
+#define PRODUCERS 8
+#define PER_PRODUCER 50000
+
+void test_appendvec_basic(){
+	appendvec* a = appendvec_new(sizeof(int));
+	int i, x, block[100], *p;
+	unsigned int k, slot;
+
+	for(i=0; i!=1000; ++i) a->push(a, &i);
+	for(i=0; i!=100; ++i) block[i] = 1000 + i;
+	a->push_array(a, block, 100);
+	if(a->length(a) != 1100 || a->capacity(a) < 1100 || a->elem_size(a) != sizeof(int)){
+		ULIB_FPRINTF(stderr, "Appendvec basic: FAILED (length)\n");
+		exit(1);
+	}
+	for(i=0; i!=1100; ++i){
+		if(!a->at(a, i) || *(int*)a->at(a, i) != i){
+			ULIB_FPRINTF(stderr, "Appendvec basic: FAILED (member %d)\n", i);
+			exit(1);
+		}
+	}
+	if(a->at(a, 1100) != NULL || a->at(a, (unsigned int)-1) != NULL){
+		ULIB_FPRINTF(stderr, "Appendvec basic: FAILED (out of range)\n");
+		exit(1);
+	}
+
+	/* Reserved slots stay hidden until published */
+	p = a->emplace(a, &k);
+	if(!p || k != 1100 || a->length(a) != 1101 || a->at(a, k) != NULL){
+		ULIB_FPRINTF(stderr, "Appendvec basic: FAILED (emplace)\n");
+		exit(1);
+	}
+	*p = 7;
+	if(!a->publish(a, k) || a->at(a, k) != p || a->publish(a, k+1) != NULL){
+		ULIB_FPRINTF(stderr, "Appendvec basic: FAILED (publish)\n");
+		exit(1);
+	}
+
+	/* Clearing keeps the blocks and hides every member */
+	k = a->capacity(a);
+	a->clear(a);
+	if(a->length(a) != 0 || a->capacity(a) != k || a->at(a, 0) != NULL){
+		ULIB_FPRINTF(stderr, "Appendvec basic: FAILED (clear)\n");
+		exit(1);
+	}
+	x = 5;
+	if(!a->reserve(a, 100000) || a->capacity(a) < 100000 || !a->push(a, &x)
+		|| *(int*)a->at(a, 0) != 5 || a->mem(a) < 100000*(sizeof(int)+1)){
+		ULIB_FPRINTF(stderr, "Appendvec basic: FAILED (reserve)\n");
+		exit(1);
+	}
+
+	/* Pushes past the last slot fail and leave the length there */
+	a->len = APPENDVEC__MAX_LEN - 1;
+	if(a->push_array(a, &x, 2) || a->length(a) != APPENDVEC__MAX_LEN - 1){
+		ULIB_FPRINTF(stderr, "Appendvec basic: FAILED (array past the end)\n");
+		exit(1);
+	}
+	a->len = APPENDVEC__MAX_LEN;
+	for(k=0; k!=3; ++k){
+		if(a->push(a, &x) || a->emplace(a, &slot) || a->length(a) != APPENDVEC__MAX_LEN){
+			ULIB_FPRINTF(stderr, "Appendvec basic: FAILED (past the end)\n");
+			exit(1);
+		}
+	}
+	a->len = 1;
+	a->free(a);
+	if(appendvec_new(0) != NULL){
+		ULIB_FPRINTF(stderr, "Appendvec basic: FAILED (zero size)\n");
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "Appendvec basic: PASSED\n");
+}
+
+struct producer {
+	appendvec* a;
+	int id;
+};
+
+/* Pushes its own range of values, half one by one and half in blocks */
+static void* produce(void* arg){
+	struct producer* p = arg;
+	int i, j, block[10];
+	for(i=0; i!=PER_PRODUCER/2; ++i){
+		j = p->id*PER_PRODUCER + i;
+		p->a->push(p->a, &j);
+	}
+	for(; i!=PER_PRODUCER; i+=10){
+		for(j=0; j!=10; ++j) block[j] = p->id*PER_PRODUCER + i + j;
+		p->a->push_array(p->a, block, 10);
+	}
+	return NULL;
+}
+
+/* Reads while the producers write: published members must be whole */
+static void* consume(void* arg){
+	appendvec* a = arg;
+	unsigned int i, n;
+	long bad = 0;
+	int* p;
+	do{
+		n = a->length(a);
+		for(i=0; i!=n; ++i){
+			p = a->at(a, i);
+			if(p && (*p < 0 || *p >= PRODUCERS*PER_PRODUCER)) bad++;
+		}
+	} while(n != PRODUCERS*PER_PRODUCER);
+	return (void*)bad;
+}
+
+void test_appendvec_threads(){
+	appendvec* a = appendvec_new(sizeof(int));
+	struct producer p[PRODUCERS];
+	pthread_t id[PRODUCERS], reader;
+	unsigned char* seen = calloc(PRODUCERS*PER_PRODUCER, 1);
+	void* bad;
+	int t, *x;
+	unsigned int i;
+
+	pthread_create(&reader, NULL, consume, a);
+	for(t=0; t!=PRODUCERS; ++t){
+		p[t].a = a;
+		p[t].id = t;
+		pthread_create(&id[t], NULL, produce, &p[t]);
+	}
+	for(t=0; t!=PRODUCERS; ++t) pthread_join(id[t], NULL);
+	pthread_join(reader, &bad);
+	if(bad != NULL || a->length(a) != PRODUCERS*PER_PRODUCER){
+		ULIB_FPRINTF(stderr, "Appendvec threads: FAILED (length)\n");
+		exit(1);
+	}
+
+	/* Every value made it in exactly once */
+	for(i=0; i!=PRODUCERS*PER_PRODUCER; ++i){
+		x = a->at(a, i);
+		if(!x || seen[*x]++){
+			ULIB_FPRINTF(stderr, "Appendvec threads: FAILED (member %u)\n", i);
+			exit(1);
+		}
+	}
+	free(seen);
+	a->free(a);
+	ULIB_FPRINTF(stderr, "Appendvec threads: PASSED\n");
+}
+
+int main(){
+	test_appendvec_basic();
+	test_appendvec_threads();
+	return 0;
+}
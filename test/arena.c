@@ -0,0 +1,111 @@
+#include "../ulib.h"
+
+void test_arena_alloc(){
+	arena* ar = arena_new(256);
+	arena_mark m;
+	char* p;
+	char* q;
+	int i;
+
+	/* Aligned bump allocations within one block */
+	for(i=1; i!=10; ++i){
+		p = ar->alloc(ar, i);
+		if(!p || (size_t)p % ULIB_ARENA_ALIGN != 0){
+			ULIB_FPRINTF(stderr, "Arena alloc: FAILED (alignment)\n");
+			exit(1);
+		}
+	}
+	if(ar->bytes(ar) != 9*ULIB_ARENA_ALIGN){
+		ULIB_FPRINTF(stderr, "Arena alloc: FAILED (bytes %u)\n", ar->bytes(ar));
+		exit(1);
+	}
+
+	/* Roll back over a chained block and an oversized one */
+	m = ar->mark(ar);
+	p = ar->alloc(ar, 200);
+	q = ar->alloc(ar, 1000);
+	ULIB_MEMCPY(q, "arena", 6);
+	if(!p || !q || ar->block->size < 1000 || ULIB_STRCMP(q, "arena") != 0){
+		ULIB_FPRINTF(stderr, "Arena alloc: FAILED (chaining)\n");
+		exit(1);
+	}
+	ar->reset(ar, m);
+	if(ar->bytes(ar) != 9*ULIB_ARENA_ALIGN || ar->block->prev != NULL){
+		ULIB_FPRINTF(stderr, "Arena alloc: FAILED (reset)\n");
+		exit(1);
+	}
+
+	ar->clear(ar);
+	if(ar->bytes(ar) != 0 || !ar->block){
+		ULIB_FPRINTF(stderr, "Arena alloc: FAILED (clear)\n");
+		exit(1);
+	}
+	ar->free(ar);
+	ULIB_FPRINTF(stderr, "Arena alloc: PASSED\n");
+}
+
+void test_arena_containers(){
+	arena* ar = arena_new(4096);
+	vector* v;
+	list* l;
+	string* s;
+	void* first;
+	int i;
+
+	/* A vector alone on the arena grows in place */
+	v = vector_new_alloc(sizeof(int), &ar->allocator);
+	for(i=0; i!=100; ++i) v->insert(v, v->length(v), &i);
+	first = v->data(v);
+	for(i=100; i!=200; ++i) v->insert(v, v->length(v), &i);
+	if(v->data(v) != first || ar->block->prev != NULL){
+		ULIB_FPRINTF(stderr, "Arena containers: FAILED (in-place growth)\n");
+		exit(1);
+	}
+	for(i=0; i!=200; ++i){
+		if(*(int*)v->at(v, i) != i){
+			ULIB_FPRINTF(stderr, "Arena containers: FAILED (vector data)\n");
+			exit(1);
+		}
+	}
+
+	/* Interleaved containers copy on growth */
+	l = list_new_alloc(&ar->allocator);
+	s = string_new_alloc(&ar->allocator, "Hello %s", "arena");
+	for(i=0; i!=300; ++i){
+		v->insert(v, v->length(v), &i);
+		l->append(l, TYPE_INT, &i);
+	}
+	s->insert(s, " world", s->len);
+	if(l->length(l) != 300 || *(int*)l->at(l, 299)->data != 299
+		|| v->length(v) != 500 || *(int*)v->at(v, 499) != 299
+		|| ULIB_STRCMP(s->str, "Hello arena world") != 0){
+		ULIB_FPRINTF(stderr, "Arena containers: FAILED (mixed)\n");
+		exit(1);
+	}
+
+	/* Dropping everything at once, without freeing each container */
+	ar->clear(ar);
+	if(ar->bytes(ar) != 0 || ar->block->prev != NULL){
+		ULIB_FPRINTF(stderr, "Arena containers: FAILED (clear)\n");
+		exit(1);
+	}
+
+	/* Freeing containers one by one must also work */
+	v = vector_new_alloc(sizeof(double), &ar->allocator);
+	l = list_new_alloc(&ar->allocator);
+	s = string_new_alloc(&ar->allocator, "%d", 42);
+	for(i=0; i!=10; ++i) l->append(l, TYPE_INT, &i);
+	v->resize(v, 10);
+	s->free(s);
+	l->free(l);
+	v->free(v);
+
+	ar->free(ar);
+	ULIB_FPRINTF(stderr, "Arena containers: PASSED\n");
+}
+
+int main(){
+	test_arena_alloc();
+	test_arena_containers();
+	return 0;
+}
@@ -2,6 +2,7 @@
 
 #define ARRAY_IMPLEMENTATION
 #include "../array.h"
+#include <pthread.h>
 
 /* compares doubles */
 int cmpdb(double x, double y, double delta){
@@ -230,8 +231,348 @@ void test_matherr(){
 	ULIB_FPRINTF(stderr, "Math error: PASSED\n");
 }
 
+/* Threads making the first calls into the dispatched kernels at once */
+#define COLD_THREADS 8
+
+static void* cold_calls(void* arg){
+	static const int x[11] = {3, -1, 4, 1, -5, 9, 2, -6, 5, 3, 5};
+	char src[300], dst[300];
+	unsigned int i, bad = 0;
+
+	for(i=0; i!=sizeof(src); ++i) src[i] = (char)('a' + (i + *(unsigned int*)arg) % 26);
+	src[sizeof(src)-1] = 0;
+	ULIB_MEMCPY(dst, src, sizeof(src));
+	if(ULIB_STRLEN(dst) != sizeof(src)-1 || ULIB_MEMCMP(dst, src, sizeof(src)) != 0) bad = 1;
+	if(array__kernels()->sum_int(x, 11) != 20) bad = 1;
+	*(unsigned int*)arg = bad;
+	return NULL;
+}
+
+void test_cold_kernels(){
+	pthread_t id[COLD_THREADS];
+	unsigned int arg[COLD_THREADS];
+	unsigned int t;
+
+	for(t=0; t!=COLD_THREADS; ++t){
+		arg[t] = t;
+		if(pthread_create(&id[t], NULL, cold_calls, &arg[t]) != 0){
+			ULIB_FPRINTF(stderr, "Cold kernels: FAILED (thread %u)\n", t);
+			exit(1);
+		}
+	}
+	for(t=0; t!=COLD_THREADS; ++t) pthread_join(id[t], NULL);
+	for(t=0; t!=COLD_THREADS; ++t){
+		if(arg[t]){
+			ULIB_FPRINTF(stderr, "Cold kernels: FAILED (thread %u)\n", t);
+			exit(1);
+		}
+	}
+	ULIB_FPRINTF(stderr, "Cold kernels: PASSED\n");
+}
+
+/* Every tier against plain loops, over all tail lengths */
+void test_kernels(){
+	static int xi[300];
+	static double xd[300];
+	const array_kernels* k;
+	unsigned int t, n, i, imax, imin, imaxd, imind, seed = 12345;
+	unsigned int sum;
+	int maxi, mini;
+	double maxd, mind, sumd;
+
+	for(t=ULIB_CPU_SCALAR; t<=ulib_cpu_detect(); ++t){
+		ulib_cpu_set_tier(t);
+		k = array__kernels();
+		for(n=1; n<=300; ++n){
+			/* Few distinct values, so ties are common */
+			for(i=0; i!=n; ++i){
+				seed = seed*1103515245u + 12345u;
+				xi[i] = (int)((seed >> 16) % 61) - 30;
+				xd[i] = xi[i]*0.25;
+			}
+			if(n % 7 == 0) xd[n/2] = ULIB_NAN;
+			sum = 0;
+			sumd = 0;
+			imax = imin = imaxd = imind = 0;
+			for(i=0; i!=n; ++i){
+				sum += (unsigned int)xi[i];
+				if(!ULIB_ISNAN(xd[i])) sumd += xd[i];
+				if(xi[imax] < xi[i]) imax = i;
+				if(xi[imin] > xi[i]) imin = i;
+				if(xd[imaxd] < xd[i]) imaxd = i;
+				if(xd[imind] > xd[i]) imind = i;
+			}
+			maxi = xi[imax];
+			mini = xi[imin];
+			maxd = xd[imaxd];
+			mind = xd[imind];
+			if(k->sum_int(xi, n) != (int)sum || k->max_int(xi, n) != maxi || k->min_int(xi, n) != mini
+				|| k->imax_int(xi, n) != imax || k->imin_int(xi, n) != imin){
+				ULIB_FPRINTF(stderr, "Kernels: FAILED (int, %s, n=%u)\n", ulib_cpu_name(t), n);
+				exit(1);
+			}
+			if(k->max_db(xd, n) != maxd || k->min_db(xd, n) != mind
+				|| k->imax_db(xd, n) != imaxd || k->imin_db(xd, n) != imind
+				|| (n % 7 && k->sum_db(xd, n) != sumd)){
+				ULIB_FPRINTF(stderr, "Kernels: FAILED (double, %s, n=%u)\n", ulib_cpu_name(t), n);
+				exit(1);
+			}
+		}
+
+		/* A leading NaN is the result, as in the plain loops */
+		xd[0] = ULIB_NAN;
+		if(!ULIB_ISNAN(k->max_db(xd, 100)) || !ULIB_ISNAN(k->min_db(xd, 100))
+			|| k->imax_db(xd, 100) != 0 || k->imin_db(xd, 100) != 0
+			|| k->sum_int(xi, 0) != 0 || k->max_db(xd, 0) != 0){
+			ULIB_FPRINTF(stderr, "Kernels: FAILED (edges, %s)\n", ulib_cpu_name(t));
+			exit(1);
+		}
+
+		/* Ties between 0 and -0 keep the first, as in the plain loops */
+		for(i=0; i!=4; ++i){
+			for(n=0; n!=40; ++n) xd[n] = i < 2 ? -1.0 : 1.0;
+			xd[2] = i % 2 ? -0.0 : 0.0;
+			xd[8] = i % 2 ? 0.0 : -0.0;
+			maxd = i < 2 ? k->max_db(xd, 40) : k->min_db(xd, 40);
+			if(ULIB_MEMCMP(&maxd, &xd[2], sizeof(double)) != 0){
+				ULIB_FPRINTF(stderr, "Kernels: FAILED (signed zero %u, %s)\n", i, ulib_cpu_name(t));
+				exit(1);
+			}
+		}
+	}
+	ULIB_FPRINTF(stderr, "Kernels: PASSED (up to %s)\n", ulib_cpu_name(ulib_cpu_detect()));
+}
+
+/* describe() on every tier against two plain passes */
+void test_describe(){
+	static int xi[300], big_i[10000];
+	static double xd[300], big_d[10000];
+	const array_kernels* k;
+	const double c_arr[] = {2.0, 4.0, 6.0, 8.0};
+	array_stats st, ref;
+	array* nums;
+	unsigned int t, n, i, seed = 54321;
+	double d, tol, sumd, mean, var;
+
+	for(t=ULIB_CPU_SCALAR; t<=ulib_cpu_detect(); ++t){
+		ulib_cpu_set_tier(t);
+		k = array__kernels();
+		for(n=0; n<=300; ++n){
+			for(i=0; i!=n; ++i){
+				seed = seed*1103515245u + 12345u;
+				xi[i] = (int)((seed >> 16) % 61) - 30 + 1000000;
+				xd[i] = xi[i]*0.25;
+			}
+			if(n % 5 == 0 && n) xd[0] = ULIB_NAN;
+			if(n % 7 == 0 && n) xd[n/2] = ULIB_NAN;
+			if(n % 11 == 0 && n > 2) xd[n - 2] = -ULIB_INF;
+
+			/* Reference over the members that are not NaN */
+			ref.count = ref.nans = ref.infs = ref.imin = ref.imax = 0;
+			ref.sum = 0;
+			for(i=0; i!=n; ++i){
+				if(ULIB_ISNAN(xd[i])){ ref.nans++; continue; }
+				if(ULIB_ISINF(xd[i])) ref.infs++;
+				if(!ref.count++ || xd[i] < xd[ref.imin]) ref.imin = i;
+				if(ref.count == 1 || xd[i] > xd[ref.imax]) ref.imax = i;
+				ref.sum += xd[i];
+			}
+			ref.mean = ref.count ? ref.sum/ref.count : 0;
+			ref.var = 0;
+			for(i=0; i!=n; ++i){
+				if(ULIB_ISNAN(xd[i])) continue;
+				d = xd[i] - ref.mean;
+				ref.var += d*d;
+			}
+			if(ref.count) ref.var /= ref.count;
+
+			k->describe_db(xd, n, &st);
+			tol = 1e-9*(ref.sum < 0 ? -ref.sum : ref.sum);
+			if(st.count != ref.count || st.nans != ref.nans || st.infs != ref.infs
+				|| (ref.count && (st.imin != ref.imin || st.imax != ref.imax
+					|| st.min != xd[ref.imin] || st.max != xd[ref.imax]))
+				|| (ref.infs && (st.sum != -ULIB_INF || !ULIB_ISNAN(st.var)))
+				|| (!ref.infs && (!cmpdb(st.sum, ref.sum, tol + 1e-9)
+					|| !cmpdb(st.mean, ref.mean, 1e-9) || !cmpdb(st.var, ref.var, 1e-9)
+					|| !cmpdb(st.stddev*st.stddev, st.var, 1e-9)))){
+				ULIB_FPRINTF(stderr, "Describe: FAILED (double, %s, n=%u)\n", ulib_cpu_name(t), n);
+				exit(1);
+			}
+
+			sumd = 0;
+			for(i=0; i!=n; ++i) sumd += xi[i];
+			mean = n ? sumd/n : 0;
+			var = 0;
+			for(i=0; i!=n; ++i) var += (xi[i] - mean)*(xi[i] - mean);
+			if(n) var /= n;
+			k->describe_int(xi, n, &st);
+			if(st.count != n || st.nans || st.infs || st.sum != sumd
+				|| !cmpdb(st.mean, mean, 1e-9) || !cmpdb(st.var, var, 1e-9)
+				|| (n && (st.imin != k->imin_int(xi, n) || st.imax != k->imax_int(xi, n)
+					|| st.min != k->min_int(xi, n) || st.max != k->max_int(xi, n)))){
+				ULIB_FPRINTF(stderr, "Describe: FAILED (int, %s, n=%u)\n", ulib_cpu_name(t), n);
+				exit(1);
+			}
+		}
+	}
+
+	/* Several cache chunks, with extremes tied across them */
+	for(n=0; n!=3; ++n){
+		for(i=0; i!=10000; ++i){
+			big_i[i] = (int)((i*2654435761u) >> 20) - 2048;
+			big_d[i] = big_i[i]*0.5;
+		}
+		big_i[5000 + n*2000] = big_i[9000] = -5000;
+		big_d[5000 + n*2000] = big_d[9000] = 5000;
+		big_d[4096*n + 3] = ULIB_NAN;
+		ulib_cpu_set_tier(ULIB_CPU_SCALAR);
+		array__kernels()->describe_int(big_i, 10000, &ref);
+		ulib_cpu_set_tier(ulib_cpu_detect());
+		array__kernels()->describe_int(big_i, 10000, &st);
+		if(st.imin != ref.imin || st.imax != ref.imax || st.min != ref.min || st.max != ref.max
+			|| st.sum != ref.sum || st.imin != 5000 + n*2000){
+			ULIB_FPRINTF(stderr, "Describe: FAILED (int chunks, n=%u)\n", n);
+			exit(1);
+		}
+		ulib_cpu_set_tier(ULIB_CPU_SCALAR);
+		array__kernels()->describe_db(big_d, 10000, &ref);
+		ulib_cpu_set_tier(ulib_cpu_detect());
+		array__kernels()->describe_db(big_d, 10000, &st);
+		if(st.imin != ref.imin || st.imax != ref.imax || st.min != ref.min || st.max != ref.max
+			|| st.nans != 1 || st.imax != 5000 + n*2000 || !cmpdb(st.var, ref.var, 1e-6)){
+			ULIB_FPRINTF(stderr, "Describe: FAILED (double chunks, n=%u)\n", n);
+			exit(1);
+		}
+	}
+
+	nums = array_new(4, TYPE_DOUBLE);
+	nums->from_c_array(nums, c_arr);
+	nums->describe(nums, &st);
+	if(st.count != 4 || st.imin != 0 || st.imax != 3 || st.sum != 20.0
+		|| st.mean != 5.0 || st.var != 5.0 || !cmpdb(st.stddev, 2.2360679775, 1e-9)){
+		ULIB_FPRINTF(stderr, "Describe: FAILED (method)\n");
+		exit(1);
+	}
+	nums->free(nums);
+	ULIB_FPRINTF(stderr, "Describe: PASSED (up to %s)\n", ulib_cpu_name(ulib_cpu_detect()));
+}
+
+/* Arithmetic kernels on every tier against plain loops, then the methods */
+void test_arith(){
+	static int xi[100], yi[100], zi[100], ri[100];
+	static double xd[100], yd[100], zd[100], rd[100];
+	const array_kernels* k;
+	array *a, *b, *c;
+	unsigned int t, n, i, op, seed = 777;
+
+	for(i=0; i!=100; ++i){
+		seed = seed*1103515245u + 12345u;
+		xi[i] = (int)(seed >> 1);
+		yi[i] = (int)((seed >> 8) % 201) - 100;
+		if(!yi[i]) yi[i] = -1;
+		xd[i] = xi[i]*1e-7;
+		yd[i] = yi[i]*0.37;
+	}
+	xi[0] = -2147483647 - 1; /* INT_MIN / -1 wraps */
+	yi[0] = -1;
+
+	for(t=ULIB_CPU_SCALAR; t<=ulib_cpu_detect(); ++t){
+		ulib_cpu_set_tier(t);
+		k = array__kernels();
+		for(n=0; n<=100; n += 1 + n/8){
+			for(op=ARRAY_ADD; op<=ARRAY_DIV; ++op){
+				for(i=0; i!=n; ++i){
+					switch(op){
+						case ARRAY_ADD: ri[i] = (int)((unsigned int)xi[i] + (unsigned int)yi[i]); rd[i] = xd[i] + yd[i]; break;
+						case ARRAY_SUB: ri[i] = (int)((unsigned int)xi[i] - (unsigned int)yi[i]); rd[i] = xd[i] - yd[i]; break;
+						case ARRAY_MUL: ri[i] = (int)((unsigned int)xi[i] * (unsigned int)yi[i]); rd[i] = xd[i] * yd[i]; break;
+						case ARRAY_DIV: ri[i] = yi[i] == -1 ? (int)(0u - (unsigned int)xi[i]) : xi[i]/yi[i]; rd[i] = xd[i] / yd[i]; break;
+					}
+				}
+				k->op_int(zi, xi, yi, n, op);
+				k->op_db(zd, xd, yd, n, op);
+				for(i=0; i!=n && zi[i] == ri[i] && zd[i] == rd[i]; ++i);
+				if(i != n){
+					ULIB_FPRINTF(stderr, "Arithmetic: FAILED (op %u, %s, n=%u)\n", op, ulib_cpu_name(t), n);
+					exit(1);
+				}
+
+				for(i=0; i!=n; ++i){
+					switch(op){
+						case ARRAY_ADD: ri[i] = (int)((unsigned int)xi[i] + 7u); rd[i] = xd[i] + 0.3; break;
+						case ARRAY_SUB: ri[i] = (int)((unsigned int)xi[i] - 7u); rd[i] = xd[i] - 0.3; break;
+						case ARRAY_MUL: ri[i] = (int)((unsigned int)xi[i] * 7u); rd[i] = xd[i] * 0.3; break;
+						case ARRAY_DIV: ri[i] = xi[i]/7; rd[i] = xd[i] / 0.3; break;
+					}
+				}
+				/* In place, as the methods run them */
+				for(i=0; i!=n; ++i){ zi[i] = xi[i]; zd[i] = xd[i]; }
+				k->ops_int(zi, zi, 7, n, op);
+				k->ops_db(zd, zd, 0.3, n, op);
+				for(i=0; i!=n && zi[i] == ri[i] && zd[i] == rd[i]; ++i);
+				if(i != n){
+					ULIB_FPRINTF(stderr, "Arithmetic: FAILED (scalar op %u, %s, n=%u)\n", op, ulib_cpu_name(t), n);
+					exit(1);
+				}
+			}
+
+			for(i=0; i!=n; ++i){ zi[i] = yi[i]; zd[i] = yd[i]; }
+			k->axpy_int(zi, -3, xi, zi, n);
+			k->axpy_db(zd, -3.5, xd, zd, n);
+			for(i=0; i!=n && zi[i] == (int)(0u - 3u*(unsigned int)xi[i] + (unsigned int)yi[i])
+				&& zd[i] == -3.5*xd[i] + yd[i]; ++i);
+			if(i != n){
+				ULIB_FPRINTF(stderr, "Arithmetic: FAILED (axpy, %s, n=%u)\n", ulib_cpu_name(t), n);
+				exit(1);
+			}
+		}
+	}
+
+	a = array_new(10, TYPE_DOUBLE);
+	b = array_new(10, TYPE_DOUBLE);
+	a->linspace(a, 1.0, 1.0);
+	b->fill(b, 2.0);
+	if(a->mul(a, b) != a || a->getf(a, 9) != 20.0 || a->sub_scalar(a, 1.0) != a || a->getf(a, 0) != 1.0
+		|| a->axpy(a, b, 0.5) != a || a->getf(a, 9) != 20.0 || a->div_scalar(a, 4.0) != a || a->getf(a, 1) != 1.0){
+		ULIB_FPRINTF(stderr, "Arithmetic: FAILED (methods)\n");
+		exit(1);
+	}
+	c = array_add(a, b);
+	if(!c || c == a || c->getf(c, 9) != 7.0 || a->getf(a, 9) != 5.0){
+		ULIB_FPRINTF(stderr, "Arithmetic: FAILED (new array)\n");
+		exit(1);
+	}
+	c->free(c);
+	c = array_axpy(b, a, -2.0);
+	if(!c || c->getf(c, 9) != -8.0 || b->getf(b, 9) != 2.0){
+		ULIB_FPRINTF(stderr, "Arithmetic: FAILED (new axpy)\n");
+		exit(1);
+	}
+	c->free(c);
+	b->free(b);
+
+	/* Mismatched operands, and int division by zero */
+	b = array_new(9, TYPE_DOUBLE);
+	c = array_new(10, TYPE_INT);
+	c->linspace(c, 1, 1);
+	if(a->add(a, b) || a->add(a, c) || array_sub(a, c) || c->div_scalar(c, 0) || array_div_scalar(c, 0)){
+		ULIB_FPRINTF(stderr, "Arithmetic: FAILED (mismatch)\n");
+		exit(1);
+	}
+	c->seti(c, 5, 0);
+	if(c->div(c, c) || c->geti(c, 9) != 10 || c->mul_scalar(c, -3) != c || c->geti(c, 9) != -30){
+		ULIB_FPRINTF(stderr, "Arithmetic: FAILED (int)\n");
+		exit(1);
+	}
+	a->free(a);
+	b->free(b);
+	c->free(c);
+	ULIB_FPRINTF(stderr, "Arithmetic: PASSED (up to %s)\n", ulib_cpu_name(ulib_cpu_detect()));
+}
+
 int main(){
 
+	test_cold_kernels(); /* first, before anything picks the kernels */
 	test_new_int();
 	test_fill_int();
 	test_range_int();
@@ -244,6 +585,9 @@ int main(){
 	test_range_double();
 	test_stats_double();
 	test_matherr();
+	test_kernels();
+	test_describe();
+	test_arith();
 
 	return 0;
 }
@@ -0,0 +1,250 @@
+
+
+#define DEFS_IMPLEMENTATION
+#include "../defs.h"
+
+#define BUFLEN 1200
+
+static unsigned char src[BUFLEN], dst[BUFLEN], ref[BUFLEN];
+
+void reset_buffers(){
+	unsigned int i;
+	for(i=0; i!=BUFLEN; ++i){
+		src[i] = (unsigned char)(i*7 + 3);
+		dst[i] = ref[i] = (unsigned char)(i*13 + 1);
+	}
+}
+
+/* naive reference implementation */
+void ref_move(unsigned char* d, const unsigned char* s, unsigned int n){
+	unsigned int i;
+	if(d < s) for(i=0; i!=n; ++i) d[i] = s[i];
+	else for(i=n; i!=0; --i) d[i-1] = s[i-1];
+}
+
+int same(const unsigned char* x, const unsigned char* y, unsigned int n){
+	unsigned int i;
+	for(i=0; i!=n; ++i) if(x[i] != y[i]) return 0;
+	return 1;
+}
+
+void test_memcpy(){
+	unsigned int so, d_o, n;
+	for(so=0; so!=9; ++so)
+	for(d_o=0; d_o!=9; ++d_o)
+	for(n=0; n<BUFLEN-16; n = n < 40 ? n+1 : n*2+5){
+		reset_buffers();
+		ref_move(ref + d_o, src + so, n);
+		if(ULIB_MEMCPY(dst + d_o, src + so, n) != dst + d_o || !same(dst, ref, BUFLEN)){
+			ULIB_FPRINTF(stderr, "Memcpy: FAILED (src+%u, dst+%u, %u bytes)\n", so, d_o, n);
+			exit(1);
+		}
+	}
+	ULIB_FPRINTF(stderr, "Memcpy: PASSED\n");
+}
+
+void test_memmove(){
+	unsigned int so, d_o, n;
+	for(so=0; so<70; so += 3)
+	for(d_o=0; d_o<70; d_o += 5)
+	for(n=0; n<BUFLEN-80; n = n < 40 ? n+1 : n*2+5){
+		reset_buffers();
+		ref_move(ref + d_o, ref + so, n);
+		if(ULIB_MEMMOVE(dst + d_o, dst + so, n) != dst + d_o || !same(dst, ref, BUFLEN)){
+			ULIB_FPRINTF(stderr, "Memmove: FAILED (src+%u, dst+%u, %u bytes)\n", so, d_o, n);
+			exit(1);
+		}
+	}
+	ULIB_FPRINTF(stderr, "Memmove: PASSED\n");
+}
+
+int sign(int x){
+	return (x > 0) - (x < 0);
+}
+
+/* Past the size where copies stream, with an odd tail */
+#define BIGLEN (ULIB_MEMCPY_STREAM_BYTES + 1237)
+#define SHIFT 4099
+
+void fill(unsigned char* p, unsigned int n, unsigned int k){
+	unsigned int i;
+	for(i=0; i!=n; ++i) p[i] = (unsigned char)(i*k + (i >> 12));
+}
+
+/* Large misaligned copies between heap buffers and within one */
+void test_large(){
+	unsigned int len = BIGLEN + SHIFT + 64;
+	unsigned char* a = ULIB_MALLOC(len);
+	unsigned char* b = ULIB_MALLOC(len);
+	unsigned char* r = ULIB_MALLOC(len);
+	if(!a || !b || !r){
+		ULIB_FPRINTF(stderr, "Large copies: FAILED (alloc)\n");
+		exit(1);
+	}
+	fill(a, len, 7);
+
+	fill(b, len, 13);
+	fill(r, len, 13);
+	ref_move(r + 13, a + 3, BIGLEN);
+	if(ULIB_MEMCPY(b + 13, a + 3, BIGLEN) != b + 13 || !same(b, r, len)){
+		ULIB_FPRINTF(stderr, "Large copies: FAILED (memcpy)\n");
+		exit(1);
+	}
+	fill(b, len, 13);
+	fill(r, len, 13);
+	ref_move(r + 1, a + 60, BIGLEN);
+	if(ULIB_MEMMOVE(b + 1, a + 60, BIGLEN) != b + 1 || !same(b, r, len)){
+		ULIB_FPRINTF(stderr, "Large copies: FAILED (memmove apart)\n");
+		exit(1);
+	}
+
+	/* Overlapping, towards the start and then back towards the end */
+	fill(b, len, 13);
+	fill(r, len, 13);
+	ref_move(r + 7, r + 7 + SHIFT, BIGLEN);
+	if(ULIB_MEMMOVE(b + 7, b + 7 + SHIFT, BIGLEN) != b + 7 || !same(b, r, len)){
+		ULIB_FPRINTF(stderr, "Large copies: FAILED (memmove down)\n");
+		exit(1);
+	}
+	ref_move(r + 7 + SHIFT, r + 7, BIGLEN);
+	if(ULIB_MEMMOVE(b + 7 + SHIFT, b + 7, BIGLEN) != b + 7 + SHIFT || !same(b, r, len)){
+		ULIB_FPRINTF(stderr, "Large copies: FAILED (memmove up)\n");
+		exit(1);
+	}
+
+	ULIB_FREE(a);
+	ULIB_FREE(b);
+	ULIB_FREE(r);
+	ULIB_FPRINTF(stderr, "Large copies: PASSED\n");
+}
+
+/* Builds a string of 'n' letters at 'str' */
+void make_str(char* str, unsigned int n){
+	unsigned int i;
+	for(i=0; i!=n; ++i) str[i] = (char)('a' + i%26);
+	str[n] = 0;
+}
+
+void test_strlen(){
+	char buff[300];
+	unsigned int o, n;
+	for(o=0; o!=20; ++o)
+	for(n=0; n!=200; ++n){
+		make_str(buff + o, n);
+		if(ULIB_STRLEN(buff + o) != n){
+			ULIB_FPRINTF(stderr, "Strlen: FAILED (+%u, %u)\n", o, n);
+			exit(1);
+		}
+	}
+	ULIB_FPRINTF(stderr, "Strlen: PASSED\n");
+}
+
+void test_strcmp(){
+	char x[300], y[300];
+	unsigned int xo, yo, n, k;
+	for(xo=0; xo!=17; ++xo)
+	for(yo=0; yo!=17; ++yo)
+	for(n=0; n<120; n+=7){
+		make_str(x + xo, n);
+		make_str(y + yo, n);
+		if(ULIB_STRCMP(x + xo, y + yo) != 0){
+			ULIB_FPRINTF(stderr, "Strcmp: FAILED (equal, %u)\n", n);
+			exit(1);
+		}
+		for(k=0; k<n; k+=5){
+			y[yo+k] = (char)0xF0;
+			if(sign(ULIB_STRCMP(x + xo, y + yo)) != -1 || sign(ULIB_STRCMP(y + yo, x + xo)) != 1){
+				ULIB_FPRINTF(stderr, "Strcmp: FAILED (differ at %u)\n", k);
+				exit(1);
+			}
+			y[yo+k] = x[xo+k];
+		}
+		/* prefix */
+		y[yo+n/2] = 0;
+		if(n && sign(ULIB_STRCMP(x + xo, y + yo)) != 1){
+			ULIB_FPRINTF(stderr, "Strcmp: FAILED (prefix, %u)\n", n);
+			exit(1);
+		}
+	}
+	ULIB_FPRINTF(stderr, "Strcmp: PASSED\n");
+}
+
+void test_strcat(){
+	char buff[100] = "Hello";
+	if(ULIB_STRCAT(buff, ", World!") != buff || ULIB_STRCMP(buff, "Hello, World!") != 0){
+		ULIB_FPRINTF(stderr, "Strcat: FAILED\n");
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "Strcat: PASSED\n");
+}
+
+void test_memchr(){
+	unsigned int o, n, k;
+	reset_buffers();
+	for(o=0; o!=20; ++o)
+	for(n=0; n<300; n = n*2+1)
+	for(k=0; k<n; k+=3){
+		/* src holds i*7+3, which is unique across any 256 bytes */
+		if(n > 256) continue;
+		if(ULIB_MEMCHR(src + o, src[o+k], n) != src + o + k){
+			ULIB_FPRINTF(stderr, "Memchr: FAILED (+%u, %u, %u)\n", o, n, k);
+			exit(1);
+		}
+	}
+	if(ULIB_MEMCHR(src, src[100], 100) != NULL){
+		ULIB_FPRINTF(stderr, "Memchr: FAILED (out of range)\n");
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "Memchr: PASSED\n");
+}
+
+void test_memcmp(){
+	unsigned int o, n, k;
+	for(o=0; o!=9; ++o)
+	for(n=0; n<400; n = n*2+1){
+		reset_buffers();
+		ULIB_MEMCPY(dst + o, src, n);
+		if(ULIB_MEMCMP(dst + o, src, n) != 0){
+			ULIB_FPRINTF(stderr, "Memcmp: FAILED (equal, %u)\n", n);
+			exit(1);
+		}
+		for(k=0; k<n; k+=11){
+			dst[o+k] = (unsigned char)(src[k] + 1);
+			if(sign(ULIB_MEMCMP(dst + o, src, n)) != (src[k] == 255 ? -1 : 1)){
+				ULIB_FPRINTF(stderr, "Memcmp: FAILED (differ at %u)\n", k);
+				exit(1);
+			}
+			dst[o+k] = src[k];
+		}
+	}
+	ULIB_FPRINTF(stderr, "Memcmp: PASSED\n");
+}
+
+void test_cpu_tier(){
+	unsigned int t = ulib_cpu_tier();
+	if(t > ulib_cpu_detect() || ulib_cpu_set_tier(ULIB_CPU_AVX512+1) != ulib_cpu_detect()){
+		ULIB_FPRINTF(stderr, "CPU tier: FAILED\n");
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "CPU tier: PASSED (%s, max %s)\n",
+		ulib_cpu_name(t), ulib_cpu_name(ulib_cpu_detect()));
+}
+
+int main(){
+	unsigned int t;
+
+	test_cpu_tier();
+	/* every tier this machine supports must agree */
+	for(t=ULIB_CPU_SCALAR; t<=ulib_cpu_detect(); ++t){
+		ULIB_FPRINTF(stderr, "-- tier %s\n", ulib_cpu_name(ulib_cpu_set_tier(t)));
+		test_memcpy();
+		test_memmove();
+		test_large();
+		test_strlen();
+		test_strcmp();
+		test_strcat();
+		test_memchr();
+		test_memcmp();
+	}
+	return 0;
+}
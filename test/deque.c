@@ -0,0 +1,156 @@
+#include "../ulib.h"
+
+/* Checks that the deque holds 'n' ints counting up from 'first' */
+static int holds(deque* q, int first, unsigned int n){
+	unsigned int i;
+	if(q->length(q) != n) return 0;
+	for(i=0; i!=n; ++i) if(*(int*)q->at(q, i) != first + (int)i) return 0;
+	return 1;
+}
+
+void test_deque_ends(){
+	deque* q = deque_new(sizeof(int));
+	unsigned int i;
+	int x;
+
+	/* Fronts and backs grow towards each other around the ring */
+	for(i=0; i!=100; ++i){
+		x = (int)i;
+		q->push_back(q, &x);
+		x = -1 - (int)i;
+		q->push_front(q, &x);
+	}
+	if(!holds(q, -100, 200) || *(int*)q->front(q) != -100 || *(int*)q->back(q) != 99
+		|| q->capacity(q) != 256){
+		ULIB_FPRINTF(stderr, "Deque ends: FAILED (push)\n");
+		exit(1);
+	}
+	for(i=0; i!=150; ++i){
+		q->pop_front(q, &x);
+		if(x != -100 + (int)i){
+			ULIB_FPRINTF(stderr, "Deque ends: FAILED (pop_front)\n");
+			exit(1);
+		}
+	}
+	q->pop_back(q, &x);
+	if(x != 99 || !holds(q, 50, 49)){
+		ULIB_FPRINTF(stderr, "Deque ends: FAILED (pop_back)\n");
+		exit(1);
+	}
+
+	/* A queue that keeps wrapping around without growing */
+	for(i=0; i!=10000; ++i){
+		x = 99 + (int)i;
+		q->push_back(q, &x);
+		q->pop_front(q, NULL);
+	}
+	if(!holds(q, 10050, 49) || q->capacity(q) != 256){
+		ULIB_FPRINTF(stderr, "Deque ends: FAILED (queue)\n");
+		exit(1);
+	}
+
+	*(int*)q->emplace_front(q) = 10049;
+	*(int*)q->emplace_back(q) = 10099;
+	x = 0;
+	q->set(q, 0, &x);
+	q->set(q, 0, q->at(q, 1));
+	*(int*)q->at(q, 0) -= 1;
+	if(!holds(q, 10049, 51) || q->at(q, 51) != NULL || q->set(q, 51, &x) != NULL){
+		ULIB_FPRINTF(stderr, "Deque ends: FAILED (emplace)\n");
+		exit(1);
+	}
+
+	q->shrink_to_fit(q);
+	if(q->capacity(q) != 64 || !holds(q, 10049, 51)){
+		ULIB_FPRINTF(stderr, "Deque ends: FAILED (shrink)\n");
+		exit(1);
+	}
+
+	/* Pushing its own members while full, first with the ring wrapped */
+	while(q->length(q) != q->capacity(q)) q->push_front(q, q->front(q));
+	q->push_back(q, q->at(q, 14));
+	while(q->length(q) != q->capacity(q)) q->push_back(q, q->back(q));
+	q->push_front(q, q->back(q));
+	if(q->length(q) != 129 || *(int*)q->front(q) != 10050 || *(int*)q->at(q, 14) != 10049
+		|| *(int*)q->at(q, 15) != 10050 || *(int*)q->at(q, 64) != 10099 || *(int*)q->back(q) != 10050){
+		ULIB_FPRINTF(stderr, "Deque ends: FAILED (own member)\n");
+		exit(1);
+	}
+	q->clear(q);
+	if(q->pop_front(q, &x) != NULL || q->pop_back(q, &x) != NULL || q->front(q) != NULL){
+		ULIB_FPRINTF(stderr, "Deque ends: FAILED (clear)\n");
+		exit(1);
+	}
+	q->shrink_to_fit(q);
+	if(q->capacity(q) != 0 || q->mem(q) != sizeof(deque)){
+		ULIB_FPRINTF(stderr, "Deque ends: FAILED (empty)\n");
+		exit(1);
+	}
+	q->free(q);
+	ULIB_FPRINTF(stderr, "Deque ends: PASSED\n");
+}
+
+void test_deque_spans(){
+	deque* q = deque_new(sizeof(int));
+	int src[300], dest[300];
+	int* p;
+	unsigned int i, n, spans = 0;
+
+	if(deque_new(0) != NULL){
+		ULIB_FPRINTF(stderr, "Deque spans: FAILED (zero size)\n");
+		exit(1);
+	}
+
+	/* Wrap the members around the end of the buffer */
+	for(i=0; i!=300; ++i) src[i] = (int)i;
+	q->reserve(q, 128);
+	q->push_back_array(q, src, 100);
+	if(q->pop_front_array(q, dest, 90) != 90 || dest[89] != 89){
+		ULIB_FPRINTF(stderr, "Deque spans: FAILED (array)\n");
+		exit(1);
+	}
+	q->push_back_array(q, src + 100, 60);
+	if(q->capacity(q) != 128 || !holds(q, 90, 70)){
+		ULIB_FPRINTF(stderr, "Deque spans: FAILED (wrap)\n");
+		exit(1);
+	}
+
+	/* Two runs, in order */
+	for(i=0; (p = q->span(q, i, &n)); i += n){
+		if(*p != 90 + (int)i || *(int*)q->at(q, i + n - 1) != 90 + (int)(i + n - 1)){
+			ULIB_FPRINTF(stderr, "Deque spans: FAILED (span at %u)\n", i);
+			exit(1);
+		}
+		spans++;
+	}
+	if(spans != 2 || i != 70){
+		ULIB_FPRINTF(stderr, "Deque spans: FAILED (runs)\n");
+		exit(1);
+	}
+
+	/* Growing unwraps them */
+	q->push_back_array(q, src + 160, 140);
+	if(q->capacity(q) != 256 || !holds(q, 90, 210) || !q->span(q, 0, &n) || n != 210){
+		ULIB_FPRINTF(stderr, "Deque spans: FAILED (grow)\n");
+		exit(1);
+	}
+
+	/* Room past the largest power of two fails without touching it */
+	if(q->reserve(q, 0x80000001u) != NULL || q->push_back_array(q, src, 0x80000001u - 210) != NULL
+		|| q->capacity(q) != 256 || !holds(q, 90, 210)){
+		ULIB_FPRINTF(stderr, "Deque spans: FAILED (overflow)\n");
+		exit(1);
+	}
+	if(q->pop_front_array(q, dest, 1000) != 210 || dest[209] != 299 || q->length(q) != 0){
+		ULIB_FPRINTF(stderr, "Deque spans: FAILED (drain)\n");
+		exit(1);
+	}
+	q->free(q);
+	ULIB_FPRINTF(stderr, "Deque spans: PASSED\n");
+}
+
+int main(){
+	test_deque_ends();
+	test_deque_spans();
+	return 0;
+}
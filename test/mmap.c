@@ -0,0 +1,115 @@
+#define _GNU_SOURCE
+#define ULIB_MMAP
+#include "../ulib.h"
+
+#define PATH "bin/mmap_test.vec"
+#define N 100000
+
+static long file_size(const char* path){
+	FILE* f = fopen(path, "rb");
+	long n;
+	if(!f) return -1;
+	fseek(f, 0, SEEK_END);
+	n = ftell(f);
+	fclose(f);
+	return n;
+}
+
+void test_mmap_reopen(){
+	vector* v;
+	unsigned int i;
+	double x;
+
+	remove(PATH);
+	v = vector_mmap_open(PATH, sizeof(double));
+	if(!v || v->length(v) != 0){
+		ULIB_FPRINTF(stderr, "Mmap reopen: FAILED (create)\n");
+		exit(1);
+	}
+	for(i=0; i!=N; ++i){
+		x = i * 0.5;
+		v->push(v, &x);
+	}
+	if(!vector_mmap_sync(v, VECTOR_MMAP_SYNC) || !vector_mmap_sync(v, VECTOR_MMAP_ASYNC)){
+		ULIB_FPRINTF(stderr, "Mmap reopen: FAILED (sync)\n");
+		exit(1);
+	}
+	v->free(v);
+	if(file_size(PATH) != (long)(64 + N*sizeof(double))){
+		ULIB_FPRINTF(stderr, "Mmap reopen: FAILED (file size %ld)\n", file_size(PATH));
+		exit(1);
+	}
+
+	/* Members come back as they were, and may keep changing */
+	v = vector_mmap_open(PATH, sizeof(double));
+	if(!v || v->length(v) != N || *(double*)v->at(v, N-1) != (N-1)*0.5){
+		ULIB_FPRINTF(stderr, "Mmap reopen: FAILED (reopen)\n");
+		exit(1);
+	}
+	for(i=0; i!=N/2; ++i) v->pop(v, NULL);
+	x = -1.0;
+	v->insert(v, 0, &x);
+	v->sort(v, sort_cmp_db);
+	v->free(v);
+
+	v = vector_mmap_open(PATH, sizeof(double));
+	if(!v || v->length(v) != N/2 + 1 || *(double*)v->at(v, 0) != -1.0
+		|| *(double*)v->at(v, N/2) != (N/2-1)*0.5){
+		ULIB_FPRINTF(stderr, "Mmap reopen: FAILED (edits)\n");
+		exit(1);
+	}
+	v->resize(v, 0);
+	v->free(v);
+	if(file_size(PATH) != 64){
+		ULIB_FPRINTF(stderr, "Mmap reopen: FAILED (trim)\n");
+		exit(1);
+	}
+
+	/* Emptied and grown again */
+	v = vector_mmap_open(PATH, sizeof(double));
+	x = 3.0;
+	if(!v || v->length(v) != 0 || !v->push(v, &x) || *(double*)v->back(v) != 3.0){
+		ULIB_FPRINTF(stderr, "Mmap reopen: FAILED (empty)\n");
+		exit(1);
+	}
+	v->free(v);
+	ULIB_FPRINTF(stderr, "Mmap reopen: PASSED\n");
+}
+
+void test_mmap_errors(){
+	vector* v;
+	FILE* f;
+
+	/* Members of another size, or not a vector file at all */
+	if(vector_mmap_open(PATH, sizeof(int)) != NULL || vector_mmap_open(PATH, 0) != NULL){
+		ULIB_FPRINTF(stderr, "Mmap errors: FAILED (size)\n");
+		exit(1);
+	}
+	f = fopen(PATH, "wb");
+	fputs("not a vector", f);
+	fclose(f);
+	if(vector_mmap_open(PATH, sizeof(double)) != NULL || file_size(PATH) != 12){
+		ULIB_FPRINTF(stderr, "Mmap errors: FAILED (short file)\n");
+		exit(1);
+	}
+	if(vector_mmap_open("bin/no/such/dir.vec", sizeof(double)) != NULL){
+		ULIB_FPRINTF(stderr, "Mmap errors: FAILED (path)\n");
+		exit(1);
+	}
+
+	/* Only file-backed vectors sync */
+	v = vector_new(sizeof(double));
+	if(vector_mmap_sync(v, VECTOR_MMAP_SYNC) != NULL){
+		ULIB_FPRINTF(stderr, "Mmap errors: FAILED (heap vector)\n");
+		exit(1);
+	}
+	v->free(v);
+	remove(PATH);
+	ULIB_FPRINTF(stderr, "Mmap errors: PASSED\n");
+}
+
+int main(){
+	test_mmap_reopen();
+	test_mmap_errors();
+	return 0;
+}
@@ -0,0 +1,95 @@
+#include "../ulib.h"
+
+void test_pool_objects(){
+	pool* p = pool_new();
+	char *a, *b, *c;
+	unsigned int i;
+
+	/* Objects are aligned and recycled by size class */
+	a = p->alloc(p, 24);
+	b = p->alloc(p, 24);
+	if(!a || !b || a == b || (size_t)a % ULIB_POOL_MIN || (size_t)b % ULIB_POOL_MIN){
+		ULIB_FPRINTF(stderr, "Pool objects: FAILED (alloc)\n");
+		exit(1);
+	}
+	p->release(p, a, 24);
+	if(p->alloc(p, 30) != a){
+		ULIB_FPRINTF(stderr, "Pool objects: FAILED (recycle)\n");
+		exit(1);
+	}
+
+	/* Resizing within a class keeps the object, across classes copies it */
+	ULIB_MEMCPY(a, "pool", 5);
+	if(p->realloc(p, a, 30, 17) != a){
+		ULIB_FPRINTF(stderr, "Pool objects: FAILED (realloc in class)\n");
+		exit(1);
+	}
+	c = p->realloc(p, a, 17, 100);
+	if(!c || c == a || ULIB_STRCMP(c, "pool") != 0){
+		ULIB_FPRINTF(stderr, "Pool objects: FAILED (realloc across classes)\n");
+		exit(1);
+	}
+
+	/* Large objects go to the parent allocator */
+	a = p->alloc(p, ULIB_POOL_MAX + 1);
+	a = p->realloc(p, a, ULIB_POOL_MAX + 1, 10000);
+	a[0] = 'x';
+	c = p->realloc(p, a, 10000, 8);
+	if(!c || c[0] != 'x'){
+		ULIB_FPRINTF(stderr, "Pool objects: FAILED (large)\n");
+		exit(1);
+	}
+
+	/* Chunks grow up to ULIB_POOL_CHUNK */
+	for(i=0; i!=1000; ++i) p->alloc(p, ULIB_POOL_MIN);
+	if(p->bytes(p) == 0 || p->grow[0]*ULIB_POOL_MIN > 2*ULIB_POOL_CHUNK){
+		ULIB_FPRINTF(stderr, "Pool objects: FAILED (growth)\n");
+		exit(1);
+	}
+	p->clear(p);
+	if(p->bytes(p) != 0){
+		ULIB_FPRINTF(stderr, "Pool objects: FAILED (clear)\n");
+		exit(1);
+	}
+	p->free(p);
+	ULIB_FPRINTF(stderr, "Pool objects: PASSED\n");
+}
+
+void test_pool_list(){
+	list* l = list_new();
+	char big[ULIB_POOL_MAX + 10];
+	unsigned int type;
+	int i;
+
+	/* Nodes freed by remove are reused by the next insert */
+	for(i=0; i!=100; ++i) l->insert(l, 0, TYPE_INT, &i);
+	l->remove(l, 0);
+	l->insert(l, 0, TYPE_INT, &i);
+	if(l->length(l) != 100 || *(int*)l->get(l, 0, &type) != 100 || type != TYPE_INT){
+		ULIB_FPRINTF(stderr, "Pool list: FAILED (insert)\n");
+		exit(1);
+	}
+
+	/* Payloads above ULIB_POOL_MAX bypass the pool */
+	ULIB_MEMCPY(big, "large", 6);
+	l->set(l, 5, TYPE_OTHER + sizeof(big), big);
+	if(ULIB_STRCMP(l->get(l, 5, &type), "large") != 0){
+		ULIB_FPRINTF(stderr, "Pool list: FAILED (large payload)\n");
+		exit(1);
+	}
+
+	l->clear(l);
+	if(!l->empty(l) || l->nodes->bytes(l->nodes) != 0){
+		ULIB_FPRINTF(stderr, "Pool list: FAILED (clear)\n");
+		exit(1);
+	}
+	for(i=0; i!=10; ++i) l->append(l, TYPE_INT, &i);
+	l->free(l);
+	ULIB_FPRINTF(stderr, "Pool list: PASSED\n");
+}
+
+int main(){
+	test_pool_objects();
+	test_pool_list();
+	return 0;
+}
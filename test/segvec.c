@@ -0,0 +1,118 @@
+#include "../ulib.h"
+
+typedef struct {
+	int id;
+	char name[13];
+} item;
+
+void test_segvec_growth(){
+	segvec* s = segvec_new(sizeof(int));
+	int* first;
+	int* kept[100];
+	unsigned int i;
+	int x;
+
+	/* Members stay where they are while the segvec grows */
+	first = s->emplace(s);
+	*first = -1;
+	for(i=1; i!=100000; ++i){
+		x = (int)i;
+		if(!s->push(s, &x)){
+			ULIB_FPRINTF(stderr, "Segvec growth: FAILED (push)\n");
+			exit(1);
+		}
+		if(i < 100) kept[i] = s->back(s);
+	}
+	if(s->at(s, 0) != first || *first != -1 || s->length(s) != 100000
+		|| s->capacity(s) < 100000 || s->capacity(s) >= 2*100000 + ULIB_SEGVEC_FIRST){
+		ULIB_FPRINTF(stderr, "Segvec growth: FAILED (stability)\n");
+		exit(1);
+	}
+	for(i=1; i!=100000; ++i){
+		if(*(int*)s->at(s, i) != (int)i || (i < 100 && kept[i] != s->at(s, i))){
+			ULIB_FPRINTF(stderr, "Segvec growth: FAILED (member %u)\n", i);
+			exit(1);
+		}
+	}
+	if(s->at(s, 100000) != NULL || s->set(s, 100000, &x) != NULL){
+		ULIB_FPRINTF(stderr, "Segvec growth: FAILED (range)\n");
+		exit(1);
+	}
+
+	/* Popping keeps the blocks, shrinking frees the empty ones */
+	for(i=0; i!=99990; ++i) s->pop(s, &x);
+	if(x != 10 || s->length(s) != 10 || s->capacity(s) < 100000 || s->at(s, 9) != kept[9]){
+		ULIB_FPRINTF(stderr, "Segvec growth: FAILED (pop)\n");
+		exit(1);
+	}
+	s->shrink_to_fit(s);
+	if(s->capacity(s) != ULIB_SEGVEC_FIRST || s->at(s, 9) != kept[9]){
+		ULIB_FPRINTF(stderr, "Segvec growth: FAILED (shrink)\n");
+		exit(1);
+	}
+	s->clear(s);
+	if(s->pop(s, &x) != NULL || s->back(s) != NULL || s->length(s) != 0){
+		ULIB_FPRINTF(stderr, "Segvec growth: FAILED (clear)\n");
+		exit(1);
+	}
+	s->shrink_to_fit(s);
+	if(s->capacity(s) != 0 || s->mem(s) != sizeof(segvec)){
+		ULIB_FPRINTF(stderr, "Segvec growth: FAILED (empty)\n");
+		exit(1);
+	}
+	s->free(s);
+	ULIB_FPRINTF(stderr, "Segvec growth: PASSED\n");
+}
+
+void test_segvec_spans(){
+	segvec* s = segvec_new(sizeof(item));
+	item it, *p;
+	unsigned int i, n, total = 0, spans = 0;
+
+	if(segvec_new(0) != NULL){
+		ULIB_FPRINTF(stderr, "Segvec spans: FAILED (zero size)\n");
+		exit(1);
+	}
+
+	s->resize(s, 1000);
+	for(i=0; i!=1000; ++i){
+		it.id = (int)i;
+		ULIB_SPRINTF(it.name, "item %u", i);
+		s->set(s, i, &it);
+	}
+
+	/* Spans cover every member once, in order, one per block */
+	for(i=0; (p = s->span(s, i, &n)); i += n){
+		if(n == 0 || p->id != (int)i || ((item*)s->at(s, i + n - 1))->id != (int)(i + n - 1)
+			|| (char*)s->at(s, i + n - 1) != (char*)p + (n-1)*sizeof(item)){
+			ULIB_FPRINTF(stderr, "Segvec spans: FAILED (span at %u)\n", i);
+			exit(1);
+		}
+		total += n;
+		spans++;
+	}
+	if(total != 1000 || spans != s->nblocks || n != 0){
+		ULIB_FPRINTF(stderr, "Segvec spans: FAILED (cover)\n");
+		exit(1);
+	}
+	p = s->at(s, 777);
+	if(p->id != 777 || ULIB_STRCMP(p->name, "item 777") != 0){
+		ULIB_FPRINTF(stderr, "Segvec spans: FAILED (payload)\n");
+		exit(1);
+	}
+
+	/* Reserving allocates blocks ahead without moving members */
+	s->reserve(s, 50000);
+	if(s->capacity(s) < 50000 || s->at(s, 777) != p || s->length(s) != 1000){
+		ULIB_FPRINTF(stderr, "Segvec spans: FAILED (reserve)\n");
+		exit(1);
+	}
+	s->free(s);
+	ULIB_FPRINTF(stderr, "Segvec spans: PASSED\n");
+}
+
+int main(){
+	test_segvec_growth();
+	test_segvec_spans();
+	return 0;
+}
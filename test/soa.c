@@ -0,0 +1,103 @@
+#include "../ulib.h"
+
+struct record {
+	double ts;
+	int id;
+	char tag[10];
+};
+
+void test_soa_rows(){
+	soa_field schema[] = {{TYPE_DOUBLE, 0}, {TYPE_INT, 0}, {TYPE_STR_10, 0}};
+	struct record r, out;
+	soa* s = soa_new(schema, 3);
+	int i;
+
+	if(!s || s->fields(s) != 3 || s->field_size(s, 0) != sizeof(double)
+		|| s->field_size(s, 2) != 10 || s->field_size(s, 3) != 0){
+		ULIB_FPRINTF(stderr, "Soa rows: FAILED (schema)\n");
+		exit(1);
+	}
+	for(i=0; i!=1000; ++i){
+		r.ts = i*0.25;
+		r.id = -i;
+		sprintf(r.tag, "r%d", i);
+		if(!s->push(s, &r.ts, &r.id, r.tag)){
+			ULIB_FPRINTF(stderr, "Soa rows: FAILED (push)\n");
+			exit(1);
+		}
+	}
+	if(s->length(s) != 1000 || s->capacity(s) < 1000){
+		ULIB_FPRINTF(stderr, "Soa rows: FAILED (length)\n");
+		exit(1);
+	}
+
+	/* Rows come back whole, fields one at a time */
+	s->gather(s, 777, &out.ts, &out.id, out.tag);
+	if(out.ts != 777*0.25 || out.id != -777 || ULIB_STRCMP(out.tag, "r777") != 0
+		|| *(int*)s->at(s, 12, 1) != -12 || s->at(s, 1000, 0) != NULL || s->at(s, 0, 3) != NULL){
+		ULIB_FPRINTF(stderr, "Soa rows: FAILED (gather)\n");
+		exit(1);
+	}
+	out.id = 5;
+	s->set(s, 3, 1, &out.id);
+	s->gather(s, 3, NULL, &i, NULL);
+	if(i != 5 || s->gather(s, 1000, NULL, NULL, NULL) != NULL || s->set(s, 1000, 0, &out.ts) != NULL){
+		ULIB_FPRINTF(stderr, "Soa rows: FAILED (set)\n");
+		exit(1);
+	}
+
+	s->pop(s);
+	s->resize(s, 500);
+	if(s->length(s) != 500 || *(double*)s->at(s, 499, 0) != 499*0.25){
+		ULIB_FPRINTF(stderr, "Soa rows: FAILED (resize)\n");
+		exit(1);
+	}
+	s->clear(s);
+	if(s->length(s) != 0 || s->pop(s) != NULL){
+		ULIB_FPRINTF(stderr, "Soa rows: FAILED (clear)\n");
+		exit(1);
+	}
+	s->free(s);
+	ULIB_FPRINTF(stderr, "Soa rows: PASSED\n");
+}
+
+void test_soa_columns(){
+	soa_field schema[] = {{TYPE_INT, 0}, {TYPE_DOUBLE, 0}, {TYPE_OTHER, 24}};
+	char blob[24] = {0};
+	soa* s = soa_new(schema, 3);
+	const array_kernels* k = array__kernels();
+	double x;
+	int i, sum = 0;
+
+	for(i=0; i!=5000; ++i){
+		x = (i % 7) - 3.5;
+		s->push(s, &i, &x, blob);
+		sum += i;
+	}
+
+	/* Columns are plain C arrays, fit for the array.h kernels */
+	if(s->field_size(s, 2) != 24
+		|| k->sum_int(s->column(s, 0), s->length(s)) != sum
+		|| k->max_int(s->column(s, 0), s->length(s)) != 4999
+		|| k->min_db(s->column(s, 1), s->length(s)) != -3.5
+		|| k->imax_db(s->column(s, 1), s->length(s)) != 6
+		|| s->column(s, 3) != NULL){
+		ULIB_FPRINTF(stderr, "Soa columns: FAILED\n");
+		exit(1);
+	}
+	s->free(s);
+
+	/* Schemas with nothing to size */
+	schema[0].type = TYPE_OTHER + 1;
+	if(soa_new(schema, 3) != NULL || soa_new(schema, 0) != NULL){
+		ULIB_FPRINTF(stderr, "Soa columns: FAILED (schema)\n");
+		exit(1);
+	}
+	ULIB_FPRINTF(stderr, "Soa columns: PASSED\n");
+}
+
+int main(){
+	test_soa_rows();
+	test_soa_columns();
+	return 0;
+}
@@ -0,0 +1,316 @@
+#include "../ulib.h"
+#include <limits.h>
+
+#define N 5000
+
+/* Small deterministic generator, so failures can be reproduced */
+static unsigned long seed = 12345;
+static unsigned int next_rand(){
+	seed = seed*1103515245UL + 12345UL;
+	return (unsigned int)(seed >> 16) & 0x7FFF;
+}
+
+typedef struct {
+	int key;
+	char name[20];
+} record;
+
+static int cmp_record(const void* a, const void* b){
+	return sort_cmp_int(&((const record*)a)->key, &((const record*)b)->key);
+}
+
+/* Fills 'a' with one of several input patterns */
+static void fill_pattern(int* a, unsigned int n, unsigned int pattern){
+	unsigned int i;
+	for(i=0; i!=n; ++i){
+		switch(pattern){
+			case 0: a[i] = (int)next_rand() - 16000; break;  /* random */
+			case 1: a[i] = (int)i; break;                    /* sorted */
+			case 2: a[i] = (int)(n - i); break;              /* reversed */
+			case 3: a[i] = (int)(next_rand() % 4); break;    /* few keys */
+			case 4: a[i] = 7; break;                         /* all equal */
+			case 5: a[i] = (int)(i < n/2 ? i : n - i); break; /* organ pipe */
+			default: a[i] = (int)(i ^ 0x55); break;          /* sawtooth */
+		}
+	}
+}
+
+static int is_sorted_int(const int* a, unsigned int n){
+	unsigned int i;
+	for(i=1; i<n; ++i) if(a[i-1] > a[i]) return 0;
+	return 1;
+}
+
+static long sum_int(const int* a, unsigned int n){
+	long s = 0;
+	unsigned int i;
+	for(i=0; i!=n; ++i) s += a[i];
+	return s;
+}
+
+void test_sort_pdq(){
+	static int a[N];
+	static record r[N/4];
+	unsigned int p, i, n;
+	long sum;
+
+	for(p=0; p!=7; ++p){
+		for(n=0; n<=N; n = n ? n*4 : 1){
+			fill_pattern(a, n, p);
+			sum = sum_int(a, n);
+			sort_pdq(a, n, sizeof(int), sort_cmp_int);
+			if(!is_sorted_int(a, n) || sum_int(a, n) != sum){
+				ULIB_FPRINTF(stderr, "Sort pdq: FAILED (pattern %u, %u members)\n", p, n);
+				exit(1);
+			}
+		}
+	}
+
+	/* Members of an odd size, carrying their payload along */
+	for(i=0; i!=N/4; ++i){
+		r[i].key = (int)(next_rand() % 100);
+		ULIB_SPRINTF(r[i].name, "%d", r[i].key);
+	}
+	sort_pdq(r, N/4, sizeof(record), cmp_record);
+	for(i=0; i!=N/4; ++i){
+		if((i && r[i-1].key > r[i].key) || atoi(r[i].name) != r[i].key){
+			ULIB_FPRINTF(stderr, "Sort pdq: FAILED (records)\n");
+			exit(1);
+		}
+	}
+	ULIB_FPRINTF(stderr, "Sort pdq: PASSED\n");
+}
+
+void test_sort_radix(){
+	static int a[N];
+	static double d[N];
+	unsigned int p, i, n;
+	long sum;
+
+	for(p=0; p!=7; ++p){
+		for(n=0; n<=N; n = n ? n*4 : 1){
+			fill_pattern(a, n, p);
+			sum = sum_int(a, n);
+			sort_radix_int(a, n, NULL);
+			if(!is_sorted_int(a, n) || sum_int(a, n) != sum){
+				ULIB_FPRINTF(stderr, "Sort radix: FAILED (int pattern %u, %u members)\n", p, n);
+				exit(1);
+			}
+		}
+	}
+
+	/* Extremes of int */
+	a[0] = 0; a[1] = -1; a[2] = INT_MIN; a[3] = INT_MAX;
+	for(i=4; i!=100; ++i) a[i] = (int)next_rand() - 16000;
+	sort_radix_int(a, 100, NULL);
+	if(!is_sorted_int(a, 100) || a[0] != INT_MIN || a[99] != INT_MAX){
+		ULIB_FPRINTF(stderr, "Sort radix: FAILED (int limits)\n");
+		exit(1);
+	}
+
+	/* Doubles of both signs, zeros and infinities */
+	for(n=10; n<=N; n*=10){
+		for(i=0; i!=n; ++i) d[i] = ((double)next_rand() - 16000.0) / 7.0;
+		d[0] = ULIB_INF; d[1] = -ULIB_INF; d[2] = 0.0; d[3] = -0.0;
+		sort_radix_db(d, n, NULL);
+		for(i=1; i<n; ++i){
+			if(d[i-1] > d[i]){
+				ULIB_FPRINTF(stderr, "Sort radix: FAILED (double, %u members)\n", n);
+				exit(1);
+			}
+		}
+		if(d[0] != -ULIB_INF || d[n-1] != ULIB_INF){
+			ULIB_FPRINTF(stderr, "Sort radix: FAILED (double limits)\n");
+			exit(1);
+		}
+	}
+	ULIB_FPRINTF(stderr, "Sort radix: PASSED\n");
+}
+
+void test_sort_containers(){
+	vector* v = vector_new(sizeof(double));
+	array* arr = array_new(300, TYPE_INT);
+	double x;
+	unsigned int i;
+
+	for(i=0; i!=300; ++i){
+		x = (double)next_rand() / 3.0;
+		v->push(v, &x);
+		arr->seti(arr, i, (int)next_rand() - 16000);
+	}
+	v->sort(v, sort_cmp_db);
+	arr->sort(arr);
+	for(i=1; i!=300; ++i){
+		if(*(double*)v->at(v, i-1) > *(double*)v->at(v, i)){
+			ULIB_FPRINTF(stderr, "Sort containers: FAILED (vector)\n");
+			exit(1);
+		}
+		if(arr->geti(arr, i-1) > arr->geti(arr, i)){
+			ULIB_FPRINTF(stderr, "Sort containers: FAILED (array)\n");
+			exit(1);
+		}
+	}
+	v->free(v);
+	arr->free(arr);
+	ULIB_FPRINTF(stderr, "Sort containers: PASSED\n");
+}
+
+/* Long enough to take the threaded path, built with ULIB_THREADS */
+#define NP (ULIB_SORT_PARALLEL_MIN*3 + 7)
+
+void test_sort_parallel(){
+	static int a[NP];
+	static double d[NP];
+	static record r[NP];
+	unsigned int threads[] = {0, 1, 3, 8};
+	unsigned int p, t, i;
+	vector* v;
+	array* arr;
+	long sum;
+
+	for(t=0; t!=sizeof(threads)/sizeof(threads[0]); ++t){
+		for(p=0; p!=7; ++p){
+			fill_pattern(a, NP, p);
+			sum = sum_int(a, NP);
+			sort_parallel_int(a, NP, threads[t], NULL);
+			if(!is_sorted_int(a, NP) || sum_int(a, NP) != sum){
+				ULIB_FPRINTF(stderr, "Sort parallel: FAILED (int pattern %u, %u threads)\n", p, threads[t]);
+				exit(1);
+			}
+			fill_pattern(a, NP, p);
+			sum = sum_int(a, NP);
+			sort_parallel(a, NP, sizeof(int), sort_cmp_int, threads[t], NULL);
+			if(!is_sorted_int(a, NP) || sum_int(a, NP) != sum){
+				ULIB_FPRINTF(stderr, "Sort parallel: FAILED (pattern %u, %u threads)\n", p, threads[t]);
+				exit(1);
+			}
+		}
+
+		for(i=0; i!=NP; ++i) d[i] = ((double)next_rand() - 16000.0) / 7.0;
+		d[5] = ULIB_INF; d[6] = -ULIB_INF; d[7] = 0.0; d[8] = -0.0;
+		sort_parallel_db(d, NP, threads[t], NULL);
+		for(i=1; i!=NP; ++i){
+			if(d[i-1] > d[i]){
+				ULIB_FPRINTF(stderr, "Sort parallel: FAILED (double, %u threads)\n", threads[t]);
+				exit(1);
+			}
+		}
+
+		for(i=0; i!=NP; ++i){
+			r[i].key = (int)(next_rand() % 1000);
+			ULIB_SPRINTF(r[i].name, "%d", r[i].key);
+		}
+		sort_parallel(r, NP, sizeof(record), cmp_record, threads[t], NULL);
+		for(i=0; i!=NP; ++i){
+			if((i && r[i-1].key > r[i].key) || atoi(r[i].name) != r[i].key){
+				ULIB_FPRINTF(stderr, "Sort parallel: FAILED (records, %u threads)\n", threads[t]);
+				exit(1);
+			}
+		}
+	}
+
+	/* Through the containers */
+	v = vector_new(sizeof(int));
+	arr = array_new(NP, TYPE_DOUBLE);
+	fill_pattern(a, NP, 0);
+	v->append_array(v, a, NP);
+	for(i=0; i!=NP; ++i) arr->setf(arr, i, (double)a[i] / 3.0);
+	v->sort_parallel(v, sort_cmp_int, 4);
+	arr->sort_parallel(arr, 4);
+	if(!is_sorted_int(v->data(v), NP)){
+		ULIB_FPRINTF(stderr, "Sort parallel: FAILED (vector)\n");
+		exit(1);
+	}
+	for(i=1; i!=NP; ++i){
+		if(arr->getf(arr, i-1) > arr->getf(arr, i)){
+			ULIB_FPRINTF(stderr, "Sort parallel: FAILED (array)\n");
+			exit(1);
+		}
+	}
+	v->free(v);
+	arr->free(arr);
+	ULIB_FPRINTF(stderr, "Sort parallel: PASSED\n");
+}
+
+/* Linear lower and upper bounds to check the searches against */
+static unsigned int scan_bound(const int* a, unsigned int n, int key, int upper){
+	unsigned int i;
+	for(i=0; i!=n; ++i) if(upper ? a[i] > key : a[i] >= key) break;
+	return i;
+}
+
+void test_sort_search(){
+	static int a[N], e[N];
+	static double d[N], ed[N];
+	unsigned int n, i, lo, hi, end, r;
+	int key;
+	vector* v;
+	array* arr;
+
+	for(n=0; n<=N; n = n ? n*3 + 1 : 1){
+		for(i=0; i!=n; ++i) a[i] = (int)(next_rand() % (n + 1)) * 2;
+		sort_radix_int(a, n, NULL);
+		for(i=0; i!=n; ++i) d[i] = (double)a[i] / 4.0;
+		sort_eytzinger(a, e, n, sizeof(int));
+		sort_eytzinger(d, ed, n, sizeof(double));
+
+		/* Keys between, equal to and beyond every member */
+		for(key=-1; key <= (int)n*2 + 2; ++key){
+			lo = scan_bound(a, n, key, 0);
+			hi = scan_bound(a, n, key, 1);
+			if(sort_lower_bound(a, n, sizeof(int), &key, sort_cmp_int) != lo
+				|| sort_upper_bound(a, n, sizeof(int), &key, sort_cmp_int) != hi
+				|| sort_equal_range(a, n, sizeof(int), &key, sort_cmp_int, &end) != lo || end != hi
+				|| sort_lower_bound_int(a, n, key) != lo
+				|| sort_upper_bound_int(a, n, key) != hi
+				|| sort_lower_bound_db(d, n, key/4.0) != lo
+				|| sort_upper_bound_db(d, n, key/4.0) != hi){
+				ULIB_FPRINTF(stderr, "Sort search: FAILED (%u members, key %d)\n", n, key);
+				exit(1);
+			}
+
+			/* Eytzinger searches return where in the layout that member went */
+			r = sort_eytzinger_lower_bound_int(e, n, key);
+			if((r == n) != (lo == n) || (r != n && e[r] != a[lo])
+				|| sort_eytzinger_lower_bound(e, n, sizeof(int), &key, sort_cmp_int) != r){
+				ULIB_FPRINTF(stderr, "Sort search: FAILED (eytzinger, %u members, key %d)\n", n, key);
+				exit(1);
+			}
+			r = sort_eytzinger_lower_bound_db(ed, n, key/4.0);
+			if((r == n) != (lo == n) || (r != n && ed[r] != d[lo])){
+				ULIB_FPRINTF(stderr, "Sort search: FAILED (eytzinger double, %u members)\n", n);
+				exit(1);
+			}
+		}
+	}
+
+	/* Through the containers */
+	v = vector_new(sizeof(int));
+	arr = array_new(100, TYPE_DOUBLE);
+	for(i=0; i!=100; ++i){
+		key = (int)(i/10);
+		v->push(v, &key);
+		arr->setf(arr, i, (double)(i/10));
+	}
+	key = 4;
+	if(v->lower_bound(v, &key, sort_cmp_int) != 40 || v->upper_bound(v, &key, sort_cmp_int) != 50
+		|| v->equal_range(v, &key, sort_cmp_int, &end) != 40 || end != 50
+		|| arr->lower_bound(arr, 4.0) != 40 || arr->upper_bound(arr, 4.0) != 50
+		|| arr->equal_range(arr, &end, 4.5) != 50 || end != 50
+		|| arr->lower_bound(arr, 10.0) != 100){
+		ULIB_FPRINTF(stderr, "Sort search: FAILED (containers)\n");
+		exit(1);
+	}
+	v->free(v);
+	arr->free(arr);
+	ULIB_FPRINTF(stderr, "Sort search: PASSED\n");
+}
+
+int main(){
+	test_sort_pdq();
+	test_sort_radix();
+	test_sort_containers();
+	test_sort_parallel();
+	test_sort_search();
+	return 0;
+}
@@ -5,8 +5,300 @@
 
 #include <stdio.h>
 
+typedef struct {
+	int key;
+	double weight;
+} event;
+
+#define EVENT_LESS(a, b) ((a).key < (b).key)
+
+VECTOR_DECLARE_LESS(vec_int, int, VECTOR_LESS)
+VECTOR_DECLARE_LESS(vec_event, event, EVENT_LESS)
+
+int cmp_int_desc(const int* a, const int* b){
+	return (*a < *b) - (*a > *b);
+}
+
+void test_vector_capacity(){
+	vector* v = vector_new(sizeof(int));
+	unsigned int i, reallocs = 0, cap = 0;
+
+	if(vector_new(0) != NULL || vector_new_inline(0, 64) != NULL){
+		fprintf(stderr, "Vector capacity: FAILED (zero size)\n");
+		exit(1);
+	}
+
+	/* Appending N members takes O(log N) reallocations */
+	for(i=0; i!=1000; ++i){
+		v->insert(v, v->length(v), &i);
+		if(v->capacity(v) != cap){
+			cap = v->capacity(v);
+			reallocs++;
+		}
+	}
+	if(reallocs > 10 || v->capacity(v) < 1000 || *(int*)v->at(v, 999) != 999){
+		fprintf(stderr, "Vector capacity: FAILED (growth)\n");
+		exit(1);
+	}
+
+	/* Deleting keeps the storage until a quarter full */
+	for(i=0; i!=500; ++i) v->delete(v, v->length(v)-1);
+	if(v->capacity(v) != cap){
+		fprintf(stderr, "Vector capacity: FAILED (hysteresis)\n");
+		exit(1);
+	}
+	for(i=0; i!=300; ++i) v->delete(v, v->length(v)-1);
+	if(v->capacity(v) >= cap || v->capacity(v) < v->length(v)){
+		fprintf(stderr, "Vector capacity: FAILED (shrink)\n");
+		exit(1);
+	}
+
+	v->reserve(v, 5000);
+	if(v->capacity(v) != 5000 || v->length(v) != 200 || *(int*)v->at(v, 199) != 199){
+		fprintf(stderr, "Vector capacity: FAILED (reserve)\n");
+		exit(1);
+	}
+	v->shrink_to_fit(v);
+	if(v->capacity(v) != 200){
+		fprintf(stderr, "Vector capacity: FAILED (shrink_to_fit)\n");
+		exit(1);
+	}
+	v->resize(v, 0);
+	if(v->capacity(v) != 0 || v->data(v) != NULL){
+		fprintf(stderr, "Vector capacity: FAILED (resize)\n");
+		exit(1);
+	}
+	v->free(v);
+	fprintf(stderr, "Vector capacity: PASSED\n");
+}
+
+void test_vector_push(){
+	vector* v = vector_new(sizeof(double));
+	double x, *slot;
+	unsigned int i;
+
+	for(i=0; i!=100; ++i){
+		x = i*0.5;
+		v->push(v, &x);
+	}
+	slot = v->emplace(v);
+	*slot = -1.0;
+	if(v->length(v) != 101 || *(double*)v->back(v) != -1.0 || *(double*)v->at(v, 99) != 49.5){
+		fprintf(stderr, "Vector push: FAILED (push)\n");
+		exit(1);
+	}
+
+	v->pop(v, NULL);
+	v->pop(v, &x);
+	if(x != 49.5 || v->length(v) != 99 || *(double*)v->back(v) != 49.0){
+		fprintf(stderr, "Vector push: FAILED (pop)\n");
+		exit(1);
+	}
+	while(v->pop(v, &x));
+	if(v->length(v) != 0 || x != 0.0 || v->back(v) != NULL){
+		fprintf(stderr, "Vector push: FAILED (empty)\n");
+		exit(1);
+	}
+
+	/* Pushing its own members across every regrowth, member j holding j+1 */
+	x = 1.0;
+	v->push(v, &x);
+	for(i=1; i!=1000; ++i){
+		v->push(v, v->at(v, i/2));
+		if(*(double*)v->back(v) != i/2 + 1.0){
+			fprintf(stderr, "Vector push: FAILED (own member %u)\n", i);
+			exit(1);
+		}
+		*(double*)v->back(v) = i + 1.0;
+	}
+	v->push(v, v->back(v));
+	if(v->length(v) != 1001 || *(double*)v->back(v) != 1000.0){
+		fprintf(stderr, "Vector push: FAILED (own back)\n");
+		exit(1);
+	}
+	v->free(v);
+	fprintf(stderr, "Vector push: PASSED\n");
+}
+
+void test_vector_range(){
+	vector* v = vector_new(sizeof(int));
+	int a[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+	int b[] = {-1, -2, -3};
+	int expect[] = {0, 1, -1, -2, -3, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1};
+	int x = 100, e[20];
+	unsigned int i, s, n, j, k;
+
+	v->append_array(v, a, 10);
+	v->insert_range(v, 2, b, 3);
+	v->append_array(v, a, 2);
+	for(i=0; i!=15; ++i){
+		if(*(int*)v->at(v, i) != expect[i]){
+			fprintf(stderr, "Vector range: FAILED (insert)\n");
+			exit(1);
+		}
+	}
+	if(v->insert_range(v, 16, b, 1) || !v->insert_range(v, 0, b, 0)){
+		fprintf(stderr, "Vector range: FAILED (bounds)\n");
+		exit(1);
+	}
+
+	/* Drop the inserted block, the tail, and then a middle member */
+	v->erase_range(v, 2, 3);
+	v->erase_range(v, 10, 2);
+	v->delete(v, 4);
+	v->insert(v, 0, &x);
+	if(v->length(v) != 10 || *(int*)v->at(v, 0) != 100 || *(int*)v->at(v, 4) != 3
+		|| *(int*)v->at(v, 5) != 5 || *(int*)v->back(v) != 9){
+		fprintf(stderr, "Vector range: FAILED (erase)\n");
+		exit(1);
+	}
+	if(v->erase_range(v, 5, 6) || v->erase_range(v, 10, 0)){
+		fprintf(stderr, "Vector range: FAILED (erase bounds)\n");
+		exit(1);
+	}
+	v->erase_range(v, 0, 10);
+	if(v->length(v) != 0){
+		fprintf(stderr, "Vector range: FAILED (erase all)\n");
+		exit(1);
+	}
+
+	/* Inserting its own members before, around and after 'j', with and without regrowth */
+	for(s=0; s!=10; ++s)
+	for(n=1; n<=10-s; ++n)
+	for(j=0; j<=10; ++j){
+		v->erase_range(v, 0, v->length(v));
+		v->shrink_to_fit(v);
+		if((s+n+j) % 2) v->reserve(v, 20);
+		v->append_array(v, a, 10);
+		v->insert_range(v, j, v->at(v, s), n);
+		for(k=0; k!=j; ++k) e[k] = a[k];
+		for(k=0; k!=n; ++k) e[j+k] = a[s+k];
+		for(k=j; k!=10; ++k) e[n+k] = a[k];
+		for(k=0; k!=10+n && *(int*)v->at(v, k) == e[k]; ++k);
+		if(v->length(v) != 10+n || k != 10+n){
+			fprintf(stderr, "Vector range: FAILED (own members %u+%u at %u)\n", s, n, j);
+			exit(1);
+		}
+	}
+	v->insert(v, 0, v->at(v, 3));
+	if(*(int*)v->at(v, 0) != 3 || *(int*)v->at(v, 4) != 3 || v->length(v) != 12){
+		fprintf(stderr, "Vector range: FAILED (own member)\n");
+		exit(1);
+	}
+	v->free(v);
+	fprintf(stderr, "Vector range: PASSED\n");
+}
+
+void test_vector_inline(){
+	vector* v = vector_new_inline(sizeof(int), 4*sizeof(int));
+	char* buf = (char*)v->data(v);
+	int i, x;
+
+	/* Starts in the inline buffer, with its capacity */
+	if(!buf || v->capacity(v) != 4 || v->length(v) != 0){
+		fprintf(stderr, "Vector inline: FAILED (new)\n");
+		exit(1);
+	}
+	for(i=0; i!=4; ++i) v->push(v, &i);
+	if(v->data(v) != buf || v->mem(v) != (unsigned int)(buf - (char*)v) + 4*sizeof(int)){
+		fprintf(stderr, "Vector inline: FAILED (inline)\n");
+		exit(1);
+	}
+
+	/* Spills to the heap, and comes back once small again */
+	for(i=4; i!=40; ++i) v->push(v, &i);
+	if(v->data(v) == buf || v->capacity(v) < 40){
+		fprintf(stderr, "Vector inline: FAILED (spill)\n");
+		exit(1);
+	}
+	for(i=0; i!=20; ++i) v->delete(v, 0);
+	v->erase_range(v, 3, 17);
+	v->shrink_to_fit(v);
+	if(v->data(v) != buf || v->capacity(v) != 4 || v->length(v) != 3){
+		fprintf(stderr, "Vector inline: FAILED (back inline)\n");
+		exit(1);
+	}
+	for(i=0; i!=3; ++i){
+		v->pop(v, &x);
+		if(x != 22 - i){
+			fprintf(stderr, "Vector inline: FAILED (members)\n");
+			exit(1);
+		}
+	}
+	v->free(v);
+
+	/* No inline room behaves as a plain vector */
+	v = vector_new_inline(sizeof(double), 4);
+	if(v->data(v) || v->capacity(v) != 0){
+		fprintf(stderr, "Vector inline: FAILED (too small)\n");
+		exit(1);
+	}
+	v->free(v);
+	fprintf(stderr, "Vector inline: PASSED\n");
+}
+
+void test_vector_typed(){
+	vec_int v;
+	vec_event e;
+	event x;
+	unsigned int i;
+
+	vec_int_init(&v);
+	for(i=0; i!=1000; ++i) vec_int_push(&v, (int)((i*2654435761u) >> 8) % 500);
+	vec_int_insert(&v, 0, -1);
+	vec_int_erase(&v, 1, 10);
+	if(v.len != 991 || *vec_int_at(&v, 0) != -1 || vec_int_insert(&v, 992, 0)){
+		fprintf(stderr, "Vector typed: FAILED (edit)\n");
+		exit(1);
+	}
+	vec_int_sort_less(&v);
+	for(i=1; i<v.len; ++i){
+		if(v.d[i-1] > v.d[i]){
+			fprintf(stderr, "Vector typed: FAILED (sort_less)\n");
+			exit(1);
+		}
+	}
+	vec_int_sort(&v, cmp_int_desc);
+	for(i=1; i<v.len; ++i){
+		if(v.d[i-1] < v.d[i]){
+			fprintf(stderr, "Vector typed: FAILED (sort)\n");
+			exit(1);
+		}
+	}
+	if(vec_int_pop(&v) != -1 || v.len != 990){
+		fprintf(stderr, "Vector typed: FAILED (pop)\n");
+		exit(1);
+	}
+	vec_int_free(&v);
+
+	/* Structs, sorted on one field */
+	vec_event_init(&e);
+	vec_event_reserve(&e, 100);
+	for(i=0; i!=100; ++i){
+		x.key = (int)(i*37 % 100);
+		x.weight = i;
+		vec_event_push(&e, x);
+	}
+	vec_event_sort_less(&e);
+	for(i=0; i!=100; ++i){
+		if(e.d[i].key != (int)i || e.d[i].weight != (double)((i*73) % 100)){
+			fprintf(stderr, "Vector typed: FAILED (struct)\n");
+			exit(1);
+		}
+	}
+	vec_event_shrink_to_fit(&e);
+	vec_event_free(&e);
+	fprintf(stderr, "Vector typed: PASSED\n");
+}
+
 int main(){
 
+	test_vector_capacity();
+	test_vector_push();
+	test_vector_inline();
+	test_vector_range();
+	test_vector_typed();
+
 	vector* v = vector_new(sizeof(int));
 
 	int f = 99;
@@ -0,0 +1,120 @@
+#define ULIB_SHARED_VTABLE
+#include "../ulib.h"
+
+/* Bytes each object would take with its own copy of the methods */
+#define COPIED_BYTES(T, VT) (sizeof(T) - sizeof(void*) + sizeof(VT))
+
+void test_vtable_calls(){
+	vector* v = vector_new(sizeof(int));
+	array* arr = array_new(5, TYPE_INT);
+	list* l = list_new();
+	string* s = string_new("shared");
+	segvec* sv = segvec_new(sizeof(int));
+	deque* q = deque_new(sizeof(int));
+	appendvec* av = appendvec_new(sizeof(int));
+	soa_field schema[] = {{TYPE_INT, 0}, {TYPE_DOUBLE, 0}};
+	soa* so = soa_new(schema, 2);
+	double d = 0.5;
+	string* c;
+	int i, x = 0;
+
+	/* Objects of the same kind share one table */
+	vector* w = vector_new(sizeof(double));
+	if(v->vt != w->vt || !v->vt){
+		ULIB_FPRINTF(stderr, "Shared vtable calls: FAILED (table)\n");
+		exit(1);
+	}
+	ULIB_M(w)->free(w);
+
+	for(i=0; i!=10; ++i) ULIB_M(v)->push(v, &i);
+	ULIB_M(v)->pop(v, &x);
+	if(ULIB_M(v)->length(v) != 9 || x != 9 || *(int*)ULIB_M(v)->at(v, 3) != 3){
+		ULIB_FPRINTF(stderr, "Shared vtable calls: FAILED (vector)\n");
+		exit(1);
+	}
+
+	ULIB_M(arr)->linspace(arr, 1, 1);
+	ULIB_M(arr)->mul_scalar(arr, 2);
+	if(ULIB_M(arr)->sumi(arr) != 30 || ULIB_M(arr)->geti(arr, 4) != 10){
+		ULIB_FPRINTF(stderr, "Shared vtable calls: FAILED (array)\n");
+		exit(1);
+	}
+
+	for(i=0; i!=4; ++i) ULIB_M(l)->append(l, TYPE_INT, &i);
+	ULIB_M(l)->pop(l);
+	if(ULIB_M(l)->length(l) != 3 || *(int*)ULIB_M(l)->at(l, 2)->data != 2){
+		ULIB_FPRINTF(stderr, "Shared vtable calls: FAILED (list)\n");
+		exit(1);
+	}
+
+	ULIB_M(s)->append(s, " table");
+	c = ULIB_M(s)->substr(s, 0, 6);
+	if(!c || c->vt != s->vt || ULIB_STRCMP(c->str, "shared") != 0
+		|| ULIB_STRCMP(s->str, "shared table") != 0){
+		ULIB_FPRINTF(stderr, "Shared vtable calls: FAILED (string)\n");
+		exit(1);
+	}
+
+	for(i=0; i!=100; ++i) ULIB_M(sv)->push(sv, &i);
+	if(sv->vt != &segvec__methods || ULIB_M(sv)->length(sv) != 100 || *(int*)ULIB_M(sv)->at(sv, 99) != 99){
+		ULIB_FPRINTF(stderr, "Shared vtable calls: FAILED (segvec)\n");
+		exit(1);
+	}
+
+	for(i=0; i!=20; ++i) ULIB_M(q)->push_front(q, &i);
+	ULIB_M(q)->pop_back(q, &x);
+	if(q->vt != &deque__methods || x != 0 || *(int*)ULIB_M(q)->front(q) != 19){
+		ULIB_FPRINTF(stderr, "Shared vtable calls: FAILED (deque)\n");
+		exit(1);
+	}
+
+	for(i=0; i!=40; ++i) ULIB_M(av)->push(av, &i);
+	if(av->vt != &appendvec__methods || ULIB_M(av)->length(av) != 40 || *(int*)ULIB_M(av)->at(av, 39) != 39){
+		ULIB_FPRINTF(stderr, "Shared vtable calls: FAILED (appendvec)\n");
+		exit(1);
+	}
+
+	for(i=0; i!=30; ++i) ULIB_M(so)->push(so, &i, &d);
+	if(so->vt != &soa__methods || ULIB_M(so)->length(so) != 30 || *(int*)ULIB_M(so)->at(so, 29, 0) != 29){
+		ULIB_FPRINTF(stderr, "Shared vtable calls: FAILED (soa)\n");
+		exit(1);
+	}
+
+	ULIB_M(so)->free(so);
+	ULIB_M(av)->free(av);
+	ULIB_M(q)->free(q);
+	ULIB_M(sv)->free(sv);
+	ULIB_M(c)->free(c);
+	ULIB_M(s)->free(s);
+	ULIB_M(l)->free(l);
+	ULIB_M(arr)->free(arr);
+	ULIB_M(v)->free(v);
+	ULIB_FPRINTF(stderr, "Shared vtable calls: PASSED\n");
+}
+
+void test_vtable_sizes(){
+	if(sizeof(vector) >= COPIED_BYTES(vector, vector_vtable)
+		|| sizeof(array) >= COPIED_BYTES(array, array_vtable)
+		|| sizeof(list) >= COPIED_BYTES(list, list_vtable)
+		|| sizeof(string) >= COPIED_BYTES(string, string_vtable)){
+		ULIB_FPRINTF(stderr, "Shared vtable sizes: FAILED\n");
+		exit(1);
+	}
+
+	ULIB_FPRINTF(stderr, " object   copied  shared  saved\n");
+	ULIB_FPRINTF(stderr, " vector  %7u %7u %6u\n", (unsigned int)COPIED_BYTES(vector, vector_vtable),
+		(unsigned int)sizeof(vector), (unsigned int)(sizeof(vector_vtable) - sizeof(void*)));
+	ULIB_FPRINTF(stderr, " array   %7u %7u %6u\n", (unsigned int)COPIED_BYTES(array, array_vtable),
+		(unsigned int)sizeof(array), (unsigned int)(sizeof(array_vtable) - sizeof(void*)));
+	ULIB_FPRINTF(stderr, " list    %7u %7u %6u\n", (unsigned int)COPIED_BYTES(list, list_vtable),
+		(unsigned int)sizeof(list), (unsigned int)(sizeof(list_vtable) - sizeof(void*)));
+	ULIB_FPRINTF(stderr, " string  %7u %7u %6u\n", (unsigned int)COPIED_BYTES(string, string_vtable),
+		(unsigned int)sizeof(string), (unsigned int)(sizeof(string_vtable) - sizeof(void*)));
+	ULIB_FPRINTF(stderr, "Shared vtable sizes: PASSED\n");
+}
+
+int main(){
+	test_vtable_calls();
+	test_vtable_sizes();
+	return 0;
+}
@@ -7,14 +7,37 @@ Includes all the data structures
 #define STRING_IMPLEMENTATION
 #include "string.h"
 
+#define SORT_IMPLEMENTATION
+#include "sort.h"
+
 #define VECTOR_IMPLEMENTATION
 #include "vector.h"
 
 #define ARRAY_IMPLEMENTATION
 #include "array.h"
 
+#define SEGVEC_IMPLEMENTATION
+#include "segvec.h"
+
+#define DEQUE_IMPLEMENTATION
+#include "deque.h"
+
+#define SOA_IMPLEMENTATION
+#include "soa.h"
+
+#ifdef __GNUC__
+#define APPENDVEC_IMPLEMENTATION
+#include "appendvec.h"
+#endif
+
+#define POOL_IMPLEMENTATION
+#include "pool.h"
+
 #define LIST_IMPLEMENTATION
 #include "list.h"
 
 #define ARGLIB_IMPLEMENTATION
-#include "arglib.h"
\ No newline at end of file
+#include "arglib.h"
+
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
@@ -11,6 +11,13 @@
 		vector *v = vector_new( sizeof(T) );
 	where T is the data type of its members.
 
+	To take its memory from an allocator object, use:
+		vector *v = vector_new_alloc( sizeof(T), &allocator );
+
+	To keep up to 'n' bytes of members inside the vector
+	object itself, and only go to the heap beyond that, use:
+		vector *v = vector_new_inline( sizeof(T), n );
+
 	To insert a new member 'var' at index 0, use:
 		v->insert( v, 0, &var );
 
@@ -20,6 +27,19 @@
 	To delete a vector member at index 'i', use:
 		v->delete( v, i);
 
+	To insert 'n' members from an array 'arr' at index 'i',
+	remove 'n' members from index 'i', or append 'n' members:
+		v->insert_range( v, i, arr, n );
+		v->erase_range( v, i, n );
+		v->append_array( v, arr, n );
+
+	To append to or remove from the end, use:
+		v->push( v, &var );
+		v->pop( v, &var );   // or NULL to discard it
+		T *last = v->back( v );
+	To construct a member in place at the end, use:
+		T *slot = v->emplace( v );
+
 	To retrieve a pointer to a specific member
 	at index 'i', use:
 		T *ptr = v->at( v, i );
@@ -33,6 +53,31 @@
 	To fill every vector member with the same item, use:
 		v->fill(v, &item);
 
+	Storage grows geometrically, so appending is amortised O(1).
+	To make room for 'n' members in advance, use:
+		v->reserve(v, n);
+	To release any unused room, use:
+		v->shrink_to_fit(v);
+
+	To sort the members with a qsort-style comparator, use:
+		v->sort(v, cmp);
+	Large vectors may be sorted on several threads (0 for one per
+	processor) when built with ULIB_THREADS, see sort_parallel:
+		v->sort_parallel(v, cmp, threads);
+	Once sorted, members equal to a key are found by binary search:
+		unsigned int i = v->lower_bound(v, &key, cmp);
+		unsigned int j = v->upper_bound(v, &key, cmp);
+		unsigned int i = v->equal_range(v, &key, cmp, &j);
+
+	With ULIB_MMAP on POSIX systems, a vector may keep its members
+	in a memory-mapped file, which it creates or reopens:
+		vector *v = vector_mmap_open( "data.vec", sizeof(T) );
+	It then works as any other vector, growing the file as needed.
+	To write the length and flush the members to disk, use:
+		vector_mmap_sync( v, VECTOR_MMAP_SYNC );   // or _ASYNC
+	v->free(v) trims the file to the members, writes the length and
+	closes it, leaving the flush to the system.
+
 
 
 
@@ -66,6 +111,36 @@
 		- Migrated vector functions to struct methods
 		(function pointers).
 
+	1.4
+		- Added vector_new_alloc, which takes memory
+		from a ulib_allocator object.
+		- Fixed v->free leaking the data array, and
+		v->resize allocating the wrong size.
+
+	1.5
+		- Storage grows geometrically and shrinks once
+		a quarter full, instead of on every insert
+		and delete.
+		- Added v->capacity, v->reserve and
+		v->shrink_to_fit.
+		- Added v->push, v->pop, v->back and
+		v->emplace for the end of the vector.
+		- Insertions and deletions shift the tail
+		with a single memmove.
+		- Added v->insert_range, v->erase_range and
+		v->append_array.
+		- Methods can be shared by every vector
+		through one const table, see
+		ULIB_SHARED_VTABLE in defs.h.
+		- Added vector_new_inline, which stores short
+		vectors in the same allocation as the object.
+		- Added v->sort (pdqsort, see sort.h).
+		- Added v->sort_parallel.
+		- Added v->lower_bound, v->upper_bound and
+		v->equal_range.
+		- Added vector_mmap_open and vector_mmap_sync,
+		for vectors stored in a file (ULIB_MMAP).
+
 
 %%%%% TO-DO %%%%%
 - Avoid over-usage of getters.
@@ -81,29 +156,75 @@
 #include "defs.h"
 #endif
 
+#ifndef SORT_IMPLEMENTATION
+#define SORT_IMPLEMENTATION
+#include "sort.h"
+#endif
+
+/* Capacity of the first allocation */
+#ifndef ULIB_VECTOR_MIN_CAP
+	#define ULIB_VECTOR_MIN_CAP 4
+#endif
+
 typedef struct vector__struct vector;
+
+/* Vector methods, shared by every vector under ULIB_SHARED_VTABLE (defs.h) */
+#define VECTOR__METHODS \
+	unsigned int (*length)(vector*); \
+	unsigned int (*capacity)(vector*); \
+	unsigned int (*elem_size)(vector*); \
+	void* (*data)(vector*); \
+	void* (*at)(vector*, unsigned int); \
+	unsigned int (*mem)(vector*); \
+	vector* (*set)(vector*, unsigned int, void*); \
+	vector* (*fill)(vector*, void*); \
+	vector* (*insert)(vector*, unsigned int, void*); \
+	vector* (*delete)(vector*, unsigned int); \
+	vector* (*insert_range)(vector*, unsigned int, const void*, unsigned int); \
+	vector* (*erase_range)(vector*, unsigned int, unsigned int); \
+	vector* (*append_array)(vector*, const void*, unsigned int); \
+	vector* (*push)(vector*, const void*); \
+	vector* (*pop)(vector*, void*); \
+	void* (*back)(vector*); \
+	void* (*emplace)(vector*); \
+	vector* (*resize)(vector*, unsigned int); \
+	vector* (*reserve)(vector*, unsigned int); \
+	vector* (*shrink_to_fit)(vector*); \
+	vector* (*from_array)(void*, unsigned int, unsigned int); \
+	vector* (*sort)(vector*, sort_cmp); \
+	vector* (*sort_parallel)(vector*, sort_cmp, unsigned int); \
+	unsigned int (*lower_bound)(vector*, const void*, sort_cmp); \
+	unsigned int (*upper_bound)(vector*, const void*, sort_cmp); \
+	unsigned int (*equal_range)(vector*, const void*, sort_cmp, unsigned int*); \
+	void (*free)(vector*);
+
+typedef struct vector__vtable_struct vector_vtable;
+struct vector__vtable_struct {
+	VECTOR__METHODS
+};
+
 struct vector__struct {
 	void *d;
 	unsigned int len;
+	unsigned int cap; /* members that fit in 'd' */
 	unsigned int dtype;
+	unsigned int inline_cap; /* members that fit in the inline buffer */
+	const ulib_allocator* alloc;
+#ifdef ULIB_SHARED_VTABLE
+	const vector_vtable* vt;
+#else
 	/* Methods */
-	unsigned int (*length)(vector*);
-	unsigned int (*elem_size)(vector*);
-	void* (*data)(vector*);
-	void* (*at)(vector*, unsigned int);
-	unsigned int (*mem)(vector*);
-	vector* (*set)(vector*, unsigned int, void*);
-	vector* (*fill)(vector*, void*);
-	vector* (*insert)(vector*, unsigned int, void*);
-	vector* (*delete)(vector*, unsigned int);
-	vector* (*resize)(vector*, unsigned int);
-	vector* (*from_array)(void*, unsigned int, unsigned int);
-	void (*free)(vector*);
+	VECTOR__METHODS
+#endif
 };
 
 /* Function Declarations */
 vector *vector_new(unsigned int bytes);
+vector *vector_new_alloc(unsigned int bytes, const ulib_allocator* alloc);
+vector *vector_new_inline(unsigned int bytes, unsigned int inline_bytes);
+vector *vector_new_inline_alloc(unsigned int bytes, unsigned int inline_bytes, const ulib_allocator* alloc);
 unsigned int vector__length(vector *v);
+unsigned int vector__capacity(vector *v);
 
 unsigned int vector__dtype(vector *v);
 void *vector__data(vector *v);
@@ -116,25 +237,303 @@ vector *vector__fill(vector *v, void *src);
 
 vector *vector__insert(vector *v, unsigned int j, void *new);
 vector *vector__delete(vector *v, unsigned int i);
+vector *vector__insert_range(vector *v, unsigned int j, const void *src, unsigned int n);
+vector *vector__erase_range(vector *v, unsigned int j, unsigned int n);
+vector *vector__append_array(vector *v, const void *src, unsigned int n);
+vector *vector__push(vector *v, const void *src);
+vector *vector__pop(vector *v, void *dest);
+void *vector__back(vector *v);
+void *vector__emplace(vector *v);
 vector *vector__resize(vector *v, unsigned int newsize);
+vector *vector__reserve(vector *v, unsigned int cap);
+vector *vector__shrink_to_fit(vector *v);
 void vector__free(vector *v);
 vector *vector__from_array(void *arr, unsigned int elem_num, unsigned int elem_size);
+vector *vector__sort(vector *v, sort_cmp cmp);
+vector *vector__sort_parallel(vector *v, sort_cmp cmp, unsigned int threads);
+unsigned int vector__lower_bound(vector *v, const void *key, sort_cmp cmp);
+unsigned int vector__upper_bound(vector *v, const void *key, sort_cmp cmp);
+unsigned int vector__equal_range(vector *v, const void *key, sort_cmp cmp, unsigned int *end);
+
+/*
+	File-backed vectors, with ULIB_MMAP.
+	Needs mmap, ftruncate and msync: under -std=c89 on glibc, also define
+	_POSIX_C_SOURCE 200112L (or _GNU_SOURCE, which adds mremap)
+	before including any header.
+*/
+#ifdef ULIB_MMAP
+#define VECTOR_MMAP_SYNC 0
+#define VECTOR_MMAP_ASYNC 1
+
+vector *vector_mmap_open(const char *path, unsigned int bytes);
+vector *vector_mmap_sync(vector *v, int async);
+#endif
+
+/*
+	Typed vectors.
+	VECTOR_DECLARE(name, T) generates a struct 'name' holding members
+	of type T, and static inline functions working on it directly, with
+	no function pointers and no element size to multiply by at runtime:
+
+		name_init(v)             name_init_alloc(v, alloc)
+		name_free(v)             name_reserve(v, n)
+		name_shrink_to_fit(v)    name_at(v, i)
+		name_push(v, x)          name_pop(v)
+		name_insert(v, j, x)     name_erase(v, j, n)
+		name_sort(v, cmp)
+
+	'v' is a pointer to the struct, which may live on the stack.
+	at() and pop() do not check bounds. Functions returning 'name*'
+	return NULL on failure. cmp is a qsort-style comparator taking two
+	'const T*'.
+
+	VECTOR_DECLARE_LESS(name, T, LESS) also adds name_sort_less(v),
+	which orders members with the expression LESS(a, b), true when
+	a goes before b. The comparison is then inlined into the sort:
+		VECTOR_DECLARE_LESS(vec_int, int, VECTOR_LESS)
+		vec_int v;
+		vec_int_init(&v);
+		vec_int_push(&v, 42);
+		vec_int_sort_less(&v);
+		vec_int_free(&v);
+*/
+
+/* Default LESS for numeric types */
+#define VECTOR_LESS(a, b) ((a) < (b))
+
+/* LESS used by name_sort, built on its 'cmp' argument */
+#define VECTOR__CMP_LESS(a, b) (cmp(&(a), &(b)) < 0)
+
+/* Below this length, the sort switches to insertion sort */
+#define VECTOR__SORT_SMALL 16
+
+/*
+Defines 'fn', an in-place quicksort of 'n' members at 'a'
+(median of three, smaller side first), over insertion sort.
+*/
+#define VECTOR__DEFINE_SORT(fn, T, LESS) \
+ULIB_INLINE void fn(T *a, unsigned int n, int (*cmp)(const T*, const T*)){ \
+	T t, p; \
+	unsigned int i, j, m; \
+	(void)cmp; \
+	while(n > VECTOR__SORT_SMALL){ \
+		m = n/2; \
+		if(LESS(a[m], a[0])){ t = a[m]; a[m] = a[0]; a[0] = t; } \
+		if(LESS(a[n-1], a[0])){ t = a[n-1]; a[n-1] = a[0]; a[0] = t; } \
+		if(LESS(a[n-1], a[m])){ t = a[n-1]; a[n-1] = a[m]; a[m] = t; } \
+		p = a[m]; \
+		i = 0; \
+		j = n-1; \
+		for(;;){ \
+			while(LESS(a[i], p)) i++; \
+			while(LESS(p, a[j])) j--; \
+			if(i >= j) break; \
+			t = a[i]; a[i] = a[j]; a[j] = t; \
+			i++; \
+			j--; \
+		} \
+		if(j+1 < n-j-1){ \
+			fn(a, j+1, cmp); \
+			a += j+1; \
+			n -= j+1; \
+		} \
+		else{ \
+			fn(a+j+1, n-j-1, cmp); \
+			n = j+1; \
+		} \
+	} \
+	for(i=1; i<n; ++i){ \
+		t = a[i]; \
+		for(j=i; j>0 && LESS(t, a[j-1]); --j) a[j] = a[j-1]; \
+		a[j] = t; \
+	} \
+}
+
+#define VECTOR_DECLARE(name, T) \
+typedef struct { \
+	T *d; \
+	unsigned int len; \
+	unsigned int cap; \
+	const ulib_allocator *alloc; \
+} name; \
+\
+ULIB_INLINE void name##_init_alloc(name *v, const ulib_allocator *alloc){ \
+	v->d = NULL; \
+	v->len = 0; \
+	v->cap = 0; \
+	v->alloc = alloc ? alloc : &ulib_default_allocator; \
+} \
+\
+ULIB_INLINE void name##_init(name *v){ \
+	name##_init_alloc(v, NULL); \
+} \
+\
+ULIB_INLINE void name##_free(name *v){ \
+	ulib__dealloc(v->alloc, v->d, v->cap*sizeof(T), ULIB_TAG_VECTOR); \
+	name##_init_alloc(v, v->alloc); \
+} \
+\
+ULIB_INLINE name *name##__set_cap(name *v, unsigned int cap){ \
+	T *d = ulib__realloc(v->alloc, v->d, v->cap*sizeof(T), cap*sizeof(T), ULIB_TAG_VECTOR); \
+	if(!d && cap) return NULL; \
+	v->d = d; \
+	v->cap = cap; \
+	return v; \
+} \
+\
+ULIB_INLINE name *name##_reserve(name *v, unsigned int n){ \
+	if(n <= v->cap) return v; \
+	return name##__set_cap(v, n); \
+} \
+\
+ULIB_INLINE name *name##_shrink_to_fit(name *v){ \
+	if(v->len == v->cap) return v; \
+	return name##__set_cap(v, v->len); \
+} \
+\
+/* Makes room for 'n' more members, at least doubling the capacity */ \
+ULIB_INLINE name *name##__grow(name *v, unsigned int n){ \
+	unsigned int max = (unsigned int)-1/sizeof(T); \
+	unsigned int cap = v->cap ? v->cap*2 : ULIB_VECTOR_MIN_CAP; \
+	if(n > max - v->len) return NULL; \
+	if(cap < v->cap || cap > max) cap = max; \
+	if(cap < v->len + n) cap = v->len + n; \
+	return name##__set_cap(v, cap); \
+} \
+\
+ULIB_INLINE T *name##_at(name *v, unsigned int i){ \
+	return v->d + i; \
+} \
+\
+ULIB_INLINE name *name##_push(name *v, T x){ \
+	if(v->len == v->cap && !name##__grow(v, 1)) return NULL; \
+	v->d[v->len++] = x; \
+	return v; \
+} \
+\
+ULIB_INLINE T name##_pop(name *v){ \
+	return v->d[--v->len]; \
+} \
+\
+ULIB_INLINE name *name##_insert(name *v, unsigned int j, T x){ \
+	if(j > v->len) return NULL; \
+	if(v->len == v->cap && !name##__grow(v, 1)) return NULL; \
+	if(j < v->len) ULIB_MEMMOVE(v->d + j + 1, v->d + j, (v->len - j)*sizeof(T)); \
+	v->d[j] = x; \
+	v->len++; \
+	return v; \
+} \
+\
+ULIB_INLINE name *name##_erase(name *v, unsigned int j, unsigned int n){ \
+	if(j >= v->len || n > v->len - j) return NULL; \
+	if(j + n < v->len) ULIB_MEMMOVE(v->d + j, v->d + j + n, (v->len - j - n)*sizeof(T)); \
+	v->len -= n; \
+	return v; \
+} \
+\
+VECTOR__DEFINE_SORT(name##__sort, T, VECTOR__CMP_LESS) \
+\
+ULIB_INLINE void name##_sort(name *v, int (*cmp)(const T*, const T*)){ \
+	name##__sort(v->d, v->len, cmp); \
+}
+
+#define VECTOR_DECLARE_LESS(name, T, LESS) \
+VECTOR_DECLARE(name, T) \
+\
+VECTOR__DEFINE_SORT(name##__sort_less, T, LESS) \
+\
+ULIB_INLINE void name##_sort_less(name *v){ \
+	name##__sort_less(v->d, v->len, NULL); \
+}
 
 #endif
 
 
 #ifdef VECTOR_IMPLEMENTATION
 
-/* Allocates new vector and returns pointer to it */
+/* Offset of the inline buffer, which is aligned to 16 bytes */
+#define VECTOR__HEADER (((unsigned int)sizeof(vector) + 15u) & ~15u)
+#define VECTOR__INLINE(v) ((char*)(v) + VECTOR__HEADER)
+#define VECTOR__IS_INLINE(v) ((v)->inline_cap && (v)->d == VECTOR__INLINE(v))
+
+/* Bytes taken by the object itself, with its inline buffer */
+#define VECTOR__SELF_BYTES(v) \
+	((v)->inline_cap ? VECTOR__HEADER + (v)->inline_cap*(v)->dtype : (unsigned int)sizeof(vector))
+
+#ifdef ULIB_SHARED_VTABLE
+/* In the order of VECTOR__METHODS */
+static const vector_vtable vector__methods = {
+	vector__length,
+	vector__capacity,
+	vector__dtype,
+	vector__data,
+	vector__at,
+	vector__mem,
+	vector__set,
+	vector__fill,
+	vector__insert,
+	vector__delete,
+	vector__insert_range,
+	vector__erase_range,
+	vector__append_array,
+	vector__push,
+	vector__pop,
+	vector__back,
+	vector__emplace,
+	vector__resize,
+	vector__reserve,
+	vector__shrink_to_fit,
+	vector__from_array,
+	vector__sort,
+	vector__sort_parallel,
+	vector__lower_bound,
+	vector__upper_bound,
+	vector__equal_range,
+	vector__free
+};
+#endif
+
+/* Allocates new vector and returns pointer to it, or NULL if 'bytes' is 0 */
 vector *vector_new(unsigned int bytes) {
-	vector *v = ULIB_MALLOC(sizeof(vector));
+	return vector_new_alloc(bytes, NULL);
+}
+
+/* As vector_new, taking all memory from 'alloc' (NULL for the default) */
+vector *vector_new_alloc(unsigned int bytes, const ulib_allocator* alloc) {
+	return vector_new_inline_alloc(bytes, 0, alloc);
+}
+
+/*
+Allocates a vector with room for 'inline_bytes' bytes of members
+right after the object, in the same allocation.
+Storage only moves to the heap once the members outgrow it.
+*/
+vector *vector_new_inline(unsigned int bytes, unsigned int inline_bytes) {
+	return vector_new_inline_alloc(bytes, inline_bytes, NULL);
+}
+
+/* As vector_new_inline, taking all memory from 'alloc' (NULL for the default) */
+vector *vector_new_inline_alloc(unsigned int bytes, unsigned int inline_bytes, const ulib_allocator* alloc) {
+	vector *v;
+	unsigned int inline_cap;
+	if(bytes == 0) return NULL;
+	inline_cap = inline_bytes/bytes;
+	if(!alloc) alloc = &ulib_default_allocator;
+	v = ulib__alloc(alloc, inline_cap ? VECTOR__HEADER + inline_cap*bytes : sizeof(vector), ULIB_TAG_VECTOR);
 	if(!v) return NULL;
 	/* Variables */
-	v->d = NULL;
+	v->d = inline_cap ? VECTOR__INLINE(v) : NULL;
 	v->len = 0;
+	v->cap = inline_cap;
 	v->dtype = bytes;
+	v->inline_cap = inline_cap;
+	v->alloc = alloc;
+#ifdef ULIB_SHARED_VTABLE
+	v->vt = &vector__methods;
+#else
 	/* Methods */
 	v->length = vector__length;
+	v->capacity = vector__capacity;
 	v->elem_size = vector__dtype;
 	v->data = vector__data;
 	v->at = vector__at;
@@ -143,9 +542,24 @@ vector *vector_new(unsigned int bytes) {
 	v->fill = vector__fill;
 	v->insert = vector__insert;
 	v->delete = vector__delete;
+	v->insert_range = vector__insert_range;
+	v->erase_range = vector__erase_range;
+	v->append_array = vector__append_array;
+	v->push = vector__push;
+	v->pop = vector__pop;
+	v->back = vector__back;
+	v->emplace = vector__emplace;
 	v->resize = vector__resize;
+	v->reserve = vector__reserve;
+	v->shrink_to_fit = vector__shrink_to_fit;
 	v->from_array = vector__from_array;
+	v->sort = vector__sort;
+	v->sort_parallel = vector__sort_parallel;
+	v->lower_bound = vector__lower_bound;
+	v->upper_bound = vector__upper_bound;
+	v->equal_range = vector__equal_range;
 	v->free = vector__free;
+#endif
 
 	return v;
 }
@@ -154,6 +568,10 @@ unsigned int vector__length(vector *v){
 	return v->len;
 }
 
+unsigned int vector__capacity(vector *v){
+	return v->cap;
+}
+
 unsigned int vector__dtype(vector *v){
 	return v->dtype;
 }
@@ -163,98 +581,398 @@ void *vector__data(vector *v){
 }
 
 void *vector__at(vector *v, unsigned int i){
-	if(i >= v->length(v)) return NULL;
+	if(i >= v->len) return NULL;
 	void *ptr = v->d + i*v->dtype;
 	return ptr;
 }
 
 unsigned int vector__mem(vector *v){
 	if(!v) return 0;
-	return sizeof(vector)+v->length(v)*v->dtype;
+	if(VECTOR__IS_INLINE(v)) return VECTOR__SELF_BYTES(v);
+	return VECTOR__SELF_BYTES(v) + v->cap*v->dtype;
 }
 
 vector *vector__set(vector *v, unsigned int i, void *src){
-	if(i >= v->length(v)) return NULL;
-	void *dest = v->at(v, i);
+	if(i >= v->len) return NULL;
+	void *dest = vector__at(v, i);
 	ULIB_MEMCPY(dest, src, v->dtype);
 	return v;
 }
 
 vector *vector__fill(vector *v, void *src){
 	unsigned int i;
-	for(i=0; i<v->length(v); i++) v->set(v, i, src);
+	for(i=0; i<v->len; i++) vector__set(v, i, src);
 	return v;
 }
 
-vector *vector__insert(vector *v, unsigned int j, void *new){
-	if(j > v->length(v)) return NULL;
-
-	/*Reallocate with one extra space*/
-	v->d = ULIB_REALLOC(v->d, v->dtype*(v->len+1) );
-	if(v->d == NULL) return NULL;
-	v->len++;
-
-	/*Shift values forward from insert index*/
-	unsigned int i;
-	for(i=v->length(v)-1; i>j; i--){
-		void *dest = v->at(v, i);
-		void *src = v->at(v, i-1);
-		ULIB_MEMCPY(dest, src, v->dtype);
+/*
+Reallocates the storage to hold exactly 'cap' members.
+Vectors with an inline buffer use it whenever 'cap' fits,
+and only allocate once they spill out of it.
+*/
+static vector *vector__set_cap(vector *v, unsigned int cap){
+	char *buf = VECTOR__INLINE(v);
+	void *d;
+	if(v->inline_cap && cap <= v->inline_cap){
+		if(v->d != buf){
+			ULIB_MEMCPY(buf, v->d, (v->len < cap ? v->len : cap)*v->dtype);
+			ulib__dealloc(v->alloc, v->d, v->dtype*v->cap, ULIB_TAG_VECTOR);
+			v->d = buf;
+		}
+		v->cap = v->inline_cap;
+		return v;
 	}
+	if(VECTOR__IS_INLINE(v)){
+		d = ulib__alloc(v->alloc, v->dtype*cap, ULIB_TAG_VECTOR);
+		if(!d) return NULL;
+		ULIB_MEMCPY(d, buf, v->len*v->dtype);
+		v->d = d;
+		v->cap = cap;
+		return v;
+	}
+	d = ulib__realloc(v->alloc, v->d, v->dtype*v->cap, v->dtype*cap, ULIB_TAG_VECTOR);
+	if(d == NULL && cap != 0) return NULL;
+	v->d = d;
+	v->cap = cap;
+	return v;
+}
+
+/* Makes room for 'n' more members, at least doubling the capacity */
+static vector *vector__grow(vector *v, unsigned int n){
+	unsigned int max = (unsigned int)-1/v->dtype;
+	unsigned int cap = v->cap ? v->cap*2 : ULIB_VECTOR_MIN_CAP;
+	if(n > max - v->len) return NULL;
+	if(cap < v->cap || cap > max) cap = max;
+	if(cap < v->len + n) cap = v->len + n;
+	return vector__set_cap(v, cap);
+}
 
-	/*Copy new member data from input pointer*/
-	void *dest = v->at(v, j);
-	ULIB_MEMCPY(dest, new, v->dtype);
+/* Halves the capacity while the vector is less than a quarter full */
+static void vector__shrink(vector *v){
+	unsigned int cap = v->cap;
+	if(VECTOR__IS_INLINE(v)) return;
+	while(v->len < cap/4 && cap > ULIB_VECTOR_MIN_CAP) cap /= 2;
+	if(cap != v->cap) vector__set_cap(v, cap);
+}
 
-	return v;
+vector *vector__insert(vector *v, unsigned int j, void *new){
+	return vector__insert_range(v, j, new, 1);
 }
 
 vector *vector__delete(vector *v, unsigned int i){
-	if(i >= v->length(v)) return NULL;
+	return vector__erase_range(v, i, 1);
+}
 
-	/*If there is only one member to delete, free instead*/
-	if(v->len == 1){
-		ULIB_FREE(v->d);
-		v->len--;
-		return v;
+/*
+Inserts 'n' members from 'src' before index 'j', shifting the rest once.
+'src' may point to members of the vector itself.
+*/
+vector *vector__insert_range(vector *v, unsigned int j, const void *src, unsigned int n){
+	const char *p = (const char*)src;
+	char *d = v->d;
+	int inside = d && p >= d && p < d + (size_t)v->len*v->dtype;
+	size_t off = inside ? (size_t)(p - d) : 0;
+	size_t at = (size_t)j*v->dtype, bytes = (size_t)n*v->dtype, head;
+	if(j > v->len) return NULL;
+	if(n == 0) return v;
+	if(v->cap - v->len < n && !vector__grow(v, n)) return NULL;
+	d = v->d;
+	if(j < v->len){
+		ULIB_MEMMOVE(d + at + bytes, d + at, (v->len-j)*v->dtype);
 	}
+	if(inside){
+		/* Members before 'j' stayed put and the rest moved up by 'bytes' */
+		head = off < at ? (at - off < bytes ? at - off : bytes) : 0;
+		if(head) ULIB_MEMCPY(d + at, d + off, head);
+		if(head < bytes) ULIB_MEMCPY(d + at + head, d + off + head + bytes, bytes - head);
+	}
+	else ULIB_MEMCPY(d + at, src, bytes);
+	v->len += n;
+	return v;
+}
 
-	/*Shift memory back over deleted member*/
-	unsigned int j;
-	for(j=i; j<v->length(v)-1; j++){
-		void *src = v->at(v, j+1);
-		void *dest = v->at(v, j);
-		ULIB_MEMCPY(dest, src, v->dtype);
+/* Removes 'n' members starting at index 'j' */
+vector *vector__erase_range(vector *v, unsigned int j, unsigned int n){
+	char *d = v->d;
+	if(j >= v->len || n > v->len - j) return NULL;
+	if(j+n < v->len){
+		ULIB_MEMMOVE(d + j*v->dtype, d + (j+n)*v->dtype, (v->len-j-n)*v->dtype);
 	}
+	v->len -= n;
 
-	/*Reallocate to reduce memory usage*/	
-	v->d = ULIB_REALLOC(v->d, v->dtype*(v->len-1) );	
-	v->len--;
-	if(!v->d)
-		return NULL;
+	/*Reduce memory usage once mostly empty*/
+	vector__shrink(v);
+	return v;
+}
+
+/* Appends 'n' members from 'src' */
+vector *vector__append_array(vector *v, const void *src, unsigned int n){
+	return vector__insert_range(v, v->len, src, n);
+}
+
+/* Appends a copy of 'src', which may be a member of 'v' */
+vector *vector__push(vector *v, const void *src){
+	const char *p = (const char*)src, *d = (const char*)v->d;
+	int inside = d && p >= d && p < d + (size_t)v->len*v->dtype;
+	size_t off = inside ? (size_t)(p - d) : 0;
+	void *dest = vector__emplace(v);
+	if(!dest) return NULL;
+	if(inside) src = (const char*)v->d + off; /* the storage may have moved */
+	ULIB_MEMCPY(dest, src, v->dtype);
+	return v;
+}
 
+/* Removes the last member, copying it to 'dest' unless NULL */
+vector *vector__pop(vector *v, void *dest){
+	if(v->len == 0) return NULL;
+	v->len--;
+	if(dest) ULIB_MEMCPY(dest, (char*)v->d + v->len*v->dtype, v->dtype);
+	vector__shrink(v);
 	return v;
 }
 
+/* Returns the last member, or NULL if empty */
+void *vector__back(vector *v){
+	if(v->len == 0) return NULL;
+	return (char*)v->d + (v->len-1)*v->dtype;
+}
+
+/* Appends an uninitialised member and returns it, or NULL on failure */
+void *vector__emplace(vector *v){
+	if(v->len == v->cap && !vector__grow(v, 1)) return NULL;
+	return (char*)v->d + v->len++*v->dtype;
+}
+
+/* Sets the length, keeping the storage unless it is too small or mostly unused */
 vector *vector__resize(vector *v, unsigned int newsize){
-	v->d = ULIB_REALLOC(v->d, sizeof(v->dtype)*newsize);
-	if(v->d == NULL)
-		return NULL;
+	if(newsize > v->cap || newsize < v->cap/4){
+		if(!vector__set_cap(v, newsize)) return NULL;
+	}
 	v->len = newsize;
 	return v;
 }
 
+/* Ensures room for 'cap' members without changing the length */
+vector *vector__reserve(vector *v, unsigned int cap){
+	if(cap <= v->cap) return v;
+	return vector__set_cap(v, cap);
+}
+
+/* Releases the room beyond the current length */
+vector *vector__shrink_to_fit(vector *v){
+	if(v->cap == v->len) return v;
+	return vector__set_cap(v, v->len);
+}
+
 void vector__free(vector *v){
-	if(!v || !v->d) return
-	ULIB_FREE(v->d);
-	ULIB_FREE(v);
+	if(!v) return;
+	if(!VECTOR__IS_INLINE(v)) ulib__dealloc(v->alloc, v->d, v->dtype*v->cap, ULIB_TAG_VECTOR);
+	ulib__dealloc(v->alloc, v, VECTOR__SELF_BYTES(v), ULIB_TAG_VECTOR);
 }
 
 vector *vector__from_array(void *arr, unsigned int elem_num, unsigned int elem_size){
 	vector *v = vector_new(elem_size);
-	v->resize(v, elem_num);
-	ULIB_MEMCPY(v->data(v), arr, elem_num*elem_size);
+	if(!v) return NULL;
+	if(!vector__resize(v, elem_num)){
+		vector__free(v);
+		return NULL;
+	}
+	ULIB_MEMCPY(v->d, arr, elem_num*elem_size);
+	return v;
+}
+
+/* Sorts the members in the order given by 'cmp', as qsort would */
+vector *vector__sort(vector *v, sort_cmp cmp){
+	sort_pdq(v->d, v->len, v->dtype, cmp);
+	return v;
+}
+
+/* As vector__sort, on up to 'threads' threads, with scratch memory from the vector's allocator */
+vector *vector__sort_parallel(vector *v, sort_cmp cmp, unsigned int threads){
+	sort_parallel(v->d, v->len, v->dtype, cmp, threads, v->alloc);
 	return v;
 }
 
+/*
+Binary searches over a vector sorted by 'cmp'.
+lower_bound returns the index of the first member not less than 'key',
+upper_bound that of the first member greater than it, either being
+the length if there is no such member.
+*/
+unsigned int vector__lower_bound(vector *v, const void *key, sort_cmp cmp){
+	return sort_lower_bound(v->d, v->len, v->dtype, key, cmp);
+}
+
+unsigned int vector__upper_bound(vector *v, const void *key, sort_cmp cmp){
+	return sort_upper_bound(v->d, v->len, v->dtype, key, cmp);
+}
+
+/* Returns lower_bound, and stores upper_bound in 'end' */
+unsigned int vector__equal_range(vector *v, const void *key, sort_cmp cmp, unsigned int *end){
+	return sort_equal_range(v->d, v->len, v->dtype, key, cmp, end);
+}
+
+#ifdef ULIB_MMAP
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+File layout: a header of VECTOR__MMAP_HEADER bytes, then the members.
+The header is in native byte order, so files are not portable
+across machines of different endianness or int size.
+*/
+#define VECTOR__MMAP_MAGIC "ulibvec1"
+#define VECTOR__MMAP_HEADER 64u
+
+struct vector__mmap_header {
+	char magic[8];
+	unsigned int dtype;
+	unsigned int len;
+};
+
+/*
+State of one file-backed vector. Its allocator maps the file for the
+storage, and closes everything once it is asked to free the vector itself.
+*/
+struct vector__mmap {
+	ulib_allocator allocator; /* what v->alloc points to */
+	vector *owner;
+	char *base;               /* the mapping, header first */
+	size_t mapped;
+	int fd;
+};
+
+#define VECTOR__MMAP_HEAD(m) ((struct vector__mmap_header*)(m)->base)
+
+/*
+Resizes the file to 'bytes' and maps all of it, returns 0 on failure.
+Files grow before they are mapped and shrink after, so no page of the
+mapping is ever past the end of the file.
+*/
+static int vector__mmap_map(struct vector__mmap *m, size_t bytes){
+	void *p;
+	if(m->base && bytes == m->mapped) return 1;
+	if(bytes > m->mapped && ftruncate(m->fd, (off_t)bytes) != 0) return 0;
+	if(!m->base){
+		p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m->fd, 0);
+	}
+	else{
+#ifdef MREMAP_MAYMOVE
+		p = mremap(m->base, m->mapped, bytes, MREMAP_MAYMOVE);
+#else
+		/* The members are in the file, so remapping it copies nothing */
+		p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m->fd, 0);
+		if(p != MAP_FAILED) munmap(m->base, m->mapped);
+#endif
+	}
+	if(p == MAP_FAILED) return 0;
+	m->base = p;
+	if(bytes < m->mapped && ftruncate(m->fd, (off_t)bytes) != 0){
+		m->mapped = bytes;
+		return 0;
+	}
+	m->mapped = bytes;
+	return 1;
+}
+
+/* ulib_allocator callbacks */
+
+static void *vector__mmap_alloc(void *ctx, unsigned int bytes){
+	struct vector__mmap *m = ctx;
+	if(!vector__mmap_map(m, VECTOR__MMAP_HEADER + (size_t)bytes)) return NULL;
+	return m->base + VECTOR__MMAP_HEADER;
+}
+
+static void *vector__mmap_realloc(void *ctx, void *ptr, unsigned int old_bytes, unsigned int new_bytes){
+	(void)ptr;
+	(void)old_bytes;
+	return vector__mmap_alloc(ctx, new_bytes);
+}
+
+/* The storage stays in the file; freeing the vector itself closes it */
+static void vector__mmap_free(void *ctx, void *ptr, unsigned int bytes){
+	struct vector__mmap *m = ctx;
+	vector *v = m->owner;
+	if(ptr != v) return;
+
+	/* Trim the file to the members, and write their number */
+	vector__mmap_map(m, VECTOR__MMAP_HEADER + (size_t)v->len*v->dtype);
+	VECTOR__MMAP_HEAD(m)->len = v->len;
+	munmap(m->base, m->mapped);
+	close(m->fd);
+	ulib__dealloc(&ulib_default_allocator, v, bytes, ULIB_TAG_VECTOR);
+	ulib__dealloc(&ulib_default_allocator, m, sizeof(struct vector__mmap), ULIB_TAG_VECTOR);
+}
+
+/*
+Opens the vector stored at 'path', creating the file if it does not exist.
+Returns NULL if the file cannot be mapped, or holds members of another size.
+*/
+vector *vector_mmap_open(const char *path, unsigned int bytes){
+	struct vector__mmap *m;
+	struct vector__mmap_header *h = NULL;
+	struct stat st;
+	vector *v = NULL;
+	size_t cap;
+
+	if(bytes == 0) return NULL;
+	m = ulib__alloc(&ulib_default_allocator, sizeof(struct vector__mmap), ULIB_TAG_VECTOR);
+	if(!m) return NULL;
+	m->base = NULL;
+	m->mapped = 0;
+	m->fd = open(path, O_RDWR | O_CREAT, 0644);
+
+	if(m->fd >= 0 && fstat(m->fd, &st) == 0
+		&& (st.st_size == 0 || (size_t)st.st_size >= VECTOR__MMAP_HEADER)
+		&& vector__mmap_map(m, st.st_size ? (size_t)st.st_size : VECTOR__MMAP_HEADER)){
+		h = VECTOR__MMAP_HEAD(m);
+		if(st.st_size == 0){
+			ULIB_MEMCPY(h->magic, VECTOR__MMAP_MAGIC, 8);
+			h->dtype = bytes;
+			h->len = 0;
+		}
+		if(ULIB_MEMCMP(h->magic, VECTOR__MMAP_MAGIC, 8) == 0 && h->dtype == bytes){
+			v = vector_new(bytes);
+		}
+	}
+	if(!v){
+		if(m->base) munmap(m->base, m->mapped);
+		if(m->fd >= 0) close(m->fd);
+		ulib__dealloc(&ulib_default_allocator, m, sizeof(struct vector__mmap), ULIB_TAG_VECTOR);
+		return NULL;
+	}
+
+	cap = (m->mapped - VECTOR__MMAP_HEADER)/bytes;
+	v->cap = cap > (unsigned int)-1 ? (unsigned int)-1 : (unsigned int)cap;
+	v->len = h->len < v->cap ? h->len : v->cap;
+	v->d = v->cap ? m->base + VECTOR__MMAP_HEADER : NULL;
+
+	m->owner = v;
+	m->allocator.alloc = vector__mmap_alloc;
+	m->allocator.realloc = vector__mmap_realloc;
+	m->allocator.free = vector__mmap_free;
+	m->allocator.ctx = m;
+	v->alloc = &m->allocator;
+	return v;
+}
+
+/*
+Writes the length to the file and flushes the members to disk,
+waiting for the writes unless 'async' is VECTOR_MMAP_ASYNC.
+Returns NULL if 'v' is not file-backed or the flush fails.
+*/
+vector *vector_mmap_sync(vector *v, int async){
+	struct vector__mmap *m;
+	if(v->alloc->free != vector__mmap_free) return NULL;
+	m = v->alloc->ctx;
+	VECTOR__MMAP_HEAD(m)->len = v->len;
+	if(msync(m->base, m->mapped, async == VECTOR_MMAP_ASYNC ? MS_ASYNC : MS_SYNC) != 0) return NULL;
+	return v;
+}
+
+#endif /* ULIB_MMAP */
+
 #endif /* VECTOR_IMPLEMENTATION */
\ No newline at end of file